@@ -0,0 +1,257 @@
+#include "AllocationStats.h"
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef DIRTEMPLATE_ALLOCATION_STATS
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace
+{
+    // Counters are plain atomics so that operator new never allocates or locks
+    struct PhaseCounters
+    {
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> bytes{0};
+        std::atomic<std::uint64_t> peakRssKiB{0};
+    };
+
+    PhaseCounters counters[AllocationStats::PHASE_COUNT];
+
+    const char *const PHASE_NAMES[AllocationStats::PHASE_COUNT] = {"other", "parse", "sanitize", "create", "template"};
+
+    // Escapes the few characters that can appear in a command name
+    std::string jsonString(const std::string &text)
+    {
+        std::string quoted = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+}
+
+#ifdef DIRTEMPLATE_ALLOCATION_STATS
+namespace
+{
+    // Phase of the calling thread; trivially initialized so it is safe inside operator new
+    thread_local AllocationStats::Phase currentPhase = AllocationStats::PHASE_OTHER;
+
+    void *countedAllocate(std::size_t size, std::size_t alignment)
+    {
+        PhaseCounters &phase = counters[currentPhase];
+        phase.allocations.fetch_add(1, std::memory_order_relaxed);
+        phase.bytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (size == 0)
+        {
+            size = 1;
+        }
+        void *memory = alignment > alignof(std::max_align_t)
+                           ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                           : std::malloc(size);
+        return memory;
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    void *memory = countedAllocate(size, 0);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    void *memory = countedAllocate(size, static_cast<std::size_t>(alignment));
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size, 0);
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size, 0);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+AllocationStats::Scope::Scope(Phase phase) : phase(phase), previous(currentPhase)
+{
+    currentPhase = phase;
+}
+
+AllocationStats::Scope::~Scope()
+{
+    currentPhase = previous;
+    if (previous == PHASE_OTHER)
+    {
+        recordPeak(phase);
+    }
+}
+#endif
+
+AllocationStats::PhaseTotals AllocationStats::getTotals(Phase phase)
+{
+    PhaseTotals totals;
+    totals.allocations = counters[phase].allocations.load(std::memory_order_relaxed);
+    totals.bytes = counters[phase].bytes.load(std::memory_order_relaxed);
+    totals.peakRssKiB = counters[phase].peakRssKiB.load(std::memory_order_relaxed);
+    return totals;
+}
+
+const char *AllocationStats::getPhaseName(Phase phase)
+{
+    return PHASE_NAMES[phase];
+}
+
+std::uint64_t AllocationStats::readPeakRssKiB()
+{
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::stoull(line.substr(6));
+        }
+    }
+#endif
+    return 0;
+}
+
+void AllocationStats::printSummary()
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    std::cout << "Allocations by phase:" << std::endl;
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        Phase phase = static_cast<Phase>(i);
+        PhaseTotals totals = getTotals(phase);
+        if (totals.allocations == 0)
+        {
+            continue;
+        }
+        std::cout << "  " << getPhaseName(phase) << ": " << totals.allocations << " allocations, " << totals.bytes
+                  << " bytes";
+        if (totals.peakRssKiB > 0)
+        {
+            std::cout << ", peak RSS " << totals.peakRssKiB << " KiB";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Peak RSS: " << readPeakRssKiB() << " KiB" << std::endl;
+}
+
+bool AllocationStats::writeJson(const std::string &path, const std::string &command, int exitCode,
+                                std::chrono::microseconds elapsed)
+{
+    std::ofstream out(path);
+    out << "{\n"
+        << "  \"command\": " << jsonString(command) << ",\n"
+        << "  \"exitCode\": " << exitCode << ",\n"
+        << "  \"elapsedMs\": " << elapsed.count() / 1000.0 << ",\n"
+        << "  \"peakRssKiB\": " << readPeakRssKiB() << ",\n"
+        << "  \"allocationStats\": " << (isEnabled() ? "true" : "false") << ",\n"
+        << "  \"phases\": {";
+    if (isEnabled())
+    {
+        for (int i = 0; i < PHASE_COUNT; ++i)
+        {
+            Phase phase = static_cast<Phase>(i);
+            PhaseTotals totals = getTotals(phase);
+            out << (i == 0 ? "\n" : ",\n") << "    " << jsonString(getPhaseName(phase)) << ": {\"allocations\": "
+                << totals.allocations << ", \"bytes\": " << totals.bytes << ", \"peakRssKiB\": " << totals.peakRssKiB
+                << "}";
+        }
+        out << "\n  ";
+    }
+    out << "}\n}\n";
+
+    if (!out)
+    {
+        std::cerr << "Error: Could not write statistics to " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void AllocationStats::recordPeak(Phase phase)
+{
+    std::uint64_t peak = readPeakRssKiB();
+    std::uint64_t seen = counters[phase].peakRssKiB.load(std::memory_order_relaxed);
+    while (peak > seen && !counters[phase].peakRssKiB.compare_exchange_weak(seen, peak))
+    {
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef ALLOCATION_STATS_H
+#define ALLOCATION_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Counts heap allocations per phase of a run
+ *
+ * Building with -DDIRTEMPLATE_ALLOCATION_STATS replaces the global operator
+ * new and delete with counting versions. Every allocation is charged to the
+ * phase of the thread that made it, which code selects with a Scope. When an
+ * outermost Scope ends, the RSS high-water mark of the process is read from
+ * /proc/self/status and kept as that phase's peak. Peaks are process-wide,
+ * so phases that run side by side (create and template in the pipeline) see
+ * each other's memory. In a normal build, scopes compile to nothing and only
+ * the process peak RSS is reported.
+ */
+class AllocationStats
+{
+public:
+    /**
+     * @brief Phases that allocations are charged to
+     */
+    enum Phase
+    {
+        PHASE_OTHER,    // Anything outside a scope
+        PHASE_PARSE,    // Reading the markdown outline
+        PHASE_SANITIZE, // Slugifying and numbering subdirectory names
+        PHASE_CREATE,   // Creating subdirectories
+        PHASE_TEMPLATE, // Writing template files
+        PHASE_COUNT
+    };
+
+    /**
+     * @brief Charges the calling thread's allocations to a phase until destroyed
+     */
+    class Scope
+    {
+    public:
+        /**
+         * @brief Constructor enters the phase
+         *
+         * @param phase Phase to charge
+         */
+        explicit Scope(Phase phase);
+
+        /**
+         * @brief Destructor returns to the enclosing phase
+         */
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Phase phase;    // Phase entered by this scope
+        Phase previous; // Phase restored on exit
+    };
+
+    /**
+     * @brief Counters of one phase
+     */
+    struct PhaseTotals
+    {
+        std::uint64_t allocations = 0; // Calls to operator new
+        std::uint64_t bytes = 0;       // Bytes requested
+        std::uint64_t peakRssKiB = 0;  // Process RSS high-water mark when the phase last ended
+    };
+
+    /**
+     * @brief Checks whether this is an instrumented build
+     *
+     * @return bool True if allocations are counted
+     */
+    static constexpr bool isEnabled()
+    {
+#ifdef DIRTEMPLATE_ALLOCATION_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Gets the counters of a phase
+     *
+     * @param phase Phase to read
+     * @return PhaseTotals Counters so far
+     */
+    static PhaseTotals getTotals(Phase phase);
+
+    /**
+     * @brief Gets the name of a phase as used in the summary and JSON
+     *
+     * @param phase Phase to name
+     * @return const char* Lowercase name such as "parse"
+     */
+    static const char *getPhaseName(Phase phase);
+
+    /**
+     * @brief Reads the RSS high-water mark of the process
+     *
+     * @return std::uint64_t VmHWM in KiB, or 0 where /proc is unavailable
+     */
+    static std::uint64_t readPeakRssKiB();
+
+    /**
+     * @brief Prints one line per phase that allocated anything (instrumented builds only)
+     */
+    static void printSummary();
+
+    /**
+     * @brief Writes the statistics of the run as a JSON object
+     *
+     * @param path File to write
+     * @param command Subcommand that ran ("interactive" for the menu)
+     * @param exitCode Exit code of the run
+     * @param elapsed Wall time of the run
+     * @return bool True if the file was written
+     */
+    static bool writeJson(const std::string &path, const std::string &command, int exitCode,
+                          std::chrono::microseconds elapsed);
+
+private:
+    // Records the current process peak as the peak of a phase
+    static void recordPeak(Phase phase);
+};
+
+#ifndef DIRTEMPLATE_ALLOCATION_STATS
+inline AllocationStats::Scope::Scope(Phase phase) : phase(phase), previous(PHASE_OTHER)
+{
+}
+
+inline AllocationStats::Scope::~Scope()
+{
+}
+#endif
+
+#endif // ALLOCATION_STATS_H
@@ -0,0 +1,84 @@
+#include "AsyncFileSystem.h"
+
+namespace fs = std::filesystem;
+
+AsyncFileSystem::AsyncFileSystem(size_t ioThreadCount, size_t maxInFlight)
+    : pool(ioThreadCount), maxInFlight(maxInFlight == 0 ? 1 : maxInFlight), inFlight(0), peakInFlight(0)
+{
+}
+
+AsyncFileSystem::~AsyncFileSystem()
+{
+    wait();
+}
+
+void AsyncFileSystem::spawn(Task task)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]
+                     { return inFlight < maxInFlight; });
+        inFlight++;
+        if (inFlight > peakInFlight)
+        {
+            peakInFlight = inFlight;
+        }
+    }
+
+    // The task runs on this thread until its first co_await, then on the I/O threads
+    std::coroutine_handle<Task::promise_type> handle = std::exchange(task.handle, nullptr);
+    handle.promise().owner = this;
+    handle.resume();
+}
+
+void AsyncFileSystem::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]
+                 { return inFlight == 0; });
+}
+
+AsyncFileSystem::Operation<AsyncFileSystem::CreateResult> AsyncFileSystem::createDirectory(fs::path dirPath)
+{
+    return Operation<CreateResult>(*this, [dirPath = std::move(dirPath)]
+                                   {
+        CreateResult result;
+        result.created = FileSystemBackend::getActive().createDirectory(dirPath, result.error);
+        return result; });
+}
+
+AsyncFileSystem::Operation<std::error_code> AsyncFileSystem::writeFile(fs::path filePath, std::string_view content)
+{
+    return Operation<std::error_code>(*this, [filePath = std::move(filePath), content]
+                                      {
+        std::error_code ec;
+        FileSystemBackend::getActive().writeFile(filePath, content, ec);
+        return ec; });
+}
+
+size_t AsyncFileSystem::getOperationCount() const
+{
+    return operationCount.load(std::memory_order_relaxed);
+}
+
+size_t AsyncFileSystem::getFailedTaskCount() const
+{
+    return failedTasks.load(std::memory_order_relaxed);
+}
+
+size_t AsyncFileSystem::getPeakInFlight() const
+{
+    return peakInFlight;
+}
+
+void AsyncFileSystem::taskFinished(bool failed)
+{
+    if (failed)
+    {
+        failedTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Notify under the lock so wait() cannot return and destroy the executor mid-notify
+    std::lock_guard<std::mutex> lock(mutex);
+    inFlight--;
+    changed.notify_all();
+}
@@ -0,0 +1,241 @@
+#ifndef ASYNC_FILE_SYSTEM_H
+#define ASYNC_FILE_SYSTEM_H
+
+#include "FileSystemBackend.h"
+#include "ThreadPool.h"
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Coroutine executor that serves filesystem operations from an I/O pool
+ *
+ * AsyncFileSystem lets per-directory work be written as ordinary sequential
+ * code in a coroutine that co_awaits each filesystem operation. Awaiting
+ * suspends the coroutine and queues the blocking call on a small pool of I/O
+ * threads; when it completes, the coroutine resumes on that thread and issues
+ * its next operation. A suspended coroutine costs only its frame, so tens of
+ * thousands can be in flight on a handful of threads. Operations go through
+ * the error_code overloads of the active FileSystemBackend and hand the code
+ * back as part of their result, so a failing directory costs no exception.
+ */
+class AsyncFileSystem
+{
+public:
+    /**
+     * @brief Result of an awaited directory creation
+     */
+    struct CreateResult
+    {
+        bool created = false;  // True if the directory did not exist before
+        std::error_code error; // Failure of the call, cleared on success
+    };
+
+    /**
+     * @brief Coroutine type for work spawned on the executor
+     *
+     * A Task does not start until it is passed to spawn(). Its frame is
+     * destroyed when it finishes; exceptions that escape are counted as
+     * failures.
+     */
+    class Task
+    {
+    public:
+        struct promise_type
+        {
+            AsyncFileSystem *owner = nullptr; // Executor that runs the task
+            bool failed = false;              // True if an exception escaped
+
+            Task get_return_object()
+            {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            auto final_suspend() noexcept
+            {
+                // Destroy the frame, then tell the executor the task is done
+                struct FinalAwaiter
+                {
+                    bool await_ready() noexcept { return false; }
+                    void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                    {
+                        AsyncFileSystem *owner = handle.promise().owner;
+                        bool failed = handle.promise().failed;
+                        handle.destroy();
+                        owner->taskFinished(failed);
+                    }
+                    void await_resume() noexcept {}
+                };
+                return FinalAwaiter{};
+            }
+            void return_void() {}
+            void unhandled_exception() { failed = true; }
+        };
+
+        Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+        ~Task()
+        {
+            if (handle)
+            {
+                handle.destroy(); // Never spawned
+            }
+        }
+
+    private:
+        friend class AsyncFileSystem;
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        std::coroutine_handle<promise_type> handle; // Suspended coroutine until spawned
+    };
+
+    /**
+     * @brief Awaitable that runs one blocking call on the I/O pool
+     *
+     * @tparam T Result type of the call (void allowed)
+     */
+    template <typename T>
+    class Operation
+    {
+    public:
+        Operation(AsyncFileSystem &owner, std::function<T()> work) : owner(owner), work(std::move(work)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            owner.pool.submit([this, handle]
+                              {
+                try
+                {
+                    if constexpr (std::is_void_v<T>)
+                    {
+                        work();
+                    }
+                    else
+                    {
+                        value = work();
+                    }
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                owner.operationCount.fetch_add(1, std::memory_order_relaxed);
+                handle.resume(); });
+        }
+
+        T await_resume()
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+            if constexpr (!std::is_void_v<T>)
+            {
+                return std::move(value);
+            }
+        }
+
+    private:
+        using Storage = std::conditional_t<std::is_void_v<T>, char, T>;
+
+        AsyncFileSystem &owner;   // Executor whose pool runs the call
+        std::function<T()> work;  // Blocking call
+        Storage value{};          // Result of the call
+        std::exception_ptr error; // Exception thrown by the call
+    };
+
+    /**
+     * @brief Constructor starts the I/O threads
+     *
+     * @param ioThreadCount Number of I/O threads (0 selects the hardware concurrency)
+     * @param maxInFlight Maximum number of spawned tasks alive at once
+     */
+    AsyncFileSystem(size_t ioThreadCount, size_t maxInFlight);
+
+    /**
+     * @brief Destructor waits for every spawned task
+     */
+    ~AsyncFileSystem();
+
+    AsyncFileSystem(const AsyncFileSystem &) = delete;
+    AsyncFileSystem &operator=(const AsyncFileSystem &) = delete;
+
+    /**
+     * @brief Starts a task, blocking while maxInFlight tasks are alive
+     *
+     * @param task Task created by calling a coroutine
+     */
+    void spawn(Task task);
+
+    /**
+     * @brief Blocks until every spawned task has finished
+     */
+    void wait();
+
+    /**
+     * @brief Awaitable directory creation (parents included)
+     *
+     * @param dirPath Directory to create
+     * @return Operation<CreateResult> Yields whether the directory was created, or the error
+     */
+    Operation<CreateResult> createDirectory(fs::path dirPath);
+
+    /**
+     * @brief Awaitable file write
+     *
+     * @param filePath File to write
+     * @param content Content to write; must outlive the co_await
+     * @return Operation<std::error_code> Yields the error, cleared if the file was written
+     */
+    Operation<std::error_code> writeFile(fs::path filePath, std::string_view content);
+
+    /**
+     * @brief Gets the number of completed operations
+     *
+     * @return size_t Operations served by the I/O threads
+     */
+    size_t getOperationCount() const;
+
+    /**
+     * @brief Gets the number of tasks that ended with an escaped exception
+     *
+     * @return size_t Failed task count
+     */
+    size_t getFailedTaskCount() const;
+
+    /**
+     * @brief Gets the highest number of tasks that were alive at once
+     *
+     * @return size_t Peak in-flight task count
+     */
+    size_t getPeakInFlight() const;
+
+private:
+    // Called from a finishing task's final suspend point
+    void taskFinished(bool failed);
+
+    ThreadPool pool;                         // I/O threads serving operations
+    size_t maxInFlight;                      // Admission limit for spawn()
+    size_t inFlight;                         // Spawned tasks not yet finished
+    size_t peakInFlight;                     // Highest value of inFlight
+    std::mutex mutex;                        // Guards inFlight and peakInFlight
+    std::condition_variable changed;         // Signalled when a task finishes
+    std::atomic<size_t> operationCount{0};   // Completed operations
+    std::atomic<size_t> failedTasks{0};      // Tasks with an escaped exception
+};
+
+#endif // ASYNC_FILE_SYSTEM_H
@@ -0,0 +1,96 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief Blocking FIFO queue with a fixed capacity
+ *
+ * BoundedQueue connects the stages of a pipeline. Producers block while the
+ * queue is full, which keeps memory (and open descriptors) bounded when a
+ * later stage is slower than an earlier one. Closing the queue wakes every
+ * waiter; consumers drain the remaining items and then stop.
+ *
+ * @tparam T Type of the queued items (must be movable)
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Maximum number of queued items
+     */
+    explicit BoundedQueue(size_t capacity) : capacity(capacity == 0 ? 1 : capacity), closed(false)
+    {
+    }
+
+    /**
+     * @brief Adds an item, blocking while the queue is full
+     *
+     * @param item Item to add
+     * @return bool False if the queue was closed
+     */
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this]
+                     { return closed || items.size() < capacity; });
+        if (closed)
+        {
+            return false;
+        }
+        items.push_back(std::move(item));
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item, blocking while the queue is empty
+     *
+     * @param item Receives the item
+     * @return bool False once the queue is closed and empty
+     */
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this]
+                      { return closed || !items.empty(); });
+        if (items.empty())
+        {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Closes the queue; pending items can still be popped
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    size_t capacity;                  // Maximum number of items
+    bool closed;                      // True once close() was called
+    std::deque<T> items;              // Queued items
+    std::mutex mutex;                 // Guards items and closed
+    std::condition_variable notEmpty; // Signalled when an item is added or the queue closes
+    std::condition_variable notFull;  // Signalled when an item is removed or the queue closes
+};
+
+#endif // BOUNDED_QUEUE_H
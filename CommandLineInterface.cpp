@@ -0,0 +1,1044 @@
+#include "CommandLineInterface.h"
+#include "UserInterface.h"
+#include "FileSystemBackend.h"
+#include "PosixFileSystemBackend.h"
+#include "MemoryFileSystemBackend.h"
+#include "LatencyFileSystemBackend.h"
+#include "ThrottledFileSystemBackend.h"
+#include "ProcessPriority.h"
+#include "Jobserver.h"
+#include "AllocationStats.h"
+#include "RunJournal.h"
+#include "TreeCleaner.h"
+#include "TemplateVerifier.h"
+#include "DirectoryCreator.h"
+#include "TemplateFiles.h"
+#include "TarArchiveWriter.h"
+#include "DirectoryCopier.h"
+#include "OutlineWatcher.h"
+#include "DirectorySynchronizer.h"
+#include "StemLock.h"
+#include "StemLayout.h"
+#include "StemIndex.h"
+#include "NinjaBuildFile.h"
+#include "ProvisioningPipeline.h"
+#include "PrototypeFanOut.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <memory>
+#include <cstdio>
+#include <ctime>
+#include <chrono>
+#include <filesystem>
+#include <set>
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+CommandLineInterface::CommandLineInterface()
+    : backendName("posix"), latencyMicros(0), jobCount(0), batchSize(4096), sortMemoryMegabytes(64), unordered(false),
+      shardFanOut(0), maxOperationsPerSecond(0), maxBytesPerSecond(0), ownerId(-1), groupId(-1), dirMode(-1),
+      fileMode(-1), keepUserFiles(false),
+      useCoroutines(false), maxInFlight(0), resume(false), rollback(false), removeUserFiles(false), writeBuildFile(false)
+{
+}
+
+bool CommandLineInterface::parse(const std::vector<std::string> &args)
+{
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        const std::string &arg = args[i];
+
+        if (arg == "-h" || arg == "--help")
+        {
+            printUsage();
+            return false;
+        }
+        else if (arg == "--backend" && i + 1 < args.size())
+        {
+            backendName = args[++i];
+            if (backendName != "posix" && backendName != "memory")
+            {
+                std::cerr << "Error: Unknown backend: " << backendName << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--latency-us" && i + 1 < args.size())
+        {
+            try
+            {
+                latencyMicros = std::stol(args[++i]);
+            }
+            catch (...)
+            {
+                latencyMicros = -1;
+            }
+            if (latencyMicros < 0)
+            {
+                std::cerr << "Error: --latency-us expects a non-negative number." << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--jobs" && i + 1 < args.size())
+        {
+            try
+            {
+                jobCount = std::stoul(args[++i]);
+            }
+            catch (...)
+            {
+                std::cerr << "Error: --jobs expects a positive number." << std::endl;
+                return false;
+            }
+        }
+        else if ((arg == "--batch-size" || arg == "--sort-memory-mb" || arg == "--max-in-flight") && i + 1 < args.size())
+        {
+            size_t value = 0;
+            try
+            {
+                value = std::stoul(args[++i]);
+            }
+            catch (...)
+            {
+            }
+            if (value == 0)
+            {
+                std::cerr << "Error: " << arg << " expects a positive number." << std::endl;
+                return false;
+            }
+            (arg == "--batch-size" ? batchSize : arg == "--sort-memory-mb" ? sortMemoryMegabytes : maxInFlight) = value;
+        }
+        else if (arg == "--shard-fanout" && i + 1 < args.size())
+        {
+            size_t value = 0;
+            try
+            {
+                value = std::stoul(args[++i]);
+            }
+            catch (...)
+            {
+            }
+            if (value < 2)
+            {
+                std::cerr << "Error: --shard-fanout expects a number of at least 2." << std::endl;
+                return false;
+            }
+            shardFanOut = value;
+        }
+        else if ((arg == "--max-ops-per-sec" || arg == "--max-bytes-per-sec") && i + 1 < args.size())
+        {
+            double value = 0;
+            try
+            {
+                value = std::stod(args[++i]);
+            }
+            catch (...)
+            {
+            }
+            if (value <= 0)
+            {
+                std::cerr << "Error: " << arg << " expects a positive number." << std::endl;
+                return false;
+            }
+            (arg == "--max-ops-per-sec" ? maxOperationsPerSecond : maxBytesPerSecond) = value;
+        }
+        else if (arg == "--ioprio" && i + 1 < args.size())
+        {
+            ioPriority = args[++i];
+        }
+        else if (arg == "--nice" && i + 1 < args.size())
+        {
+            int level = 100;
+            try
+            {
+                level = std::stoi(args[++i]);
+            }
+            catch (...)
+            {
+            }
+            if (!ProcessPriority::setWorkerNiceLevel(level))
+            {
+                return false;
+            }
+        }
+        else if ((arg == "--owner" || arg == "--group") && i + 1 < args.size())
+        {
+            const std::string &name = args[++i];
+            bool found = arg == "--owner" ? PosixFileSystemBackend::resolveOwner(name, ownerId)
+                                          : PosixFileSystemBackend::resolveGroup(name, groupId);
+            if (!found)
+            {
+#ifdef _WIN32
+                std::cerr << "Error: " << arg << " is not supported on this platform." << std::endl;
+#else
+                std::cerr << "Error: Unknown " << (arg == "--owner" ? "user" : "group") << ": " << name << std::endl;
+#endif
+                return false;
+            }
+        }
+        else if ((arg == "--dir-mode" || arg == "--file-mode") && i + 1 < args.size())
+        {
+            if (!PosixFileSystemBackend::parseMode(args[++i], arg == "--dir-mode" ? dirMode : fileMode))
+            {
+                std::cerr << "Error: " << arg << " expects an octal mode such as 0750." << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--no-jobserver")
+        {
+            Jobserver::disable();
+        }
+        else if (arg == "--stats-json" && i + 1 < args.size())
+        {
+            statsJsonPath = args[++i];
+        }
+        else if (arg == "--git-init")
+        {
+            TemplateFiles::setGitRepository(true);
+        }
+        else if (arg == "--ninja")
+        {
+            writeBuildFile = true;
+        }
+        else if (arg == "--pch")
+        {
+            NinjaBuildFile::setPrecompiledHeader(true);
+        }
+        else if (arg == "--keep-user-files")
+        {
+            keepUserFiles = true;
+        }
+        else if (arg == "--unordered")
+        {
+            unordered = true;
+        }
+        else if (arg == "--coroutines")
+        {
+            useCoroutines = true;
+        }
+        else if (arg == "--resume")
+        {
+            resume = true;
+        }
+        else if (arg == "--rollback")
+        {
+            rollback = true;
+        }
+        else if (arg == "--remove-user-files")
+        {
+            removeUserFiles = true;
+        }
+        else if (arg == "--output-tar" && i + 1 < args.size())
+        {
+            outputTarPath = args[++i];
+        }
+        else if (arg == "--watch" && i + 1 < args.size())
+        {
+            watchPath = args[++i];
+        }
+        else if (arg.size() > 1 && arg[0] == '-')
+        {
+            std::cerr << "Error: Unknown or incomplete option: " << arg << std::endl;
+            printUsage();
+            return false;
+        }
+        else
+        {
+            positionalArgs.push_back(arg);
+        }
+    }
+
+    // Validate the arguments required by the selected mode
+    if (!outputTarPath.empty() && positionalArgs.size() != 1)
+    {
+        std::cerr << "Error: --output-tar expects exactly one markdown outline." << std::endl;
+        return false;
+    }
+    if (!watchPath.empty() && (positionalArgs.size() != 1 || !outputTarPath.empty()))
+    {
+        std::cerr << "Error: --watch expects the parent directory of the stem." << std::endl;
+        return false;
+    }
+    if (outputTarPath.empty() && watchPath.empty() && !positionalArgs.empty())
+    {
+        command = positionalArgs.front();
+        positionalArgs.erase(positionalArgs.begin());
+    }
+    if (!validateCommand())
+    {
+        printUsage();
+        return false;
+    }
+
+    return true;
+}
+
+bool CommandLineInterface::validateCommand() const
+{
+    if (useCoroutines && (command != "create" || rollback))
+    {
+        std::cerr << "Error: --coroutines only applies to create without --rollback." << std::endl;
+        return false;
+    }
+    if (maxInFlight > 0 && !useCoroutines)
+    {
+        std::cerr << "Error: --max-in-flight only applies to create --coroutines." << std::endl;
+        return false;
+    }
+    if (unordered && (!command.empty() || !outputTarPath.empty() || !watchPath.empty()))
+    {
+        std::cerr << "Error: --unordered only applies to interactive mode." << std::endl;
+        return false;
+    }
+    if (keepUserFiles && command != "clean")
+    {
+        std::cerr << "Error: --keep-user-files only applies to clean." << std::endl;
+        return false;
+    }
+    if ((resume || rollback) && command != "create")
+    {
+        std::cerr << "Error: --resume and --rollback only apply to create." << std::endl;
+        return false;
+    }
+    if (removeUserFiles && !rollback)
+    {
+        std::cerr << "Error: --remove-user-files only applies to create --rollback." << std::endl;
+        return false;
+    }
+    if (TemplateFiles::isGitRepository() && command == "copy-tree")
+    {
+        std::cerr << "Error: --git-init does not apply to copy-tree." << std::endl;
+        return false;
+    }
+    if (writeBuildFile && command != "create" && command != "sync")
+    {
+        std::cerr << "Error: --ninja only applies to create and sync." << std::endl;
+        return false;
+    }
+    if (NinjaBuildFile::isPrecompiledHeaderEnabled() && !writeBuildFile)
+    {
+        std::cerr << "Error: --pch needs --ninja." << std::endl;
+        return false;
+    }
+    if (resume && (rollback || useCoroutines))
+    {
+        std::cerr << "Error: --resume cannot be combined with --rollback or --coroutines." << std::endl;
+        return false;
+    }
+
+    // Interactive, --watch and --output-tar mode have no subcommand
+    if (command.empty())
+    {
+        return true;
+    }
+
+    if (command == "copy-tree")
+    {
+        if (positionalArgs.size() != 2)
+        {
+            std::cerr << "Error: copy-tree expects <sourceDir> <stemDir>." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (command == "sync" || command == "create")
+    {
+        if (positionalArgs.size() != 2)
+        {
+            std::cerr << "Error: " << command << " expects <outline.md> <parentDir>." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (command == "fan-out")
+    {
+        if (positionalArgs.size() < 2)
+        {
+            std::cerr << "Error: fan-out expects <outline.md> <parentDir>..." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (command == "verify")
+    {
+        if (positionalArgs.empty())
+        {
+            std::cerr << "Error: verify expects at least one <stemDir>." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (command == "clean")
+    {
+        if (positionalArgs.size() != 1)
+        {
+            std::cerr << "Error: clean expects <stemDir>." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::cerr << "Error: Unknown command: " << command << std::endl;
+    return false;
+}
+
+int CommandLineInterface::run()
+{
+    auto start = std::chrono::steady_clock::now();
+    int exitCode = dispatch();
+    AllocationStats::printSummary();
+
+    if (!statsJsonPath.empty())
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        if (!AllocationStats::writeJson(statsJsonPath, command.empty() ? "interactive" : command, exitCode, elapsed) &&
+            exitCode == 0)
+        {
+            exitCode = 1;
+        }
+    }
+    return exitCode;
+}
+
+int CommandLineInterface::dispatch()
+{
+    if (!outputTarPath.empty())
+    {
+        return exportTar(positionalArgs.front());
+    }
+
+    if (!installBackend())
+    {
+        return 1;
+    }
+
+    if (!watchPath.empty())
+    {
+        OutlineWatcher watcher(watchPath, positionalArgs.front());
+        return watcher.run() ? 0 : 1;
+    }
+
+    if (command == "copy-tree")
+    {
+        DirectoryCopier copier;
+        return copier.copySourceTree(positionalArgs[0], positionalArgs[1], jobCount) ? 0 : 1;
+    }
+
+    if (command == "sync")
+    {
+        int result = syncOutline(positionalArgs[0], positionalArgs[1]);
+        printBackendSummary();
+        return result;
+    }
+
+    if (command == "fan-out")
+    {
+        return fanOutOutline(positionalArgs[0],
+                             std::vector<std::string>(positionalArgs.begin() + 1, positionalArgs.end()));
+    }
+
+    if (command == "verify")
+    {
+        return verifyStems(positionalArgs);
+    }
+
+    if (command == "clean")
+    {
+        return cleanStem(positionalArgs[0]);
+    }
+
+    if (command == "create" && rollback)
+    {
+        return rollbackOutline(positionalArgs[0], positionalArgs[1]);
+    }
+
+    if (command == "create")
+    {
+        int result = createOutline(positionalArgs[0], positionalArgs[1]);
+        printBackendSummary();
+        return result;
+    }
+
+    // Create and run the interactive user interface
+    UserInterface ui;
+    ui.run();
+
+    printBackendSummary();
+    return 0;
+}
+
+void CommandLineInterface::printUsage()
+{
+    std::cout << "Usage: directory_template_tool [options]" << std::endl;
+    std::cout << "       directory_template_tool --output-tar <file|-> <outline.md>" << std::endl;
+    std::cout << "       directory_template_tool [options] --watch <outline.md> <parentDir>" << std::endl;
+    std::cout << "       directory_template_tool [options] copy-tree <sourceDir> <stemDir>" << std::endl;
+    std::cout << "       directory_template_tool [options] sync <outline.md> <parentDir>" << std::endl;
+    std::cout << "       directory_template_tool [options] create <outline.md> <parentDir>" << std::endl;
+    std::cout << "       directory_template_tool [options] fan-out <outline.md> <parentDir>..." << std::endl;
+    std::cout << "       directory_template_tool [options] clean <stemDir>" << std::endl;
+    std::cout << "       directory_template_tool [options] verify <stemDir>..." << std::endl;
+    std::cout << "\nOptions:" << std::endl;
+    std::cout << "  --backend posix|memory  Filesystem backend (default: posix)" << std::endl;
+    std::cout << "  --latency-us N          Add N microseconds of simulated latency per operation" << std::endl;
+    std::cout << "  --jobs N                Number of parallel workers (default: all cores, or make's -j)" << std::endl;
+    std::cout << "  --ioprio idle|be:N      Lower the I/O priority of the whole process (Linux)" << std::endl;
+    std::cout << "  --nice N                CPU nice level for worker threads (Linux)" << std::endl;
+    std::cout << "  --no-jobserver          Ignore the jobserver of a parent make -j" << std::endl;
+    std::cout << "  --stats-json FILE       Write run time, peak RSS and allocation counts as JSON" << std::endl;
+    std::cout << "  --owner USER            Give created directories and files to USER (name or ID)" << std::endl;
+    std::cout << "  --group GROUP           Give created directories and files to GROUP (name or ID)" << std::endl;
+    std::cout << "  --dir-mode MODE         Octal mode of created directories, e.g. 2770" << std::endl;
+    std::cout << "  --file-mode MODE        Octal mode of created files, e.g. 0640" << std::endl;
+    std::cout << "  --max-ops-per-sec N     Limit filesystem operations per second" << std::endl;
+    std::cout << "  --max-bytes-per-sec N   Limit bytes written per second" << std::endl;
+    std::cout << "  --batch-size N          Process stem subdirectories in batches of N (default: 4096)" << std::endl;
+    std::cout << "  --sort-memory-mb N      Memory for sorting subdirectory names before spilling (default: 64)" << std::endl;
+    std::cout << "  --shard-fanout N        Group lessons of outlines larger than N into buckets of N" << std::endl;
+    std::cout << "  --unordered             Make options 2 and 3 process subdirectories in directory order" << std::endl;
+    std::cout << "  --git-init              Make every lesson a git repository with the templates committed" << std::endl;
+    std::cout << "  --ninja                 Make create and sync write build.ninja for every lesson" << std::endl;
+    std::cout << "  --pch                   Make build.ninja share one precompiled header across lessons" << std::endl;
+    std::cout << "  --keep-user-files       Make clean delete only template files, keeping anything else" << std::endl;
+    std::cout << "  --coroutines            Run create as one coroutine per directory on an I/O pool" << std::endl;
+    std::cout << "  --max-in-flight N       Coroutines alive at once under --coroutines (default: 65536)" << std::endl;
+    std::cout << "  --resume                Make create skip what the journal of an interrupted run finished" << std::endl;
+    std::cout << "  --rollback              Make create remove what its journaled run created" << std::endl;
+    std::cout << "  --remove-user-files     Make --rollback delete created lessons with any files added since" << std::endl;
+    std::cout << "  --output-tar FILE|-     Stream the outline as a tar archive instead of creating it" << std::endl;
+    std::cout << "  --watch FILE            Apply edits of an outline incrementally as it is saved" << std::endl;
+    std::cout << "  -h, --help              Show this help" << std::endl;
+}
+
+bool CommandLineInterface::installBackend()
+{
+    PosixFileSystemBackend::Ownership ownership;
+    ownership.owner = ownerId;
+    ownership.group = groupId;
+    ownership.dirMode = dirMode;
+    ownership.fileMode = fileMode;
+    bool setsOwnership = ownerId >= 0 || groupId >= 0 || dirMode >= 0 || fileMode >= 0;
+
+    std::unique_ptr<FileSystemBackend> backend;
+    if (backendName == "memory")
+    {
+        if (setsOwnership)
+        {
+            std::cerr << "Error: --owner, --group, --dir-mode and --file-mode need the posix backend." << std::endl;
+            return false;
+        }
+        backend = std::make_unique<MemoryFileSystemBackend>();
+    }
+    else if (setsOwnership)
+    {
+#ifdef _WIN32
+        std::cerr << "Error: --dir-mode and --file-mode are not supported on this platform." << std::endl;
+        return false;
+#else
+        backend = std::make_unique<PosixFileSystemBackend>(ownership);
+#endif
+    }
+    else
+    {
+        backend = std::make_unique<PosixFileSystemBackend>();
+    }
+
+    // Wrap the backend to simulate network filesystem round trips
+    if (latencyMicros > 0)
+    {
+        backend = std::make_unique<LatencyFileSystemBackend>(std::move(backend),
+                                                             std::chrono::microseconds(latencyMicros));
+    }
+
+    // Throttle outermost so simulated latency does not count as throttled time
+    if (maxOperationsPerSecond > 0 || maxBytesPerSecond > 0)
+    {
+        backend = std::make_unique<ThrottledFileSystemBackend>(std::move(backend), maxOperationsPerSecond,
+                                                               maxBytesPerSecond);
+    }
+
+    // Set before any worker thread exists so every thread inherits it
+    if (!ioPriority.empty() && !ProcessPriority::setIoPriority(ioPriority))
+    {
+        return false;
+    }
+
+    FileSystemBackend::setActive(std::move(backend));
+    DirectoryCopier::setEnumerationOptions(batchSize, sortMemoryMegabytes * 1024 * 1024, !unordered);
+    StemLayout::setDefaultFanOut(shardFanOut);
+    return true;
+}
+
+void CommandLineInterface::printBackendSummary() const
+{
+    FileSystemBackend *backend = &FileSystemBackend::getActive();
+
+    if (auto *throttled = dynamic_cast<ThrottledFileSystemBackend *>(backend))
+    {
+        std::cout << "Time spent throttled: " << throttled->getThrottledTime().count() / 1000.0
+                  << " ms (summed over all threads)" << std::endl;
+        backend = &throttled->getInner();
+    }
+
+    if (auto *latency = dynamic_cast<LatencyFileSystemBackend *>(backend))
+    {
+        std::cout << "Simulated round trips: " << latency->getRoundTripCount() << std::endl;
+        backend = &latency->getInner();
+    }
+
+    if (auto *memory = dynamic_cast<MemoryFileSystemBackend *>(backend))
+    {
+        std::cout << "In-memory backend: " << memory->getDirectoryCount() << " directories, "
+                  << memory->getFileCount() << " files, " << memory->getTotalBytes() << " bytes" << std::endl;
+    }
+}
+
+int CommandLineInterface::exportTar(const std::string &markdownPath)
+{
+    // Status messages go to stderr because stdout may carry the archive
+    DirectoryCreator creator;
+    std::string stemDirName;
+    std::vector<std::string> subDirNames;
+    if (!creator.readMarkdownStructure(markdownPath, stemDirName, subDirNames))
+    {
+        return 1;
+    }
+    if (stemDirName.empty())
+    {
+        std::cerr << "Error: No stem directory name found in " << markdownPath << std::endl;
+        return 1;
+    }
+
+    std::FILE *out = nullptr;
+    if (outputTarPath == "-")
+    {
+        out = stdout;
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    }
+    else
+    {
+        out = std::fopen(outputTarPath.c_str(), "wb");
+        if (!out)
+        {
+            std::cerr << "Error: Could not create archive: " << outputTarPath << std::endl;
+            return 1;
+        }
+    }
+
+    // Template payloads are fetched once and streamed for every subdirectory
+    const std::vector<TemplateFiles::TemplateFile> files = TemplateFiles::getAllTemplateFiles();
+    TarArchiveWriter writer(out, std::time(nullptr));
+    writer.setOwnership(ownerId >= 0 ? ownerId : 0, groupId >= 0 ? groupId : 0, dirMode >= 0 ? dirMode : 0755,
+                        fileMode >= 0 ? fileMode : 0644);
+
+    writer.addDirectory(stemDirName);
+    for (size_t i = 0; i < subDirNames.size(); ++i)
+    {
+        std::string subDir = stemDirName + "/" + DirectoryCreator::formatSubdirectoryName(i + 1, subDirNames[i]);
+        writer.addDirectory(subDir);
+
+        // Emit every template subdirectory and each of its ancestors once, before its first file
+        std::set<std::string> emittedDirectories;
+        for (const auto &file : files)
+        {
+            if (file.subdirectory.empty())
+            {
+                writer.addFile(subDir + "/" + file.filename, file.content);
+                continue;
+            }
+
+            size_t end = 0;
+            while (end != std::string::npos)
+            {
+                end = file.subdirectory.find('/', end + 1);
+                std::string directory = file.subdirectory.substr(0, end);
+                if (emittedDirectories.insert(directory).second)
+                {
+                    writer.addDirectory(subDir + "/" + directory);
+                }
+            }
+            writer.addFile(subDir + "/" + file.subdirectory + "/" + file.filename, file.content);
+        }
+    }
+
+    bool success = writer.finish();
+    if (out != stdout && std::fclose(out) != 0)
+    {
+        success = false;
+    }
+
+    if (!success)
+    {
+        std::cerr << "Error: Failed writing archive: " << outputTarPath << std::endl;
+        return 1;
+    }
+
+    std::cerr << "Archived " << subDirNames.size() << " directories (" << writer.getBytesWritten()
+              << " bytes)." << std::endl;
+    return 0;
+}
+
+int CommandLineInterface::syncOutline(const std::string &markdownPath, const std::string &parentDir)
+{
+    DirectoryCreator creator;
+    std::string stemDirName;
+    std::vector<std::string> subDirNames;
+    if (!creator.readMarkdownStructure(markdownPath, stemDirName, subDirNames))
+    {
+        return 1;
+    }
+    if (stemDirName.empty())
+    {
+        std::cerr << "Error: No stem directory name found in " << markdownPath << std::endl;
+        return 1;
+    }
+
+    fs::path stemDir = fs::path(parentDir) / stemDirName;
+    if (StemLayout(stemDir).load())
+    {
+        std::cerr << "Error: sync does not support sharded stems: " << stemDir.string() << std::endl;
+        return 1;
+    }
+    try
+    {
+        FileSystemBackend::getActive().createDirectory(stemDir);
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Error creating stem directory: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Plan and apply under the same lock so the plan cannot go stale
+    StemLock stemLock(stemDir);
+    DirectorySynchronizer synchronizer(stemDir);
+    DirectorySynchronizer::Plan plan = synchronizer.computePlan(subDirNames);
+    std::cout << "Synchronizing " << stemDir.string() << ": " << plan.unchanged << " unchanged, "
+              << plan.renames.size() << " to renumber, " << plan.creates.size() << " to create, "
+              << plan.orphans.size() << " not in outline." << std::endl;
+
+    bool success = synchronizer.applyPlan(plan);
+    std::cout << "Issued " << synchronizer.getRenameOperationCount() << " rename operations." << std::endl;
+
+    if (writeBuildFile)
+    {
+        std::vector<std::string> lessons;
+        lessons.reserve(subDirNames.size());
+        for (size_t i = 0; i < subDirNames.size(); ++i)
+        {
+            lessons.push_back(DirectoryCreator::formatSubdirectoryName(i + 1, subDirNames[i]));
+        }
+        NinjaBuildFile buildFile(stemDir);
+        success = buildFile.write(lessons) && success;
+        std::cout << "Wrote " << NinjaBuildFile::BUILD_FILE_NAME << " for " << buildFile.getLessonCount()
+                  << " lessons." << std::endl;
+    }
+    return success ? 0 : 1;
+}
+
+int CommandLineInterface::createOutline(const std::string &markdownPath, const std::string &parentDir)
+{
+    size_t creators;
+    size_t templateWorkers;
+    splitProvisioningWorkers(creators, templateWorkers);
+
+    // Per-file messages would serialize the workers on stdout
+    TemplateFiles::setVerbose(false);
+    ProvisioningPipeline::Result result;
+    bool success;
+    if (useCoroutines)
+    {
+        // Coroutines cost no thread or descriptor while waiting, only their frame, so tens of
+        // thousands of directories can be in flight
+        ProvisioningPipeline pipeline(creators, templateWorkers, maxInFlight > 0 ? maxInFlight : 65536);
+        pipeline.setBuildFile(writeBuildFile);
+        success = pipeline.runCoroutines(markdownPath, fs::path(parentDir), result);
+    }
+    else
+    {
+        ProvisioningPipeline pipeline(creators, templateWorkers, 256);
+        pipeline.setResume(resume);
+        pipeline.setBuildFile(writeBuildFile);
+        success = pipeline.run(markdownPath, fs::path(parentDir), result);
+    }
+    TemplateFiles::setVerbose(true);
+
+    if (result.entries == 0 && !success)
+    {
+        return 1;
+    }
+
+    std::cout << "Provisioned " << result.entries << " directories (" << result.directoriesCreated << " new, "
+              << result.templatedDirectories << " templated) with ";
+    if (useCoroutines)
+    {
+        std::cout << creators + templateWorkers << " I/O threads running coroutines." << std::endl;
+    }
+    else
+    {
+        std::cout << result.creators << " create and " << result.templateWorkers << " template workers." << std::endl;
+    }
+    std::cout << "First files after " << result.timeToFirstFile.count() / 1000.0 << " ms, finished after "
+              << result.totalTime.count() / 1000.0 << " ms." << std::endl;
+    if (result.buildFileWritten)
+    {
+        std::cout << "Wrote " << NinjaBuildFile::BUILD_FILE_NAME << " for " << result.entries << " lessons."
+                  << std::endl;
+    }
+    if (result.directoriesSkipped > 0)
+    {
+        std::cout << "Skipped " << result.directoriesSkipped << " directories finished by the interrupted run."
+                  << std::endl;
+    }
+    if (!success)
+    {
+        std::cerr << "Errors: " << result.directoriesFailed << " directories, " << result.templateFailures
+                  << " template sets." << std::endl;
+    }
+    return success ? 0 : 1;
+}
+
+int CommandLineInterface::fanOutOutline(const std::string &markdownPath, const std::vector<std::string> &parentDirs)
+{
+    // Replication copies real files, so the prototype has to be on disk as well
+    if (!FileSystemBackend::getActive().isOnDisk())
+    {
+        std::cerr << "Error: fan-out only works with the posix backend." << std::endl;
+        return 1;
+    }
+
+    size_t creators;
+    size_t templateWorkers;
+    splitProvisioningWorkers(creators, templateWorkers);
+
+    std::vector<fs::path> parents(parentDirs.begin(), parentDirs.end());
+    ThreadPool pool(jobCount);
+    PrototypeFanOut fanOut(creators, templateWorkers);
+    PrototypeFanOut::Result result;
+    TemplateFiles::setVerbose(false);
+    bool success = fanOut.run(markdownPath, parents, pool, result);
+    TemplateFiles::setVerbose(true);
+
+    if (result.prototypeDirectories > 0)
+    {
+        std::cout << "Built a prototype of " << result.prototypeDirectories << " directories in "
+                  << result.prototypeTime.count() / 1000.0 << " ms." << std::endl;
+        std::cout << "Replicated it into " << result.parentsProvisioned << " parents (" << result.copy.filesCopied
+                  << " files, " << result.copy.filesCloned << " cloned) in " << result.replicateTime.count() / 1000.0
+                  << " ms using " << pool.getThreadCount() << " workers." << std::endl;
+    }
+    if (result.parentsSkipped > 0)
+    {
+        std::cout << result.parentsSkipped << " parents skipped because the stem already exists." << std::endl;
+    }
+    if (!success)
+    {
+        std::cerr << "Errors: " << result.parentsFailed << " parents, " << result.copy.filesFailed << " files."
+                  << std::endl;
+    }
+    printBackendSummary();
+    return success ? 0 : 1;
+}
+
+void CommandLineInterface::splitProvisioningWorkers(size_t &creators, size_t &templateWorkers) const
+{
+    // Split the workers between the create and template stages; template writes dominate
+    size_t jobs = jobCount > 0 ? jobCount : ThreadPool::getDefaultThreadCount();
+    creators = jobs >= 4 ? jobs / 4 : 1;
+    templateWorkers = jobs > creators ? jobs - creators : 1;
+}
+
+int CommandLineInterface::rollbackOutline(const std::string &markdownPath, const std::string &parentDir)
+{
+    // The journal and the deletions both work on the real filesystem
+    if (!FileSystemBackend::getActive().isOnDisk())
+    {
+        std::cerr << "Error: --rollback only works with the posix backend." << std::endl;
+        return 1;
+    }
+
+    DirectoryCreator creator;
+    std::string stemDirName;
+    std::vector<std::string> subDirNames;
+    if (!creator.readMarkdownStructure(markdownPath, stemDirName, subDirNames))
+    {
+        return 1;
+    }
+    fs::path stemDir = fs::path(parentDir) / stemDirName;
+    if (stemDirName.empty() || !FileSystemBackend::getActive().status(stemDir).isDirectory)
+    {
+        std::cerr << "Error: Stem directory does not exist: " << stemDir.string() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool stemEmptied = false;
+    bool stemRemoved = false;
+    TreeCleaner::Result result;
+    std::vector<std::string> created;
+    {
+        StemLock stemLock(stemDir);
+        RunJournal journal(stemDir);
+        if (!journal.load())
+        {
+            std::cerr << "Error: No journal found in " << stemDir.string() << std::endl;
+            return 1;
+        }
+
+        // Only lessons whose journaled path still matches the outline are touched; lessons an
+        // earlier rollback already removed are skipped, so a rollback that kept user files can be repeated
+        StemLayout layout(stemDir);
+        layout.load();
+        for (size_t i = 0; i < subDirNames.size(); ++i)
+        {
+            fs::path relativePath =
+                layout.getRelativePath(i + 1, DirectoryCreator::formatSubdirectoryName(i + 1, subDirNames[i]));
+            if (journal.wasCreated(i + 1, RunJournal::hashName(relativePath)) &&
+                FileSystemBackend::getActive().status(stemDir / relativePath).exists)
+            {
+                created.push_back(relativePath.generic_string());
+            }
+        }
+
+        // Lessons go first (deepest entries first within each), then emptied buckets, then the stem.
+        // Files added after the run stay, with their lesson, unless --remove-user-files is given.
+        TreeCleaner cleaner(stemDir, !removeUserFiles);
+        cleaner.select(created);
+        ThreadPool pool(jobCount);
+        result = cleaner.clean(pool);
+
+        if (result.failures == 0 && result.directoriesKept == 0)
+        {
+            std::error_code ec;
+            RunJournal::remove(stemDir);
+            if (journal.wasStemCreated())
+            {
+                // The stem goes too if nothing but the tool's own files is left in it
+                for (const char *toolFile : {StemIndex::INDEX_FILE_NAME, StemLayout::LAYOUT_FILE_NAME,
+                                             NinjaBuildFile::BUILD_FILE_NAME})
+                {
+                    fs::remove(stemDir / toolFile, ec);
+                }
+                stemEmptied = true;
+                for (const auto &entry : fs::directory_iterator(stemDir, ec))
+                {
+                    stemEmptied = stemEmptied && entry.path().filename() == StemLock::LOCK_FILE_NAME;
+                }
+                stemEmptied = stemEmptied && !ec;
+            }
+        }
+    }
+
+    // Unlinking the lock file while holding it would let a waiter lock the orphaned file while a new
+    // process creates a fresh one, so it goes after the release, together with the emptied stem
+    if (stemEmptied)
+    {
+        std::error_code ec;
+        fs::remove(stemDir / StemLock::LOCK_FILE_NAME, ec);
+        stemRemoved = fs::remove(stemDir, ec);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "Rolled back " << result.directoriesRemoved << " of " << created.size()
+              << " directories created by the journaled run (" << result.entriesRemoved << " entries) in "
+              << elapsed.count() << " ms." << std::endl;
+    if (stemRemoved)
+    {
+        std::cout << "Removed the stem directory " << stemDir.string() << "." << std::endl;
+    }
+    if (result.directoriesKept > 0)
+    {
+        std::cout << result.directoriesKept << " directories kept because they contain user files." << std::endl;
+    }
+    if (result.failures > 0)
+    {
+        std::cerr << result.failures << " entries could not be removed; the journal was kept." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int CommandLineInterface::cleanStem(const std::string &stemDir)
+{
+    // Deletion works on directory descriptors, so it needs the real filesystem
+    if (!FileSystemBackend::getActive().isOnDisk())
+    {
+        std::cerr << "Error: clean only works with the posix backend." << std::endl;
+        return 1;
+    }
+
+    if (!FileSystemBackend::getActive().status(stemDir).isDirectory)
+    {
+        std::cerr << "Error: Stem directory does not exist: " << stemDir << std::endl;
+        return 1;
+    }
+
+    // Lock before scanning, so no create or sync can add or rename lessons between scan and deletion
+    auto start = std::chrono::steady_clock::now();
+    StemLock stemLock(stemDir);
+    TreeCleaner cleaner(stemDir, keepUserFiles);
+    if (!cleaner.scan())
+    {
+        return 1;
+    }
+    if (cleaner.getSubdirectories().empty())
+    {
+        std::cout << "No numbered subdirectories found in " << stemDir << "." << std::endl;
+        return 0;
+    }
+
+    ThreadPool pool(jobCount);
+    TreeCleaner::Result result = cleaner.clean(pool);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "Removed " << result.directoriesRemoved << " of " << cleaner.getSubdirectories().size()
+              << " numbered subdirectories (" << result.entriesRemoved << " entries) in " << elapsed.count()
+              << " ms using " << pool.getThreadCount() << " workers." << std::endl;
+    if (result.directoriesKept > 0)
+    {
+        std::cout << result.directoriesKept << " subdirectories kept because they contain user files." << std::endl;
+    }
+    if (result.failures > 0)
+    {
+        std::cerr << result.failures << " entries could not be removed. Check error messages above." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int CommandLineInterface::verifyStems(const std::vector<std::string> &stemDirs)
+{
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool pool(jobCount);
+    TemplateVerifier verifier(batchSize, sortMemoryMegabytes * 1024 * 1024);
+    TemplateVerifier::Result result;
+    bool success = true;
+    for (const auto &stemDir : stemDirs)
+    {
+        if (!verifier.verifyStem(stemDir, pool, result))
+        {
+            success = false;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Verified " << result.directoriesChecked << " subdirectories in " << stemDirs.size() << " stems: "
+              << result.directoriesClean << " clean, " << result.missingFiles << " missing, " << result.modifiedFiles
+              << " modified, " << result.extraFiles << " extra, " << result.leftoverFiles << " leftover."
+              << std::endl;
+    std::cout << "Read " << result.bytesRead << " bytes in " << seconds * 1000 << " ms ("
+              << (seconds > 0 ? result.bytesRead / seconds / (1024 * 1024) : 0) << " MiB/s) using "
+              << pool.getThreadCount() << " workers." << std::endl;
+
+    return success && result.directoriesClean == result.directoriesChecked ? 0 : 1;
+}
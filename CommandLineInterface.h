@@ -0,0 +1,173 @@
+#ifndef COMMAND_LINE_INTERFACE_H
+#define COMMAND_LINE_INTERFACE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class for handling command line arguments
+ *
+ * CommandLineInterface parses the program arguments, installs the requested
+ * filesystem backend and then dispatches either to a non-interactive mode
+ * or to the interactive UserInterface.
+ */
+class CommandLineInterface
+{
+private:
+    std::string backendName;                 // Name of the filesystem backend to use ("posix" or "memory")
+    long latencyMicros;                      // Simulated round trip per filesystem operation (0 disables)
+    std::string outputTarPath;               // Archive to stream to instead of the filesystem ("-" for stdout)
+    std::string watchPath;                   // Outline to watch and apply incrementally
+    size_t jobCount;                         // Number of parallel workers (0 selects the hardware concurrency)
+    size_t batchSize;                        // Subdirectories processed per batch when enumerating a stem
+    size_t sortMemoryMegabytes;              // Memory for sorting subdirectory names before spilling to disk
+    bool unordered;                          // Process subdirectories in directory order instead of sorting
+    size_t shardFanOut;                      // Lessons per bucket for new stems with larger outlines (0 never shards)
+    std::string ioPriority;                  // I/O scheduling class ("idle" or "be:N"; empty leaves it unchanged)
+    double maxOperationsPerSecond;           // Filesystem operation limit (0 for unlimited)
+    double maxBytesPerSecond;                // Write bandwidth limit (0 for unlimited)
+    long ownerId;                            // User that receives created entries (-1 keeps the caller)
+    long groupId;                            // Group that receives created entries (-1 keeps the caller's)
+    int dirMode;                             // Mode of created directories (-1 for the umask default)
+    int fileMode;                            // Mode of created files (-1 for the umask default)
+    bool keepUserFiles;                      // Make "clean" delete only template files
+    bool useCoroutines;                      // Run "create" on the coroutine executor instead of the staged pipeline
+    size_t maxInFlight;                      // Coroutines alive at once under --coroutines (0 for 65536)
+    bool resume;                             // Make "create" continue the stem's journal of an interrupted run
+    bool rollback;                           // Make "create" remove what the journaled run created
+    bool removeUserFiles;                    // Make "create --rollback" delete created lessons whole
+    bool writeBuildFile;                     // Make "create" and "sync" write build.ninja at the stem
+    std::string statsJsonPath;               // File receiving run statistics as JSON (empty writes none)
+    std::string command;                     // Subcommand such as "copy-tree" (empty for interactive mode)
+    std::vector<std::string> positionalArgs; // Non-option arguments after the subcommand
+
+public:
+    /**
+     * @brief Constructor initializes the defaults
+     */
+    CommandLineInterface();
+
+    /**
+     * @brief Parses the program arguments
+     *
+     * @param args Arguments without the program name
+     * @return bool True if the arguments are valid and the program should run
+     */
+    bool parse(const std::vector<std::string> &args);
+
+    /**
+     * @brief Runs the application with the parsed options
+     *
+     * @return int Process exit code
+     */
+    int run();
+
+    /**
+     * @brief Prints usage information
+     */
+    static void printUsage();
+
+private:
+    /**
+     * @brief Runs the mode or subcommand selected on the command line
+     *
+     * @return int Process exit code
+     */
+    int dispatch();
+
+    /**
+     * @brief Checks that the options fit the subcommand, and that the subcommand is known
+     * and has the right number of arguments
+     *
+     * Runs without a subcommand as well, so options that need one are rejected in
+     * interactive, --watch and --output-tar mode instead of being ignored.
+     *
+     * @return bool True if the options, the subcommand and its arguments are valid
+     */
+    bool validateCommand() const;
+
+    /**
+     * @brief Installs the filesystem backend selected on the command line
+     *
+     * @return bool True if the backend was installed
+     */
+    bool installBackend();
+
+    /**
+     * @brief Prints statistics gathered by in-memory or latency backends
+     */
+    void printBackendSummary() const;
+
+    /**
+     * @brief Streams the structure of a markdown outline as a tar archive
+     *
+     * Writes the stem, every numbered subdirectory and all template files
+     * to outputTarPath without touching the filesystem backend.
+     *
+     * @param markdownPath Path to the markdown outline
+     * @return int Process exit code
+     */
+    int exportTar(const std::string &markdownPath);
+
+    /**
+     * @brief Renumbers the stem directory of an outline to match its current order
+     *
+     * @param markdownPath Path to the markdown outline
+     * @param parentDir Directory in which the stem directory lives
+     * @return int Process exit code
+     */
+    int syncOutline(const std::string &markdownPath, const std::string &parentDir);
+
+    /**
+     * @brief Creates and templates the stem of an outline with the pipelined provisioner
+     *
+     * @param markdownPath Path to the markdown outline
+     * @param parentDir Directory in which the stem directory is created
+     * @return int Process exit code
+     */
+    int createOutline(const std::string &markdownPath, const std::string &parentDir);
+
+    /**
+     * @brief Creates the stem of an outline under many parents from one prototype
+     *
+     * @param markdownPath Path to the markdown outline
+     * @param parentDirs Directories that each receive the stem
+     * @return int Process exit code
+     */
+    int fanOutOutline(const std::string &markdownPath, const std::vector<std::string> &parentDirs);
+
+    /**
+     * @brief Splits the job count between directory creators and template workers
+     *
+     * @param creators Receives the number of creation workers
+     * @param templateWorkers Receives the number of template workers
+     */
+    void splitProvisioningWorkers(size_t &creators, size_t &templateWorkers) const;
+
+    /**
+     * @brief Removes the directories that the journaled run of an outline created
+     *
+     * @param markdownPath Path to the markdown outline the run used
+     * @param parentDir Directory containing the stem directory
+     * @return int Process exit code
+     */
+    int rollbackOutline(const std::string &markdownPath, const std::string &parentDir);
+
+    /**
+     * @brief Deletes the generated lesson directories of a stem in parallel
+     *
+     * @param stemDir Stem directory to clean
+     * @return int Process exit code
+     */
+    int cleanStem(const std::string &stemDir);
+
+    /**
+     * @brief Audits the lesson directories of one or more stems against the templates
+     *
+     * @param stemDirs Stem directories to verify
+     * @return int Process exit code (1 if any difference was found)
+     */
+    int verifyStems(const std::vector<std::string> &stemDirs);
+};
+
+#endif // COMMAND_LINE_INTERFACE_H
@@ -1,11 +1,35 @@
 #include "DirectoryCopier.h"
 #include "TemplateFiles.h"
+#include "FileSystemBackend.h"
+#include "SourceTreeCopier.h"
+#include "ThreadPool.h"
+#include "StemLock.h"
+#include "StemIndex.h"
+#include "StemPrescan.h"
+#include "StemLayout.h"
+#include "ErrorLog.h"
+#include "AllocationStats.h"
+#include <unordered_map>
 #include <iostream>
 #include <filesystem>
 #include <algorithm> // For std::count_if
 
 namespace fs = std::filesystem;
 
+namespace
+{
+    // Enumeration options shared by all copiers; set once from the command line
+    size_t enumerationBatchSize = 4096;
+    size_t enumerationMemoryLimit = 64 * 1024 * 1024;
+    bool enumerationSorted = true;
+
+    // Number of subdirectory names shown before confirming; larger stems are summarized
+    constexpr size_t SAMPLE_SIZE = 20;
+
+    // Subdirectories opened ahead while waiting for confirmation; stays well below the usual fd limit
+    constexpr size_t MAX_OPEN_AHEAD = 512;
+}
+
 void DirectoryCopier::copyFilesToSubdirectories()
 {
     std::cout << "\nNice! Let's create template files in subdirectories." << std::endl;
@@ -21,19 +45,37 @@ void DirectoryCopier::copyFilesToSubdirectories()
 
 bool DirectoryCopier::copyTemplateFilesToSpecificStemDir(const std::string &stemDir)
 {
-    // Get all subdirectories
-    std::vector<fs::path> subDirs = getAllSubdirectories(stemDir);
-    if (subDirs.empty())
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    if (!backend.status(stemDir).exists)
     {
-        std::cout << "No subdirectories found in the stem directory." << std::endl;
+        std::cerr << "Error: Directory does not exist: " << stemDir << std::endl;
         return false;
     }
 
-    // Display subdirectories
-    std::cout << "\nFound " << subDirs.size() << " subdirectories:" << std::endl;
-    for (const auto &subDir : subDirs)
+    // Scan and open the subdirectories in the background while the user reads and answers
+    StemPrescan prescan(stemDir, enumerationMemoryLimit, MAX_OPEN_AHEAD, enumerationSorted);
+    if (!prescan.waitForListing())
     {
-        std::cout << "* " << subDir.filename().string() << std::endl;
+        return false;
+    }
+
+    // Count subdirectories and show a sample
+    size_t subDirCount = 0;
+    if (prescan.isComplete())
+    {
+        const std::vector<std::string> &names = prescan.getNames();
+        subDirCount = names.size();
+        if (subDirCount == 0)
+        {
+            std::cout << "No subdirectories found in the stem directory." << std::endl;
+            return false;
+        }
+        std::vector<std::string> sample(names.begin(), names.begin() + std::min(subDirCount, SAMPLE_SIZE));
+        printSubdirectorySummary(subDirCount, sample, prescan.wasServedFromIndex());
+    }
+    else if (!countSubdirectories(stemDir, subDirCount))
+    {
+        return false;
     }
 
     // Confirm operation
@@ -47,18 +89,86 @@ bool DirectoryCopier::copyTemplateFilesToSpecificStemDir(const std::string &stem
         return false;
     }
 
-    // Create template files in each subdirectory
-    int successCount = 0;
-    int totalFiles = TemplateFiles::getTemplateFileCount() * subDirs.size();
+    // Create template files, holding the stem lock throughout
+    StemLock stemLock(stemDir);
+    size_t successCount = 0;
+    size_t processedCount = 0;
+    bool summarized = subDirCount > SAMPLE_SIZE;
+    if (summarized)
+    {
+        // Per-file messages for millions of directories would dominate the run time
+        TemplateFiles::setVerbose(false);
+    }
 
-    for (const auto &subDir : subDirs)
+    std::unordered_map<std::string, std::uint8_t> states;
+    bool recordStates = StemIndex::isSupported();
+    fs::path stemPath(stemDir);
+    auto templateDirectory = [&](const FileSystemBackend::DirectoryHandle &subDir)
     {
-        std::cout << "Processing: " << subDir.filename().string() << std::endl;
-        if (createTemplateFilesIn(subDir))
+        std::string name = StemLayout::entryName(stemPath, subDir.getPath());
+        bool created;
+        if (summarized)
+        {
+            created = TemplateFiles::createTemplateFilesIn(subDir);
+        }
+        else
+        {
+            std::cout << "Processing: " << name << std::endl;
+            created = createTemplateFilesIn(subDir);
+        }
+
+        if (created)
         {
             successCount++;
+            if (recordStates)
+            {
+                states[name] = StemIndex::STATE_TEMPLATED;
+            }
+        }
+        processedCount++;
+        if (summarized && (processedCount % enumerationBatchSize == 0 || processedCount == subDirCount))
+        {
+            std::cout << "Processed " << processedCount << " of " << subDirCount << " directories..." << std::endl;
+        }
+    };
+
+    AllocationStats::Scope phase(AllocationStats::PHASE_TEMPLATE);
+    if (prescan.isComplete())
+    {
+        // The plan was prepared while the user answered; most directories are already open
+        prescan.waitForPlan();
+        for (size_t i = 0; i < prescan.getNames().size(); ++i)
+        {
+            templateDirectory(prescan.takeDirectory(i));
         }
     }
+    else
+    {
+        SubdirectoryStream stream = openSubdirectories(stemDir);
+        stream.forEachBatch([&](const std::vector<fs::path> &batch)
+                            {
+            for (const auto &subDir : batch)
+            {
+                FileSystemBackend::DirectoryHandle dir(subDir, -1);
+                try
+                {
+                    dir = backend.openDirectory(subDir);
+                }
+                catch (const fs::filesystem_error &)
+                {
+                    // Fall back to path-based writes, which report the error
+                }
+                templateDirectory(dir);
+            }
+            return true; });
+    }
+
+    TemplateFiles::setVerbose(true);
+    if (recordStates)
+    {
+        StemIndex(stemDir).recordStates(states);
+    }
+    ErrorLog::printSummary();
 
     // Report results
     if (successCount == 0)
@@ -66,9 +176,9 @@ bool DirectoryCopier::copyTemplateFilesToSpecificStemDir(const std::string &stem
         std::cout << "Failed to create template files in any directories." << std::endl;
         return false;
     }
-    else if (successCount < subDirs.size())
+    else if (successCount < processedCount)
     {
-        std::cout << "Template files created in " << successCount << " of " << subDirs.size()
+        std::cout << "Template files created in " << successCount << " of " << processedCount
                   << " directories. Check error messages above." << std::endl;
     }
     else
@@ -79,46 +189,166 @@ bool DirectoryCopier::copyTemplateFilesToSpecificStemDir(const std::string &stem
     return successCount > 0;
 }
 
-std::vector<fs::path> DirectoryCopier::getAllSubdirectories(const std::string &stemDir)
+void DirectoryCopier::copySourceTreeToSubdirectories()
 {
-    std::vector<fs::path> subDirs;
+    std::cout << "\nGreat! Let's copy a starter directory into subdirectories." << std::endl;
 
-    try
+    // Get source and stem directories
+    std::string sourceDir = getValidDirectoryPath("Please paste the path to the source dir to copy: ");
+    if (sourceDir == "q")
+        return;
+
+    std::string stemDir = getValidDirectoryPath("Please paste the path to the stem dir: ");
+    if (stemDir == "q")
+        return;
+
+    size_t subDirCount = 0;
+    if (!countSubdirectories(stemDir, subDirCount))
     {
-        // Check if directory exists first
-        if (!fs::exists(stemDir))
-        {
-            std::cerr << "Error: Directory does not exist: " << stemDir << std::endl;
-            return subDirs;
-        }
+        return;
+    }
+
+    // Confirm operation
+    std::cout << "\nCopy '" << fs::path(sourceDir).filename().string() << "' into all " << subDirCount
+              << " subdirectories? (y/n): ";
+    std::string response;
+    std::getline(std::cin, response);
 
-        // Iterate through directory entries
-        for (const auto &entry : fs::directory_iterator(stemDir))
+    if (response != "y" && response != "Y")
+    {
+        std::cout << "Operation canceled." << std::endl;
+        return;
+    }
+
+    copySourceTree(sourceDir, stemDir, 0);
+}
+
+bool DirectoryCopier::copySourceTree(const std::string &sourceDir, const std::string &stemDir, size_t jobCount)
+{
+    // Scan the source once
+    SourceTreeCopier copier(sourceDir);
+    if (!copier.scan())
+    {
+        return false;
+    }
+
+    if (!FileSystemBackend::getActive().status(stemDir).exists)
+    {
+        std::cerr << "Error: Directory does not exist: " << stemDir << std::endl;
+        return false;
+    }
+
+    std::cout << "Copying " << copier.getEntries().size() << " entries (" << copier.getTotalBytes()
+              << " bytes) into the subdirectories of " << stemDir << "..." << std::endl;
+
+    // Copy batch by batch so memory stays bounded on very large stems
+    StemLock stemLock(stemDir);
+    ThreadPool pool(jobCount);
+    SourceTreeCopier::CopyResult result;
+    size_t destinationCount = 0;
+    std::error_code ec;
+    SubdirectoryStream stream = openSubdirectories(stemDir);
+    bool readOk = stream.forEachBatch([&](const std::vector<fs::path> &batch)
+                                      {
+        // Every subdirectory except the source itself (it may live inside the stem)
+        std::vector<fs::path> destinations;
+        destinations.reserve(batch.size());
+        for (const auto &subDir : batch)
         {
-            // Only include directories (not files)
-            if (fs::is_directory(entry))
+            if (!fs::equivalent(subDir, sourceDir, ec))
             {
-                // Skip hidden directories (starting with dot)
-                std::string filename = entry.path().filename().string();
-                if (!filename.empty() && filename[0] != '.')
-                {
-                    subDirs.push_back(entry.path());
-                }
+                destinations.push_back(subDir);
             }
         }
 
-        // Sort directories by name for consistent results
-        std::sort(subDirs.begin(), subDirs.end());
+        SourceTreeCopier::CopyResult batchResult = copier.copyTo(destinations, pool);
+        result.filesCopied += batchResult.filesCopied;
+        result.filesCloned += batchResult.filesCloned;
+        result.filesFailed += batchResult.filesFailed;
+        result.destinationsFailed += batchResult.destinationsFailed;
+        result.bytesCopied += batchResult.bytesCopied;
+        destinationCount += destinations.size();
+        return true; });
+
+    if (readOk && destinationCount == 0)
+    {
+        std::cout << "No subdirectories found in the stem directory." << std::endl;
+        return false;
+    }
+
+    // Report results
+    std::cout << "Copied " << result.filesCopied << " files (" << result.bytesCopied << " bytes) into "
+              << destinationCount << " subdirectories using " << pool.getThreadCount() << " workers." << std::endl;
+    if (result.filesCloned > 0)
+    {
+        std::cout << result.filesCloned << " files were cloned (reflinked) instead of copied." << std::endl;
+    }
+    if (!readOk || result.filesFailed > 0 || result.destinationsFailed > 0)
+    {
+        std::cout << result.filesFailed << " files and " << result.destinationsFailed
+                  << " subdirectories failed. Check error messages above." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void DirectoryCopier::setEnumerationOptions(size_t batchSize, size_t memoryLimit, bool sorted)
+{
+    enumerationBatchSize = batchSize;
+    enumerationMemoryLimit = memoryLimit;
+    enumerationSorted = sorted;
+}
+
+SubdirectoryStream DirectoryCopier::openSubdirectories(const std::string &stemDir)
+{
+    return SubdirectoryStream(stemDir, enumerationBatchSize, enumerationMemoryLimit, enumerationSorted);
+}
+
+bool DirectoryCopier::countSubdirectories(const std::string &stemDir, size_t &count)
+{
+    count = 0;
+
+    // Check if directory exists first
+    if (!FileSystemBackend::getActive().status(stemDir).exists)
+    {
+        std::cerr << "Error: Directory does not exist: " << stemDir << std::endl;
+        return false;
     }
-    catch (const fs::filesystem_error &e)
+
+    // One streaming pass: memory does not grow with the number of subdirectories
+    std::vector<std::string> sample;
+    SubdirectoryStream stream = openSubdirectories(stemDir);
+    if (!stream.countAndSample(SAMPLE_SIZE, count, sample))
     {
-        std::cerr << "Error reading directory: " << e.what() << std::endl;
+        return false;
+    }
+    if (count == 0)
+    {
+        std::cout << "No subdirectories found in the stem directory." << std::endl;
+        return false;
     }
 
-    return subDirs;
+    printSubdirectorySummary(count, sample, stream.wasServedFromIndex());
+    return true;
+}
+
+void DirectoryCopier::printSubdirectorySummary(size_t count, const std::vector<std::string> &sample,
+                                               bool fromIndex) const
+{
+    // Display the subdirectories, or a sample of them for large stems
+    std::cout << "\nFound " << count << " subdirectories" << (fromIndex ? " (from index)" : "") << ":" << std::endl;
+    for (const auto &name : sample)
+    {
+        std::cout << "* " << name << std::endl;
+    }
+    if (count > sample.size())
+    {
+        std::cout << "  ... and " << count - sample.size() << " more" << std::endl;
+    }
 }
 
-bool DirectoryCopier::createTemplateFilesIn(const fs::path &destDir)
+bool DirectoryCopier::createTemplateFilesIn(const FileSystemBackend::DirectoryHandle &destDir)
 {
     try
     {
@@ -2,6 +2,8 @@
 #define DIRECTORY_COPIER_H
 
 #include "DirectoryManager.h"
+#include "SubdirectoryStream.h"
+#include "FileSystemBackend.h"
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -9,10 +11,15 @@
 namespace fs = std::filesystem;
 
 /**
- * @brief Class for creating template files in directories
+ * @brief Class for filling the subdirectories of a stem with files
  *
- * DirectoryCopier handles the creation of template files in user-specified directories.
- * Instead of copying from a root directory, it creates files using embedded templates.
+ * DirectoryCopier writes the embedded templates into every subdirectory of
+ * a stem (option 2), or replicates a user-supplied source directory into
+ * each of them through SourceTreeCopier (option 3 and `copy-tree`). The
+ * subdirectories are enumerated with SubdirectoryStream in bounded batches,
+ * sorted or in directory order, so stems with millions of entries never
+ * have to be listed in memory at once. For option 2, a StemPrescan lists and
+ * opens the subdirectories while the user confirms.
  */
 class DirectoryCopier : public DirectoryManager
 {
@@ -38,22 +45,67 @@ public:
      */
     bool copyTemplateFilesToSpecificStemDir(const std::string &stemDir);
 
+    /**
+     * @brief Copies a starter directory into subdirectories specified by user
+     *
+     * Asks for a source directory and a stem directory, then replicates the
+     * source contents into every subdirectory of the stem after confirmation.
+     */
+    void copySourceTreeToSubdirectories();
+
+    /**
+     * @brief Replicates a source directory into every subdirectory of a stem
+     *
+     * @param sourceDir Directory whose contents are copied
+     * @param stemDir Path to the stem directory containing subdirectories
+     * @param jobCount Number of parallel workers (0 selects the hardware concurrency)
+     * @return bool True if every file was copied into every subdirectory
+     */
+    bool copySourceTree(const std::string &sourceDir, const std::string &stemDir, size_t jobCount);
+
+    /**
+     * @brief Configures how stem subdirectories are enumerated
+     *
+     * @param batchSize Number of subdirectories processed per batch
+     * @param memoryLimit Approximate bytes of names held in memory while sorting
+     * @param sorted True to process subdirectories in name order
+     */
+    static void setEnumerationOptions(size_t batchSize, size_t memoryLimit, bool sorted);
+
 private:
     /**
-     * @brief Gets all subdirectories in a directory
+     * @brief Creates a batch stream over the subdirectories of a stem
+     *
+     * @param stemDir Path to the stem directory
+     * @return SubdirectoryStream Stream using the configured enumeration options
+     */
+    SubdirectoryStream openSubdirectories(const std::string &stemDir);
+
+    /**
+     * @brief Counts the subdirectories of a stem and prints the count and a sample
+     *
+     * @param stemDir Path to the stem directory
+     * @param count Receives the number of subdirectories
+     * @return bool True if the stem exists and could be read
+     */
+    bool countSubdirectories(const std::string &stemDir, size_t &count);
+
+    /**
+     * @brief Prints the subdirectory count and a sample of names
      *
-     * @param stemDir Path to the directory to scan
-     * @return std::vector<fs::path> List of subdirectory paths
+     * @param count Number of subdirectories
+     * @param sample Names to show
+     * @param fromIndex True if the list came from the stem index
      */
-    std::vector<fs::path> getAllSubdirectories(const std::string &stemDir);
+    void printSubdirectorySummary(size_t count, const std::vector<std::string> &sample, bool fromIndex) const;
 
     /**
-     * @brief Creates template files in a directory
+     * @brief Creates template files in an open directory
      *
      * @param destDir Directory where template files should be created
      * @return bool True if all files were created successfully
      */
-    bool createTemplateFilesIn(const fs::path &destDir);
+    bool createTemplateFilesIn(const FileSystemBackend::DirectoryHandle &destDir);
 };
 
 #endif // DIRECTORY_COPIER_H
\ No newline at end of file
@@ -1,4 +1,11 @@
 #include "DirectoryCreator.h"
+#include "FileSystemBackend.h"
+#include "StemLock.h"
+#include "ErrorLog.h"
+#include "StemLayout.h"
+#include "OutlineChunkParser.h"
+#include "RunJournal.h"
+#include "AllocationStats.h"
 #include <iostream>
 #include <filesystem>
 #include <iomanip>   // For formatted output
@@ -55,7 +62,7 @@ void DirectoryCreator::createDirectoryStructure()
             {
                 try
                 {
-                    fs::create_directories(parentDir);
+                    FileSystemBackend::getActive().createDirectory(parentDir);
                     std::cout << "Created directory: " << parentDir << std::endl;
                 }
                 catch (const fs::filesystem_error &e)
@@ -75,11 +82,11 @@ void DirectoryCreator::createDirectoryStructure()
         stemDir = (fs::path(parentDir) / stemDirName).string();
 
         // Create stem directory if it doesn't exist
-        if (!fs::exists(stemDir))
+        if (!FileSystemBackend::getActive().status(stemDir).exists)
         {
             try
             {
-                fs::create_directories(stemDir);
+                FileSystemBackend::getActive().createDirectory(stemDir);
                 std::cout << "Created stem directory: " << stemDir << std::endl;
             }
             catch (const fs::filesystem_error &e)
@@ -140,7 +147,7 @@ std::string DirectoryCreator::getStemDirectory()
         {
             try
             {
-                fs::create_directories(stemDir);
+                FileSystemBackend::getActive().createDirectory(stemDir);
                 std::cout << "Created directory: " << stemDir << std::endl;
             }
             catch (const fs::filesystem_error &e)
@@ -263,33 +270,53 @@ void DirectoryCreator::createSubdirectories(const std::string &stemDir, const st
     // Display a summary of directories to be created
     std::cout << "\nCreating " << subDirNames.size() << " directories inside " << stemDir << ":" << std::endl;
 
-    for (size_t i = 0; i < subDirNames.size(); ++i)
-    {
-        // Sanitize the directory name
-        std::string sanitizedName = slugifyDirectoryName(subDirNames[i]);
+    // Keep other processes provisioning the same stem out until we are done
+    StemLock stemLock(stemDir);
+
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    fs::path stemPath(stemDir);
 
-        // Format the directory name: "01 - Name", "02 - Name", etc.
-        std::string formattedName = std::to_string(i + 1);
-        if (formattedName.length() < 2)
+    // Shard a large outline into buckets, unless the stem already holds lessons that must stay where they are
+    StemLayout layout(stemPath);
+    if (!layout.load() && StemLayout::shouldShard(subDirNames.size()))
+    {
+        std::vector<FileSystemBackend::DirectoryEntry> entries = backend.listDirectory(stemPath);
+        bool empty = std::none_of(entries.begin(), entries.end(), [](const FileSystemBackend::DirectoryEntry &entry)
+                                  { return entry.isDirectory && !entry.name.empty() && entry.name[0] != '.'; });
+        if (empty && layout.enableSharding(StemLayout::getDefaultFanOut()))
         {
-            formattedName = "0" + formattedName;
+            std::cout << "Sharding into buckets of " << layout.getFanOut() << " directories." << std::endl;
         }
-        formattedName += " - " + sanitizedName;
+    }
 
-        // Create the full path
-        fs::path fullPath = fs::path(stemDir) / formattedName;
+    // Journal the run so "create --rollback" can undo it
+    RunJournal journal(stemPath);
+    if (backend.isOnDisk())
+    {
+        journal.open(false);
+    }
 
-        // Create the directory
-        try
-        {
-            fs::create_directories(fullPath);
-            std::cout << "  Created: " << fullPath.filename().string() << std::endl;
-        }
-        catch (const fs::filesystem_error &e)
+    AllocationStats::Scope phase(AllocationStats::PHASE_CREATE);
+    for (size_t i = 0; i < subDirNames.size(); ++i)
+    {
+        // Create the directory; failures are collected and summarized below
+        fs::path name = layout.getRelativePath(i + 1, formatSubdirectoryName(i + 1, subDirNames[i]));
+        std::error_code ec;
+        bool created = backend.createDirectory(stemPath / name, ec);
+        if (ec)
         {
-            std::cerr << "  Error creating directory: " << e.what() << std::endl;
+            ErrorLog::record("create directory", ec, stemPath, name);
+            continue;
         }
+        journal.record(created ? RunJournal::OP_DIRECTORY_CREATED : RunJournal::OP_DIRECTORY_EXISTED, i + 1,
+                       RunJournal::hashName(name));
+        std::cout << (created ? "  Created: " : "  Exists: ") << name.string() << std::endl;
+    }
+    if (ErrorLog::getFailureCount() == 0)
+    {
+        journal.record(RunJournal::OP_RUN_COMPLETE, 0, 0);
     }
+    ErrorLog::printSummary();
 }
 
 std::pair<std::string, std::vector<std::string>> DirectoryCreator::getDirectoryStructureFromMarkdown()
@@ -306,81 +333,10 @@ std::pair<std::string, std::vector<std::string>> DirectoryCreator::getDirectoryS
 
     try
     {
-        // Check if file exists
-        if (!fs::exists(markdownPath))
-        {
-            std::cerr << "Error: File does not exist: " << markdownPath << std::endl;
-            return {"", {}};
-        }
-
-        // Read markdown file
-        std::ifstream markdownFile(markdownPath);
-        if (!markdownFile)
-        {
-            std::cerr << "Error: Could not open file: " << markdownPath << std::endl;
-            return {"", {}};
-        }
-
         // Parse the file
-        std::string line;
-        bool firstLine = true;
-
-        while (std::getline(markdownFile, line))
+        if (!readMarkdownStructure(markdownPath, stemDirName, subDirNames))
         {
-            // Trim whitespace
-            if (!line.empty())
-            {
-                size_t first = line.find_first_not_of(" \t\n\r\f\v");
-                if (first != std::string::npos)
-                {
-                    size_t last = line.find_last_not_of(" \t\n\r\f\v");
-                    line = line.substr(first, (last - first + 1));
-                }
-                else
-                {
-                    line = "";
-                }
-            }
-
-            // Skip empty lines
-            if (line.empty())
-                continue;
-
-            // First non-empty line is considered the stem directory name
-            if (firstLine)
-            {
-                // Remove any markdown heading syntax (# ) if present
-                if (line.find("# ") == 0)
-                    stemDirName = line.substr(2);
-                else
-                    stemDirName = line;
-
-                firstLine = false;
-                continue;
-            }
-
-            // Check if line represents a subdirectory (starts with |- or - or * or similar markdown list indicators)
-            if (line.find("|-") == 0 || line.find("- ") == 0 || line.find("* ") == 0)
-            {
-                // Extract directory name by removing the marker and trimming
-                size_t nameStart = line.find_first_not_of("|- *");
-                if (nameStart != std::string::npos)
-                {
-                    std::string dirName = line.substr(nameStart);
-                    if (!dirName.empty())
-                    {
-                        size_t first = dirName.find_first_not_of(" \t");
-                        if (first != std::string::npos)
-                        {
-                            dirName = dirName.substr(first);
-                        }
-                    }
-                    if (!dirName.empty())
-                    {
-                        subDirNames.push_back(dirName);
-                    }
-                }
-            }
+            return {"", {}};
         }
 
         // Display parsed structure and allow editing
@@ -450,9 +406,27 @@ std::pair<std::string, std::vector<std::string>> DirectoryCreator::getDirectoryS
     }
 }
 
+bool DirectoryCreator::readMarkdownStructure(const std::string &markdownPath, std::string &stemDirName,
+                                             std::vector<std::string> &subDirNames)
+{
+    try
+    {
+        // Large outlines are split into chunks and parsed on all cores
+        AllocationStats::Scope phase(AllocationStats::PHASE_PARSE);
+        OutlineChunkParser parser;
+        return parser.parse(markdownPath, stemDirName, subDirNames);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error parsing markdown file: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 std::vector<std::string> DirectoryCreator::parseMarkdownFile(const std::string &markdownPath)
 {
     std::vector<std::string> subDirNames;
+    AllocationStats::Scope phase(AllocationStats::PHASE_PARSE);
 
     try
     {
@@ -527,6 +501,23 @@ std::vector<std::string> DirectoryCreator::parseMarkdownFile(const std::string &
     }
 }
 
+std::string DirectoryCreator::formatSubdirectoryName(size_t number, const std::string &dirName)
+{
+    AllocationStats::Scope phase(AllocationStats::PHASE_SANITIZE);
+
+    // Sanitize the directory name
+    std::string sanitizedName = slugifyDirectoryName(dirName);
+
+    // Format the directory name: "01 - Name", "02 - Name", etc.
+    std::string formattedName = std::to_string(number);
+    if (formattedName.length() < 2)
+    {
+        formattedName = "0" + formattedName;
+    }
+    formattedName += " - " + sanitizedName;
+    return formattedName;
+}
+
 std::string DirectoryCreator::slugifyDirectoryName(const std::string &dirName)
 {
     std::string result = dirName;
@@ -23,7 +23,7 @@ private:
      * @param dirName Directory name to sanitize
      * @return std::string Sanitized directory name
      */
-    std::string slugifyDirectoryName(const std::string &dirName);
+    static std::string slugifyDirectoryName(const std::string &dirName);
 
 public:
     /**
@@ -46,6 +46,29 @@ public:
      */
     std::string getLastStemDirectory() const;
 
+    /**
+     * @brief Reads the stem name and subdirectory names from a markdown file
+     *
+     * Parses the file without any user interaction. Large files are split
+     * into chunks and parsed on several threads.
+     *
+     * @param markdownPath Path to the markdown file
+     * @param stemDirName Receives the stem directory name (first non-empty line)
+     * @param subDirNames Receives the subdirectory names in file order
+     * @return bool True if the file could be read
+     */
+    bool readMarkdownStructure(const std::string &markdownPath, std::string &stemDirName,
+                               std::vector<std::string> &subDirNames);
+
+    /**
+     * @brief Builds the numbered, sanitized name of a subdirectory
+     *
+     * @param number One-based position of the subdirectory
+     * @param dirName Raw subdirectory name
+     * @return std::string Name such as "01 - Number Systems"
+     */
+    static std::string formatSubdirectoryName(size_t number, const std::string &dirName);
+
 private:
     /**
      * @brief Gets a stem directory path from the user
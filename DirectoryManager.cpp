@@ -1,4 +1,5 @@
 #include "DirectoryManager.h"
+#include "FileSystemBackend.h"
 #include <iostream>
 #include <string>
 #include <filesystem>
@@ -22,7 +23,7 @@ bool DirectoryManager::isValidDirectory(const std::string &path) const
     try
     {
         // Check if path exists and is a directory
-        return fs::exists(cleanedPath) && fs::is_directory(cleanedPath);
+        return FileSystemBackend::getActive().status(cleanedPath).isDirectory;
     }
     catch (const fs::filesystem_error &e)
     {
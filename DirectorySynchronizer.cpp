@@ -0,0 +1,276 @@
+#include "DirectorySynchronizer.h"
+#include "DirectoryCreator.h"
+#include "TemplateFiles.h"
+#include "FileSystemBackend.h"
+#include "ErrorLog.h"
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+DirectorySynchronizer::DirectorySynchronizer(const fs::path &stemDir) : stemDir(stemDir), renameOperations(0)
+{
+}
+
+bool DirectorySynchronizer::splitNumberedName(const std::string &dirName, size_t &number, std::string &baseName)
+{
+    size_t digits = 0;
+    while (digits < dirName.size() && dirName[digits] >= '0' && dirName[digits] <= '9')
+    {
+        digits++;
+    }
+
+    if (digits == 0 || digits > 9 || dirName.compare(digits, 3, " - ") != 0)
+    {
+        return false;
+    }
+
+    number = std::stoul(dirName.substr(0, digits));
+    baseName = dirName.substr(digits + 3);
+    return true;
+}
+
+DirectorySynchronizer::Plan DirectorySynchronizer::computePlan(const std::vector<std::string> &subDirNames)
+{
+    Plan plan;
+    existingNames.clear();
+
+    // Index the existing numbered directories by sanitized name
+    std::unordered_map<std::string, std::vector<std::string>> existingByName;
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    if (backend.status(stemDir).isDirectory)
+    {
+        for (const auto &entry : backend.listDirectory(stemDir))
+        {
+            existingNames.push_back(entry.name);
+
+            size_t number;
+            std::string baseName;
+            if (entry.isDirectory && splitNumberedName(entry.name, number, baseName))
+            {
+                existingByName[baseName].push_back(entry.name);
+            }
+        }
+    }
+
+    // Work out the name each outline entry must end up with
+    std::vector<std::string> targets;
+    std::vector<std::string> targetBaseNames;
+    targets.reserve(subDirNames.size());
+    targetBaseNames.reserve(subDirNames.size());
+    for (size_t i = 0; i < subDirNames.size(); ++i)
+    {
+        std::string target = DirectoryCreator::formatSubdirectoryName(i + 1, subDirNames[i]);
+        size_t number;
+        std::string baseName;
+        splitNumberedName(target, number, baseName);
+        targets.push_back(target);
+        targetBaseNames.push_back(baseName);
+    }
+
+    // Pass 1: directories already at their target name stay where they are
+    std::unordered_set<std::string> used;
+    std::vector<char> matched(targets.size(), 0);
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        auto it = existingByName.find(targetBaseNames[i]);
+        if (it == existingByName.end())
+            continue;
+
+        auto &candidates = it->second;
+        if (std::find(candidates.begin(), candidates.end(), targets[i]) != candidates.end() &&
+            used.insert(targets[i]).second)
+        {
+            matched[i] = 1;
+            plan.unchanged++;
+        }
+    }
+
+    // Pass 2: remaining entries take the lowest-numbered unused directory with the same name
+    for (auto &[baseName, candidates] : existingByName)
+    {
+        std::sort(candidates.begin(), candidates.end(), [](const std::string &a, const std::string &b)
+                  {
+            size_t numberA = 0, numberB = 0;
+            std::string ignored;
+            splitNumberedName(a, numberA, ignored);
+            splitNumberedName(b, numberB, ignored);
+            return numberA != numberB ? numberA < numberB : a < b; });
+    }
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        if (matched[i])
+            continue;
+
+        auto it = existingByName.find(targetBaseNames[i]);
+        if (it != existingByName.end())
+        {
+            for (const auto &candidate : it->second)
+            {
+                if (used.insert(candidate).second)
+                {
+                    plan.renames.push_back({candidate, targets[i]});
+                    matched[i] = 1;
+                    break;
+                }
+            }
+        }
+
+        if (!matched[i])
+        {
+            plan.creates.push_back(targets[i]);
+        }
+    }
+
+    // Whatever is left over no longer appears in the outline
+    for (const auto &[baseName, candidates] : existingByName)
+    {
+        for (const auto &candidate : candidates)
+        {
+            if (used.find(candidate) == used.end())
+            {
+                plan.orphans.push_back(candidate);
+            }
+        }
+    }
+    std::sort(plan.orphans.begin(), plan.orphans.end());
+
+    return plan;
+}
+
+bool DirectorySynchronizer::applyPlan(const Plan &plan)
+{
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    bool success = true;
+
+    // Names currently present in the stem, updated as renames happen
+    std::unordered_set<std::string> occupied(existingNames.begin(), existingNames.end());
+
+    // Renames still waiting for their target to become free, keyed by current name
+    std::vector<Rename> pending = plan.renames;
+    std::unordered_set<std::string> pendingSources;
+    for (const auto &rename : pending)
+    {
+        pendingSources.insert(rename.from);
+    }
+
+    // A target held by something that is not going to move can never be freed
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [&](const Rename &rename)
+                                 {
+        if (occupied.count(rename.to) && !pendingSources.count(rename.to))
+        {
+            std::cerr << "  Error: Cannot rename '" << rename.from << "' to '" << rename.to
+                      << "': target exists." << std::endl;
+            pendingSources.erase(rename.from);
+            success = false;
+            return true;
+        }
+        return false; }),
+                  pending.end());
+
+    size_t temporaryCounter = 0;
+    while (!pending.empty())
+    {
+        // Execute every rename whose target is free
+        bool progress = false;
+        for (size_t i = 0; i < pending.size();)
+        {
+            const Rename &rename = pending[i];
+            if (occupied.count(rename.to))
+            {
+                ++i;
+                continue;
+            }
+
+            try
+            {
+                backend.renameEntry(stemDir / rename.from, stemDir / rename.to);
+                renameOperations++;
+                std::cout << "  Renamed: " << rename.from << " -> " << rename.to << std::endl;
+                occupied.insert(rename.to);
+            }
+            catch (const fs::filesystem_error &e)
+            {
+                std::cerr << "  Error renaming directory: " << e.what() << std::endl;
+                success = false;
+            }
+
+            occupied.erase(rename.from);
+            pendingSources.erase(rename.from);
+            pending[i] = pending.back();
+            pending.pop_back();
+            progress = true;
+        }
+
+        if (progress || pending.empty())
+            continue;
+
+        // Every remaining target is held by another pending source: a cycle. Park one source.
+        Rename &rename = pending.front();
+        std::string temporary;
+        do
+        {
+            temporary = ".sync-tmp-" + std::to_string(temporaryCounter++);
+        } while (occupied.count(temporary));
+
+        try
+        {
+            backend.renameEntry(stemDir / rename.from, stemDir / temporary);
+            renameOperations++;
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            std::cerr << "  Error renaming directory: " << e.what() << std::endl;
+            success = false;
+            pendingSources.erase(rename.from);
+            pending.erase(pending.begin());
+            continue;
+        }
+        occupied.erase(rename.from);
+        occupied.insert(temporary);
+        pendingSources.erase(rename.from);
+        pendingSources.insert(temporary);
+        rename.from = temporary;
+    }
+
+    // Create and template the entries that have no directory yet
+    for (const auto &name : plan.creates)
+    {
+        try
+        {
+            fs::path subDir = stemDir / name;
+            if (backend.createDirectory(subDir))
+            {
+                std::cout << "  Created: " << name << std::endl;
+                if (!TemplateFiles::createTemplateFilesIn(subDir))
+                {
+                    success = false;
+                }
+            }
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            std::cerr << "  Error creating directory: " << e.what() << std::endl;
+            success = false;
+        }
+    }
+
+    for (const auto &name : plan.orphans)
+    {
+        std::cout << "  Not in outline (left on disk): " << name << std::endl;
+    }
+
+    // Template failures were collected while creating; report them grouped
+    if (ErrorLog::printSummary())
+    {
+        success = false;
+    }
+    return success;
+}
+
+size_t DirectorySynchronizer::getRenameOperationCount() const
+{
+    return renameOperations;
+}
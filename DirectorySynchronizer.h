@@ -0,0 +1,89 @@
+#ifndef DIRECTORY_SYNCHRONIZER_H
+#define DIRECTORY_SYNCHRONIZER_H
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Renumbers existing lesson directories to match an edited outline
+ *
+ * DirectorySynchronizer matches existing "NN - Name" directories to outline
+ * entries by their sanitized name and moves them to their new numbers with
+ * the smallest possible set of renames, so their contents are kept. Rename
+ * cycles are broken through temporary names. Entries without a directory are
+ * created and templated; directories without an entry are reported.
+ */
+class DirectorySynchronizer
+{
+public:
+    /**
+     * @brief Structure representing a planned rename
+     */
+    struct Rename
+    {
+        std::string from; // Current directory name
+        std::string to;   // Directory name required by the outline
+    };
+
+    /**
+     * @brief Structure representing the complete synchronization plan
+     */
+    struct Plan
+    {
+        std::vector<Rename> renames;      // Directories that move to a new number
+        std::vector<std::string> creates; // Directories that do not exist yet
+        std::vector<std::string> orphans; // Numbered directories with no outline entry
+        size_t unchanged = 0;             // Directories already in place
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param stemDir Stem directory that holds the numbered subdirectories
+     */
+    explicit DirectorySynchronizer(const fs::path &stemDir);
+
+    /**
+     * @brief Computes the plan for an outline without touching the filesystem
+     *
+     * @param subDirNames Subdirectory names in outline order
+     * @return Plan Renames, creations and orphans
+     */
+    Plan computePlan(const std::vector<std::string> &subDirNames);
+
+    /**
+     * @brief Applies a plan to the stem directory
+     *
+     * @param plan Plan returned by computePlan
+     * @return bool True if every operation succeeded
+     */
+    bool applyPlan(const Plan &plan);
+
+    /**
+     * @brief Gets the number of rename operations issued by applyPlan
+     *
+     * @return size_t Rename count, including moves through temporary names
+     */
+    size_t getRenameOperationCount() const;
+
+    /**
+     * @brief Splits "NN - Name" into its number and name
+     *
+     * @param dirName Directory name
+     * @param number Receives the numeric prefix
+     * @param baseName Receives the name after the separator
+     * @return bool True if the name has a numeric prefix
+     */
+    static bool splitNumberedName(const std::string &dirName, size_t &number, std::string &baseName);
+
+private:
+
+    fs::path stemDir;                       // Stem directory being synchronized
+    std::vector<std::string> existingNames; // Every entry name currently in the stem
+    size_t renameOperations;                // Renames issued so far
+};
+
+#endif // DIRECTORY_SYNCHRONIZER_H
@@ -0,0 +1,186 @@
+#include "ErrorLog.h"
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // All failures of one operation and error code
+    struct Group
+    {
+        const char *operation;               // Operation that failed
+        int value;                           // Error value, usually an errno
+        const std::error_category *category; // Category the value belongs to
+        size_t count;                        // Number of failures
+        fs::path::string_type prefix;        // Longest directory prefix shared by all failures
+        fs::path example;                    // First failing path
+    };
+
+    // Failures recorded by one thread; the mutex is only contended while summarizing
+    struct Shard
+    {
+        std::mutex mutex;
+        std::vector<Group> groups;
+    };
+
+    // Shards of every thread that ever recorded a failure; they outlive their threads
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    // Gets the shard of the calling thread, registering it on first use
+    Shard &localShard()
+    {
+        thread_local Shard *shard = nullptr;
+        if (!shard)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            shards.push_back(std::make_unique<Shard>());
+            shard = shards.back().get();
+        }
+        return *shard;
+    }
+
+    // Shortens a prefix to the directory components it shares with a path, without allocating
+    void shrinkPrefix(fs::path::string_type &prefix, const fs::path::string_type &path)
+    {
+        const auto separator = fs::path::preferred_separator;
+        size_t common = 0;
+        size_t limit = std::min(prefix.size(), path.size());
+        while (common < limit && prefix[common] == path[common])
+        {
+            ++common;
+        }
+
+        // The whole prefix matches and ends at a component boundary of the path
+        if (common == prefix.size() && (common == path.size() || path[common] == separator))
+        {
+            return;
+        }
+        // The path itself is a leading component sequence of the prefix
+        if (common == path.size() && prefix[common] == separator)
+        {
+            prefix.resize(common);
+            return;
+        }
+
+        // Cut back to the last separator both share; keep a lone root separator
+        size_t cut = common > 0 ? prefix.rfind(separator, common - 1) : fs::path::string_type::npos;
+        if (cut == fs::path::string_type::npos)
+        {
+            prefix.clear();
+        }
+        else
+        {
+            prefix.resize(cut == 0 ? 1 : cut);
+        }
+    }
+
+    // Adds failures to the matching group of a list, or starts a new group
+    void addToGroups(std::vector<Group> &groups, const char *operation, const std::error_code &ec, size_t count,
+                     const fs::path::string_type &directory, const fs::path &directoryPath,
+                     const fs::path &relativePath)
+    {
+        for (auto &group : groups)
+        {
+            if (group.value == ec.value() && group.category == &ec.category() &&
+                std::strcmp(group.operation, operation) == 0)
+            {
+                group.count += count;
+                shrinkPrefix(group.prefix, directory);
+                return;
+            }
+        }
+        groups.push_back({operation, ec.value(), &ec.category(), count, directory,
+                          relativePath.empty() ? directoryPath : directoryPath / relativePath});
+    }
+}
+
+void ErrorLog::record(const char *operation, const std::error_code &ec, const fs::path &directory,
+                      const fs::path &relativePath)
+{
+    Shard &shard = localShard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    addToGroups(shard.groups, operation, ec, 1, directory.native(), directory, relativePath);
+}
+
+size_t ErrorLog::getFailureCount()
+{
+    size_t count = 0;
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    for (const auto &shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto &group : shard->groups)
+        {
+            count += group.count;
+        }
+    }
+    return count;
+}
+
+bool ErrorLog::printSummary()
+{
+    // Merge the shards of all threads
+    std::vector<Group> merged;
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        for (const auto &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for (const auto &group : shard->groups)
+            {
+                std::error_code ec(group.value, *group.category);
+                size_t before = merged.size();
+                addToGroups(merged, group.operation, ec, group.count, group.prefix, group.prefix, fs::path());
+                if (merged.size() > before)
+                {
+                    merged.back().example = group.example;
+                }
+            }
+            shard->groups.clear();
+        }
+    }
+    if (merged.empty())
+    {
+        return false;
+    }
+
+    // Most frequent causes first
+    std::sort(merged.begin(), merged.end(), [](const Group &a, const Group &b)
+              { return a.count > b.count; });
+
+    size_t total = 0;
+    for (const auto &group : merged)
+    {
+        total += group.count;
+    }
+    std::cerr << "\n" << total << " operations failed:" << std::endl;
+    for (const auto &group : merged)
+    {
+        std::error_code ec(group.value, *group.category);
+        std::cerr << "  " << group.count << " x " << group.operation << ": " << ec.message() << " (error " << group.value
+                  << ")";
+        if (!group.prefix.empty())
+        {
+            std::cerr << " under " << fs::path(group.prefix).string();
+        }
+        std::cerr << "\n      e.g. " << group.example.string() << "\n";
+    }
+    std::cerr.flush();
+    return true;
+}
+
+void ErrorLog::clear()
+{
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    for (const auto &shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->groups.clear();
+    }
+}
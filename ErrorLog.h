@@ -0,0 +1,57 @@
+#ifndef ERROR_LOG_H
+#define ERROR_LOG_H
+
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Collects filesystem failures and reports them grouped by cause
+ *
+ * Worker threads record failures into their own shard instead of writing a
+ * line to std::cerr for each one. A shard keeps one group per operation and
+ * error code with a count, the longest path prefix shared by all failures of
+ * the group and the first failing path as an example. Recording a failure
+ * that joins an existing group does not allocate. printSummary() merges the
+ * shards and prints one line per group, so a permission problem that hits
+ * twenty thousand directories produces two lines of output.
+ */
+class ErrorLog
+{
+public:
+    /**
+     * @brief Records a failed operation for the calling thread
+     *
+     * @param operation Short static description such as "write file"
+     * @param ec Error reported by the operation
+     * @param directory Directory the operation worked in
+     * @param relativePath Entry inside the directory (empty if the directory itself failed)
+     */
+    static void record(const char *operation, const std::error_code &ec, const fs::path &directory,
+                       const fs::path &relativePath = fs::path());
+
+    /**
+     * @brief Gets the number of failures recorded since the last summary
+     *
+     * @return size_t Failure count over all threads
+     */
+    static size_t getFailureCount();
+
+    /**
+     * @brief Prints the grouped failures to std::cerr and clears the log
+     *
+     * Must not be called while workers are still recording.
+     *
+     * @return bool True if any failure was printed
+     */
+    static bool printSummary();
+
+    /**
+     * @brief Discards all recorded failures
+     */
+    static void clear();
+
+};
+
+#endif // ERROR_LOG_H
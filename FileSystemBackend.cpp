@@ -0,0 +1,140 @@
+#include "FileSystemBackend.h"
+#include "PosixFileSystemBackend.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Holds the process-wide backend; created lazily on first use
+    std::unique_ptr<FileSystemBackend> &activeBackend()
+    {
+        static std::unique_ptr<FileSystemBackend> backend;
+        return backend;
+    }
+}
+
+FileSystemBackend::DirectoryHandle::DirectoryHandle(fs::path path, int descriptor)
+    : path(std::move(path)), descriptor(descriptor)
+{
+}
+
+FileSystemBackend::DirectoryHandle::~DirectoryHandle()
+{
+#ifndef _WIN32
+    if (descriptor >= 0)
+    {
+        ::close(descriptor);
+    }
+#endif
+}
+
+FileSystemBackend::DirectoryHandle::DirectoryHandle(DirectoryHandle &&other) noexcept
+    : path(std::move(other.path)), descriptor(other.descriptor)
+{
+    other.descriptor = -1;
+}
+
+FileSystemBackend::DirectoryHandle &FileSystemBackend::DirectoryHandle::operator=(DirectoryHandle &&other) noexcept
+{
+    if (this != &other)
+    {
+#ifndef _WIN32
+        if (descriptor >= 0)
+        {
+            ::close(descriptor);
+        }
+#endif
+        path = std::move(other.path);
+        descriptor = other.descriptor;
+        other.descriptor = -1;
+    }
+    return *this;
+}
+
+const fs::path &FileSystemBackend::DirectoryHandle::getPath() const
+{
+    return path;
+}
+
+int FileSystemBackend::DirectoryHandle::getDescriptor() const
+{
+    return descriptor;
+}
+
+FileSystemBackend::DirectoryHandle FileSystemBackend::createAndOpenDirectory(const fs::path &dirPath, bool &created)
+{
+    created = createDirectory(dirPath);
+    return DirectoryHandle(dirPath, -1);
+}
+
+FileSystemBackend::DirectoryHandle FileSystemBackend::createAndOpenDirectory(const fs::path &dirPath, bool &created,
+                                                                             std::error_code &ec)
+{
+    created = createDirectory(dirPath, ec);
+    if (ec)
+    {
+        return DirectoryHandle();
+    }
+    return DirectoryHandle(dirPath, -1);
+}
+
+FileSystemBackend::DirectoryHandle FileSystemBackend::openDirectory(const fs::path &dirPath)
+{
+    if (!status(dirPath).isDirectory)
+    {
+        throw fs::filesystem_error("Not a directory", dirPath, std::make_error_code(std::errc::not_a_directory));
+    }
+    return DirectoryHandle(dirPath, -1);
+}
+
+bool FileSystemBackend::createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath)
+{
+    return createDirectory(parent.getPath() / relativePath);
+}
+
+bool FileSystemBackend::createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath,
+                                          std::error_code &ec)
+{
+    return createDirectory(parent.getPath() / relativePath, ec);
+}
+
+void FileSystemBackend::writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content)
+{
+    writeFile(parent.getPath() / relativePath, content);
+}
+
+void FileSystemBackend::writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content,
+                                    std::error_code &ec)
+{
+    writeFile(parent.getPath() / relativePath, content, ec);
+}
+
+void FileSystemBackend::forEachEntry(const fs::path &dirPath, const std::function<void(const DirectoryEntry &)> &visitor)
+{
+    for (const auto &entry : listDirectory(dirPath))
+    {
+        visitor(entry);
+    }
+}
+
+bool FileSystemBackend::isOnDisk() const
+{
+    return false;
+}
+
+FileSystemBackend &FileSystemBackend::getActive()
+{
+    std::unique_ptr<FileSystemBackend> &backend = activeBackend();
+    if (!backend)
+    {
+        backend = std::make_unique<PosixFileSystemBackend>();
+    }
+    return *backend;
+}
+
+void FileSystemBackend::setActive(std::unique_ptr<FileSystemBackend> backend)
+{
+    activeBackend() = std::move(backend);
+}
@@ -0,0 +1,258 @@
+#ifndef FILE_SYSTEM_BACKEND_H
+#define FILE_SYSTEM_BACKEND_H
+
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Abstract interface for all filesystem I/O performed by the tool
+ *
+ * FileSystemBackend decouples the directory and template engine from the
+ * real filesystem. The active backend is process-wide and defaults to the
+ * POSIX implementation. Methods report failures by throwing fs::filesystem_error,
+ * mirroring the throwing overloads of std::filesystem. The operations on the
+ * provisioning hot path also have std::error_code overloads that never throw,
+ * so failure-heavy runs cost no more than successful ones. All methods are safe to
+ * call concurrently, from several threads and (for on-disk backends) from
+ * several processes working on the same tree.
+ */
+class FileSystemBackend
+{
+public:
+    /**
+     * @brief Structure representing a single directory listing entry
+     */
+    struct DirectoryEntry
+    {
+        std::string name; // Name of the entry (no path components)
+        bool isDirectory; // True if the entry is a directory
+    };
+
+    /**
+     * @brief Structure representing the result of a stat call
+     */
+    struct FileStatus
+    {
+        bool exists = false;      // True if the path exists
+        bool isDirectory = false; // True if the path is a directory
+        std::uintmax_t size = 0;  // Size in bytes (files only)
+    };
+
+    /**
+     * @brief Open directory that later operations can be performed relative to
+     *
+     * On POSIX on-disk backends the handle owns a directory file descriptor so
+     * that files inside it are created with openat/mkdirat without resolving
+     * the full path again. Other backends only carry the path.
+     */
+    class DirectoryHandle
+    {
+    public:
+        DirectoryHandle() = default;
+        DirectoryHandle(fs::path path, int descriptor);
+        ~DirectoryHandle();
+        DirectoryHandle(DirectoryHandle &&other) noexcept;
+        DirectoryHandle &operator=(DirectoryHandle &&other) noexcept;
+        DirectoryHandle(const DirectoryHandle &) = delete;
+        DirectoryHandle &operator=(const DirectoryHandle &) = delete;
+
+        /**
+         * @brief Gets the path the handle was opened with
+         *
+         * @return const fs::path& Directory path
+         */
+        const fs::path &getPath() const;
+
+        /**
+         * @brief Gets the directory file descriptor
+         *
+         * @return int Descriptor, or -1 if the backend does not use descriptors
+         */
+        int getDescriptor() const;
+
+    private:
+        fs::path path;       // Directory path
+        int descriptor = -1; // Owned directory descriptor (-1 if none)
+    };
+
+    virtual ~FileSystemBackend() = default;
+
+    /**
+     * @brief Creates a directory and any missing parents
+     *
+     * @param dirPath Directory to create
+     * @return bool True if the directory was created, false if it already existed
+     */
+    virtual bool createDirectory(const fs::path &dirPath) = 0;
+
+    /**
+     * @brief Creates or truncates a file and writes the given content to it
+     *
+     * @param filePath File to write
+     * @param content Bytes to write
+     */
+    virtual void writeFile(const fs::path &filePath, std::string_view content) = 0;
+
+    /**
+     * @brief Creates a directory and any missing parents without throwing
+     *
+     * @param dirPath Directory to create
+     * @param ec Set to the error on failure, cleared on success
+     * @return bool True if the directory was created, false if it already existed or on error
+     */
+    virtual bool createDirectory(const fs::path &dirPath, std::error_code &ec) = 0;
+
+    /**
+     * @brief Creates or truncates a file without throwing
+     *
+     * @param filePath File to write
+     * @param content Bytes to write
+     * @param ec Set to the error on failure, cleared on success
+     */
+    virtual void writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec) = 0;
+
+    /**
+     * @brief Creates a directory if needed and opens it
+     *
+     * @param dirPath Directory to create and open
+     * @param created Set to true if the directory did not exist before
+     * @return DirectoryHandle Handle for relative operations
+     */
+    virtual DirectoryHandle createAndOpenDirectory(const fs::path &dirPath, bool &created);
+
+    /**
+     * @brief Creates a directory if needed and opens it without throwing
+     *
+     * @param dirPath Directory to create and open
+     * @param created Set to true if the directory did not exist before
+     * @param ec Set to the error on failure, cleared on success
+     * @return DirectoryHandle Handle for relative operations (empty on error)
+     */
+    virtual DirectoryHandle createAndOpenDirectory(const fs::path &dirPath, bool &created, std::error_code &ec);
+
+    /**
+     * @brief Opens an existing directory for relative operations
+     *
+     * @param dirPath Directory to open
+     * @return DirectoryHandle Handle for relative operations
+     */
+    virtual DirectoryHandle openDirectory(const fs::path &dirPath);
+
+    /**
+     * @brief Creates a directory relative to an open directory
+     *
+     * @param parent Open parent directory
+     * @param relativePath Path of the new directory relative to parent
+     * @return bool True if the directory was created, false if it already existed
+     */
+    virtual bool createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath);
+
+    /**
+     * @brief Creates a directory relative to an open directory without throwing
+     *
+     * @param parent Open parent directory
+     * @param relativePath Path of the new directory relative to parent
+     * @param ec Set to the error on failure, cleared on success
+     * @return bool True if the directory was created, false if it already existed or on error
+     */
+    virtual bool createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath, std::error_code &ec);
+
+    /**
+     * @brief Creates or replaces a file relative to an open directory
+     *
+     * @param parent Open parent directory
+     * @param relativePath Path of the file relative to parent
+     * @param content Bytes to write
+     */
+    virtual void writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content);
+
+    /**
+     * @brief Creates or replaces a file relative to an open directory without throwing
+     *
+     * @param parent Open parent directory
+     * @param relativePath Path of the file relative to parent
+     * @param content Bytes to write
+     * @param ec Set to the error on failure, cleared on success
+     */
+    virtual void writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content,
+                             std::error_code &ec);
+
+    /**
+     * @brief Renames a file or directory, moving its contents along with it
+     *
+     * Fails if the destination already exists.
+     *
+     * @param from Existing path
+     * @param to New path
+     */
+    virtual void renameEntry(const fs::path &from, const fs::path &to) = 0;
+
+    /**
+     * @brief Lists the entries of a directory
+     *
+     * @param dirPath Directory to list
+     * @return std::vector<DirectoryEntry> Entries in unspecified order
+     */
+    virtual std::vector<DirectoryEntry> listDirectory(const fs::path &dirPath) = 0;
+
+    /**
+     * @brief Streams the entries of a directory without collecting them
+     *
+     * Memory use does not grow with the directory size on backends that
+     * override it; the default implementation iterates listDirectory().
+     *
+     * @param dirPath Directory to list
+     * @param visitor Called once per entry, in unspecified order
+     */
+    virtual void forEachEntry(const fs::path &dirPath, const std::function<void(const DirectoryEntry &)> &visitor);
+
+    /**
+     * @brief Gets the status of a path without throwing if it does not exist
+     *
+     * @param path Path to inspect
+     * @return FileStatus Status of the path
+     */
+    virtual FileStatus status(const fs::path &path) = 0;
+
+    /**
+     * @brief Checks whether the backend operates on the real, shared filesystem
+     *
+     * Only such backends need inter-process locking.
+     *
+     * @return bool True for on-disk backends
+     */
+    virtual bool isOnDisk() const;
+
+    /**
+     * @brief Gets a short human readable name of the backend
+     *
+     * @return std::string Backend name
+     */
+    virtual std::string getName() const = 0;
+
+    /**
+     * @brief Gets the process-wide backend used by the engine
+     *
+     * @return FileSystemBackend& The active backend
+     */
+    static FileSystemBackend &getActive();
+
+    /**
+     * @brief Replaces the process-wide backend
+     *
+     * Must be called before any worker threads are started.
+     *
+     * @param backend The backend to install
+     */
+    static void setActive(std::unique_ptr<FileSystemBackend> backend);
+};
+
+#endif // FILE_SYSTEM_BACKEND_H
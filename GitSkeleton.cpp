@@ -0,0 +1,393 @@
+#include "GitSkeleton.h"
+#include <array>
+#include <map>
+#include <algorithm>
+#include <string_view>
+
+namespace
+{
+    // Incremental SHA-1 as used for git object IDs and the index checksum
+    class Sha1
+    {
+    public:
+        void update(std::string_view data)
+        {
+            for (char c : data)
+            {
+                block[blockSize++] = static_cast<unsigned char>(c);
+                if (blockSize == block.size())
+                {
+                    compress();
+                    blockSize = 0;
+                }
+            }
+            totalBytes += data.size();
+        }
+
+        // Pads the message and returns the 20-byte digest
+        std::string finish()
+        {
+            std::uint64_t bitLength = totalBytes * 8;
+            update(std::string_view("\x80", 1));
+            while (blockSize != 56)
+            {
+                update(std::string_view("\0", 1));
+            }
+            std::string length(8, '\0');
+            for (int i = 0; i < 8; ++i)
+            {
+                length[i] = static_cast<char>(bitLength >> (56 - 8 * i));
+            }
+            update(length);
+
+            std::string digest(20, '\0');
+            for (size_t i = 0; i < 20; ++i)
+            {
+                digest[i] = static_cast<char>(state[i / 4] >> (24 - 8 * (i % 4)));
+            }
+            return digest;
+        }
+
+    private:
+        static std::uint32_t rotate(std::uint32_t value, int bits)
+        {
+            return (value << bits) | (value >> (32 - bits));
+        }
+
+        void compress()
+        {
+            std::uint32_t w[80];
+            for (int i = 0; i < 16; ++i)
+            {
+                w[i] = static_cast<std::uint32_t>(block[4 * i]) << 24 |
+                       static_cast<std::uint32_t>(block[4 * i + 1]) << 16 |
+                       static_cast<std::uint32_t>(block[4 * i + 2]) << 8 | block[4 * i + 3];
+            }
+            for (int i = 16; i < 80; ++i)
+            {
+                w[i] = rotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+            }
+
+            std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+            for (int i = 0; i < 80; ++i)
+            {
+                std::uint32_t f, k;
+                if (i < 20)
+                {
+                    f = (b & c) | (~b & d);
+                    k = 0x5A827999;
+                }
+                else if (i < 40)
+                {
+                    f = b ^ c ^ d;
+                    k = 0x6ED9EBA1;
+                }
+                else if (i < 60)
+                {
+                    f = (b & c) | (b & d) | (c & d);
+                    k = 0x8F1BBCDC;
+                }
+                else
+                {
+                    f = b ^ c ^ d;
+                    k = 0xCA62C1D6;
+                }
+                std::uint32_t temp = rotate(a, 5) + f + e + k + w[i];
+                e = d;
+                d = c;
+                c = rotate(b, 30);
+                b = a;
+                a = temp;
+            }
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+        }
+
+        std::array<std::uint32_t, 5> state = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        std::array<unsigned char, 64> block{}; // Bytes not yet compressed
+        size_t blockSize = 0;                  // Used bytes of block
+        std::uint64_t totalBytes = 0;          // Message length so far
+    };
+
+    std::string toHex(std::string_view bytes)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(bytes.size() * 2);
+        for (char c : bytes)
+        {
+            hex += digits[static_cast<unsigned char>(c) >> 4];
+            hex += digits[static_cast<unsigned char>(c) & 0x0F];
+        }
+        return hex;
+    }
+
+    // Raw 20-byte ID of an object
+    std::string objectId(std::string_view type, std::string_view content)
+    {
+        Sha1 sha;
+        sha.update(type);
+        sha.update(" " + std::to_string(content.size()));
+        sha.update(std::string_view("\0", 1));
+        sha.update(content);
+        return sha.finish();
+    }
+
+    // Wraps data in a zlib stream of stored deflate blocks
+    std::string zlibStore(std::string_view data)
+    {
+        std::string out = "\x78\x01";
+        size_t offset = 0;
+        do
+        {
+            size_t length = std::min<size_t>(data.size() - offset, 65535);
+            bool last = offset + length == data.size();
+            out += static_cast<char>(last ? 1 : 0);
+            out += static_cast<char>(length & 0xFF);
+            out += static_cast<char>(length >> 8);
+            out += static_cast<char>(~length & 0xFF);
+            out += static_cast<char>((~length >> 8) & 0xFF);
+            out.append(data.substr(offset, length));
+            offset += length;
+        } while (offset < data.size());
+
+        // Adler-32 of the uncompressed data, big-endian
+        std::uint32_t a = 1, b = 0;
+        for (char c : data)
+        {
+            a = (a + static_cast<unsigned char>(c)) % 65521;
+            b = (b + a) % 65521;
+        }
+        std::uint32_t adler = (b << 16) | a;
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out += static_cast<char>(adler >> shift);
+        }
+        return out;
+    }
+
+    void appendBigEndian(std::string &out, std::uint32_t value, int bytes = 4)
+    {
+        for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8)
+        {
+            out += static_cast<char>(value >> shift);
+        }
+    }
+
+    // Directory of the working tree while its tree objects are built
+    struct TreeNode
+    {
+        std::map<std::string, TreeNode> directories; // Subdirectories by name
+        std::map<std::string, std::string> files;    // Raw blob IDs by file name
+    };
+
+    // CRC-32 (IEEE) of a packed object, as listed in the pack index
+    std::uint32_t crc32(std::string_view data)
+    {
+        static const std::array<std::uint32_t, 256> table = []
+        {
+            std::array<std::uint32_t, 256> result{};
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+                std::uint32_t value = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+                }
+                result[i] = value;
+            }
+            return result;
+        }();
+
+        std::uint32_t crc = 0xFFFFFFFF;
+        for (char c : data)
+        {
+            crc = table[(crc ^ static_cast<unsigned char>(c)) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFF;
+    }
+
+    // Object of the initial commit before it is packed
+    struct PendingObject
+    {
+        int type;            // Pack type code: 1 commit, 2 tree, 3 blob
+        std::string content; // Content without the loose object header
+    };
+
+    // Collects the objects of a repository, keyed by raw ID so they come out in pack index order
+    class ObjectStore
+    {
+    public:
+        std::string add(std::string_view type, int packType, std::string_view content)
+        {
+            std::string id = objectId(type, content);
+            objects.emplace(id, PendingObject{packType, std::string(content)});
+            return id;
+        }
+
+        // Writes the tree objects bottom-up and returns the raw ID of the root tree
+        std::string addTree(const TreeNode &node)
+        {
+            // Git orders entries by name, comparing directories as if they ended in '/'
+            std::map<std::string, std::string> entries;
+            for (const auto &[name, child] : node.directories)
+            {
+                entries.emplace(name + "/", "40000 " + name + std::string(1, '\0') + addTree(child));
+            }
+            for (const auto &[name, id] : node.files)
+            {
+                entries.emplace(name, "100644 " + name + std::string(1, '\0') + id);
+            }
+
+            std::string content;
+            for (const auto &entry : entries)
+            {
+                content += entry.second;
+            }
+            return add("tree", 2, content);
+        }
+
+        // Builds a version 2 packfile and its index; returns the hex pack checksum that names both
+        std::string buildPack(std::string &pack, std::string &index) const
+        {
+            pack = "PACK";
+            appendBigEndian(pack, 2);
+            appendBigEndian(pack, static_cast<std::uint32_t>(objects.size()));
+
+            std::vector<std::uint32_t> checksums;
+            std::vector<std::uint32_t> offsets;
+            for (const auto &[id, object] : objects)
+            {
+                // Type and size header: 3 type bits and 4 size bits, then 7 size bits per byte
+                size_t start = pack.size();
+                size_t size = object.content.size();
+                unsigned char byte = static_cast<unsigned char>(object.type << 4 | (size & 0x0F));
+                size >>= 4;
+                while (size != 0)
+                {
+                    pack += static_cast<char>(byte | 0x80);
+                    byte = static_cast<unsigned char>(size & 0x7F);
+                    size >>= 7;
+                }
+                pack += static_cast<char>(byte);
+                pack += zlibStore(object.content);
+
+                offsets.push_back(static_cast<std::uint32_t>(start));
+                checksums.push_back(crc32(std::string_view(pack).substr(start)));
+            }
+            Sha1 packSha;
+            packSha.update(pack);
+            std::string packChecksum = packSha.finish();
+            pack += packChecksum;
+
+            // Index: fan-out table by first ID byte, sorted IDs, CRCs, offsets and both checksums
+            index = "\xFFtOc";
+            appendBigEndian(index, 2);
+            std::uint32_t count = 0;
+            auto next = objects.begin();
+            for (int first = 0; first < 256; ++first)
+            {
+                while (next != objects.end() && static_cast<unsigned char>(next->first[0]) == first)
+                {
+                    ++count;
+                    ++next;
+                }
+                appendBigEndian(index, count);
+            }
+            for (const auto &entry : objects)
+            {
+                index += entry.first;
+            }
+            for (std::uint32_t checksum : checksums)
+            {
+                appendBigEndian(index, checksum);
+            }
+            for (std::uint32_t offset : offsets)
+            {
+                appendBigEndian(index, offset);
+            }
+            index += packChecksum;
+            Sha1 indexSha;
+            indexSha.update(index);
+            index += indexSha.finish();
+            return toHex(packChecksum);
+        }
+
+    private:
+        std::map<std::string, PendingObject> objects; // Objects by raw ID
+    };
+
+    // Builds an index (version 2) listing the working tree as staged and unmodified
+    std::string buildIndex(const std::map<std::string, std::pair<std::string, size_t>> &entries)
+    {
+        std::string index = "DIRC";
+        appendBigEndian(index, 2);
+        appendBigEndian(index, static_cast<std::uint32_t>(entries.size()));
+        for (const auto &[path, blob] : entries)
+        {
+            // Stat fields stay zero, so git compares the content once and then refreshes them
+            size_t start = index.size();
+            index.append(24, '\0'); // ctime, mtime, dev, ino
+            appendBigEndian(index, 0100644);
+            index.append(8, '\0'); // uid, gid
+            appendBigEndian(index, static_cast<std::uint32_t>(blob.second));
+            index += blob.first;
+            appendBigEndian(index, static_cast<std::uint32_t>(std::min<size_t>(path.size(), 0xFFF)), 2);
+            index += path;
+
+            // NUL-terminate and pad each entry to a multiple of eight bytes
+            do
+            {
+                index += '\0';
+            } while ((index.size() - start) % 8 != 0);
+        }
+
+        Sha1 sha;
+        sha.update(index);
+        return index + sha.finish();
+    }
+}
+
+std::vector<TemplateFiles::TemplateFile> GitSkeleton::build(const std::vector<TemplateFiles::TemplateFile> &files)
+{
+    ObjectStore store;
+    TreeNode root;
+    std::map<std::string, std::pair<std::string, size_t>> indexEntries;
+    for (const auto &file : files)
+    {
+        std::string blob = store.add("blob", 3, file.content);
+        TreeNode *node = &root;
+        std::string path;
+        for (const auto &part : fs::path(file.subdirectory))
+        {
+            node = &node->directories[part.string()];
+            path += part.string() + "/";
+        }
+        node->files[file.filename] = blob;
+        indexEntries[path + file.filename] = {blob, file.content.size()};
+    }
+
+    std::string tree = store.addTree(root);
+    std::string signature = std::string(AUTHOR) + " " + std::to_string(COMMIT_TIME) + " +0000\n";
+    std::string commit = store.add("commit", 1,
+                                   "tree " + toHex(tree) + "\nauthor " + signature + "committer " + signature +
+                                       "\nInitial commit\n");
+
+    std::string pack;
+    std::string packIndex;
+    std::string packName = "pack-" + store.buildPack(pack, packIndex);
+
+    // Group the files by directory so each one is created right before its first file
+    return {
+        {"HEAD", std::string("ref: refs/heads/") + BRANCH_NAME + "\n", ".git"},
+        {"config",
+         "[core]\n\trepositoryformatversion = 0\n\tfilemode = true\n\tbare = false\n\tlogallrefupdates = true\n", ".git"},
+        {"index", buildIndex(indexEntries), ".git"},
+        {BRANCH_NAME, toHex(commit) + "\n", ".git/refs/heads"},
+        {packName + ".pack", pack, ".git/objects/pack"},
+        {packName + ".idx", packIndex, ".git/objects/pack"},
+    };
+}
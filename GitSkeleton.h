@@ -0,0 +1,45 @@
+#ifndef GIT_SKELETON_H
+#define GIT_SKELETON_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "TemplateFiles.h"
+
+/**
+ * @brief Builds a minimal git repository holding the template files as its first commit
+ *
+ * GitSkeleton produces the files of a `.git` directory without running git:
+ * HEAD, config, a branch ref, an index matching the working tree and a
+ * single packfile with its index holding the blobs, trees and the initial
+ * commit. One pack instead of a loose file per object keeps the cost per
+ * lesson at a handful of writes. Objects are SHA-1 hashed and zlib-wrapped
+ * with stored (uncompressed) deflate blocks, which every git version reads,
+ * so no compression library is needed. Since every lesson receives the same
+ * templates, the skeleton is built once and its bytes are written into each
+ * lesson like any other template file; with a fixed commit time, every
+ * lesson and every run share the same commit ID.
+ */
+class GitSkeleton
+{
+public:
+    // Branch created by the skeleton and checked out by HEAD
+    static constexpr const char *BRANCH_NAME = "main";
+
+    // Author and committer of the initial commit
+    static constexpr const char *AUTHOR = "directory_template_tool <directory_template_tool@localhost>";
+
+    // Author and commit time (2024-01-01 UTC); fixed so every run produces the same commit,
+    // which lets resumed runs and `clean` recognise the objects of earlier runs
+    static constexpr std::int64_t COMMIT_TIME = 1704067200;
+
+    /**
+     * @brief Builds the repository files for a working tree holding the given files
+     *
+     * @param files Template files making up the working tree
+     * @return std::vector<TemplateFiles::TemplateFile> Files below ".git", grouped by subdirectory
+     */
+    static std::vector<TemplateFiles::TemplateFile> build(const std::vector<TemplateFiles::TemplateFile> &files);
+};
+
+#endif // GIT_SKELETON_H
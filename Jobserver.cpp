@@ -0,0 +1,296 @@
+#include "Jobserver.h"
+#include <iostream>
+#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // How long a waiting worker sleeps before checking whether it still needs a token
+    constexpr int POLL_INTERVAL_MS = 50;
+
+    // Connection to the jobserver, set up once from MAKEFLAGS
+    struct Connection
+    {
+        std::atomic<bool> active{false}; // Cleared by disable() or when the jobserver fails
+        int readFd = -1;                 // Tokens are read from here
+        int writeFd = -1;                // Tokens are written back here
+        bool blockingRead = false;       // The read end is shared with make and cannot be made non-blocking
+        size_t jobLimit = 0;             // N from -jN, 0 if not given
+    };
+
+    std::atomic<bool> disabledByUser{false};
+
+    bool startsWith(const std::string &text, const std::string &prefix)
+    {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+#ifndef _WIN32
+    // Opens the pipe or fifo named by a --jobserver-auth value
+    bool connect(const std::string &auth, Connection &connection)
+    {
+        if (startsWith(auth, "fifo:"))
+        {
+            std::string fifoPath = auth.substr(5);
+            connection.readFd = ::open(fifoPath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            connection.writeFd = connection.readFd < 0 ? -1 : ::open(fifoPath.c_str(), O_WRONLY | O_CLOEXEC);
+            if (connection.writeFd < 0)
+            {
+                std::cerr << "Warning: Could not open the make jobserver fifo " << fifoPath << ": "
+                          << std::strerror(errno) << std::endl;
+                if (connection.readFd >= 0)
+                {
+                    ::close(connection.readFd);
+                }
+                return false;
+            }
+            return true;
+        }
+
+        // Descriptor form: "R,W", inherited from make only when the recipe is marked with '+'
+        int readFd = -1;
+        int writeFd = -1;
+        char comma = 0;
+        std::istringstream fds(auth);
+        if (!(fds >> readFd >> comma >> writeFd) || comma != ',' || readFd < 0 || writeFd < 0)
+        {
+            std::cerr << "Warning: Unrecognized make jobserver '" << auth << "'." << std::endl;
+            return false;
+        }
+        if (::fcntl(readFd, F_GETFD) < 0 || ::fcntl(writeFd, F_GETFD) < 0)
+        {
+            std::cerr << "Warning: The make jobserver is unavailable; add '+' to the parent make rule." << std::endl;
+            return false;
+        }
+
+#ifdef __linux__
+        // A fresh open of the pipe gets its own file status flags, so it can be non-blocking
+        // without changing the descriptor that make and its other children share
+        std::string procPath = "/proc/self/fd/" + std::to_string(readFd);
+        int ownReadFd = ::open(procPath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (ownReadFd >= 0)
+        {
+            connection.readFd = ownReadFd;
+            connection.writeFd = writeFd;
+            return true;
+        }
+#endif
+        connection.readFd = readFd;
+        connection.writeFd = writeFd;
+        connection.blockingRead = true;
+        return true;
+    }
+#endif
+
+    // Parses MAKEFLAGS on first use
+    Connection &connection()
+    {
+        static Connection state;
+        static std::once_flag once;
+        std::call_once(once, []
+                       {
+            const char *makeFlags = std::getenv("MAKEFLAGS");
+            if (makeFlags == nullptr)
+            {
+                return;
+            }
+
+            // The last --jobserver-auth wins, as in make itself
+            std::string auth;
+            std::istringstream words(makeFlags);
+            std::string word;
+            while (words >> word)
+            {
+                if (startsWith(word, "--jobserver-auth="))
+                {
+                    auth = word.substr(17);
+                }
+                else if (startsWith(word, "--jobserver-fds="))
+                {
+                    auth = word.substr(16);
+                }
+                else if (word.size() > 2 && startsWith(word, "-j") &&
+                         word.find_first_not_of("0123456789", 2) == std::string::npos)
+                {
+                    state.jobLimit = std::stoul(word.substr(2));
+                }
+            }
+            if (auth.empty())
+            {
+                return;
+            }
+#ifndef _WIN32
+            state.active = connect(auth, state);
+#else
+            std::cerr << "Warning: The make jobserver is not supported on Windows." << std::endl;
+#endif
+        });
+        return state;
+    }
+
+#ifndef _WIN32
+    // Stops using a jobserver that has started failing
+    void abandon(const char *operation)
+    {
+        if (connection().active.exchange(false))
+        {
+            std::cerr << "Warning: Could not " << operation << " a make jobserver token: " << std::strerror(errno)
+                      << "; continuing without the jobserver." << std::endl;
+        }
+    }
+
+    // Reads one token; waits while stillWanted() holds if it is given
+    bool readToken(char &token, const std::function<bool()> *stillWanted)
+    {
+        Connection &state = connection();
+        while (state.active)
+        {
+            if (!state.blockingRead)
+            {
+                ssize_t n = ::read(state.readFd, &token, 1);
+                if (n == 1)
+                {
+                    return true;
+                }
+                if (n == 0 || (errno != EAGAIN && errno != EINTR))
+                {
+                    abandon("read");
+                    return false;
+                }
+            }
+
+            pollfd readable{state.readFd, POLLIN, 0};
+            int ready = ::poll(&readable, 1, stillWanted ? POLL_INTERVAL_MS : 0);
+            if (ready > 0 && state.blockingRead)
+            {
+                // Another client may take the token first, in which case this read waits for the next one
+                ssize_t n = ::read(state.readFd, &token, 1);
+                if (n == 1)
+                {
+                    return true;
+                }
+                if (n == 0 || errno != EINTR)
+                {
+                    abandon("read");
+                    return false;
+                }
+            }
+            if (stillWanted == nullptr || !(*stillWanted)())
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+#endif
+}
+
+Jobserver::Reservation::Reservation(size_t wanted, size_t required) : granted(0)
+{
+    if (!isActive())
+    {
+        granted = wanted;
+        return;
+    }
+
+    char token;
+    std::function<bool()> always = []
+    { return true; };
+    while (tokens.size() < wanted)
+    {
+        bool taken = tokens.size() < required ? acquire(token, always) : tryAcquire(token);
+        if (!taken)
+        {
+            break;
+        }
+        tokens.push_back(token);
+    }
+    granted = tokens.size();
+
+    // If the jobserver failed while waiting, carry on as if there were none
+    if (!isActive() && granted < required)
+    {
+        granted = required;
+    }
+}
+
+Jobserver::Reservation::~Reservation()
+{
+    for (char token : tokens)
+    {
+        release(token);
+    }
+}
+
+size_t Jobserver::Reservation::size() const
+{
+    return granted;
+}
+
+bool Jobserver::isActive()
+{
+    return !disabledByUser && connection().active;
+}
+
+size_t Jobserver::getJobLimit()
+{
+    return isActive() ? connection().jobLimit : 0;
+}
+
+void Jobserver::disable()
+{
+    disabledByUser = true;
+}
+
+bool Jobserver::acquire(char &token, const std::function<bool()> &stillWanted)
+{
+#ifndef _WIN32
+    return isActive() && readToken(token, &stillWanted);
+#else
+    (void)token;
+    (void)stillWanted;
+    return false;
+#endif
+}
+
+bool Jobserver::tryAcquire(char &token)
+{
+#ifndef _WIN32
+    return isActive() && readToken(token, nullptr);
+#else
+    (void)token;
+    return false;
+#endif
+}
+
+void Jobserver::release(char token)
+{
+#ifndef _WIN32
+    Connection &state = connection();
+    if (state.writeFd < 0)
+    {
+        return;
+    }
+    // Tokens go back even after a read failure; make counts them
+    while (::write(state.writeFd, &token, 1) < 0)
+    {
+        if (errno != EINTR)
+        {
+            abandon("return");
+            return;
+        }
+    }
+#else
+    (void)token;
+#endif
+}
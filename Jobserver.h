@@ -0,0 +1,105 @@
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <functional>
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief Client for the GNU make jobserver
+ *
+ * When the tool runs inside a `make -jN` recipe, make advertises its job
+ * slots through MAKEFLAGS, either as a named pipe (--jobserver-auth=fifo:PATH)
+ * or as a pair of inherited descriptors (--jobserver-auth=R,W or the older
+ * --jobserver-fds=R,W). Every process owns one implicit slot; each further
+ * concurrent job must read a token byte from the jobserver first and write
+ * the same byte back when it is done. The jobserver is detected once, on
+ * first use; without one, isActive() is false and callers use their own
+ * worker counts. Windows semaphores are not supported.
+ */
+class Jobserver
+{
+public:
+    /**
+     * @brief Job tokens held for the lifetime of the object
+     *
+     * Used by groups of long-running workers that depend on each other and
+     * therefore must all run at once. Without a jobserver, every requested
+     * token is granted.
+     */
+    class Reservation
+    {
+    public:
+        /**
+         * @brief Constructor takes tokens from the jobserver
+         *
+         * @param wanted Number of tokens to take if they are free
+         * @param required Number of tokens to wait for (at most wanted)
+         */
+        Reservation(size_t wanted, size_t required);
+
+        /**
+         * @brief Destructor returns the tokens
+         */
+        ~Reservation();
+
+        Reservation(const Reservation &) = delete;
+        Reservation &operator=(const Reservation &) = delete;
+
+        /**
+         * @brief Gets the number of tokens granted
+         *
+         * @return size_t Granted tokens, not counting the implicit slot
+         */
+        size_t size() const;
+
+    private:
+        std::string tokens; // Token bytes to write back
+        size_t granted;     // Tokens granted, including ones not backed by a jobserver
+    };
+
+    /**
+     * @brief Checks whether a usable jobserver was found in MAKEFLAGS
+     *
+     * @return bool True if tokens must be taken for extra concurrent work
+     */
+    static bool isActive();
+
+    /**
+     * @brief Gets the job limit of the parent make
+     *
+     * @return size_t N from -jN in MAKEFLAGS, or 0 if unknown
+     */
+    static size_t getJobLimit();
+
+    /**
+     * @brief Stops the tool from using the jobserver even if one is advertised
+     */
+    static void disable();
+
+    /**
+     * @brief Waits for a job token
+     *
+     * @param token Receives the token byte, which must be passed to release()
+     * @param stillWanted Polled while waiting; returning false gives up
+     * @return bool True if a token was taken
+     */
+    static bool acquire(char &token, const std::function<bool()> &stillWanted);
+
+    /**
+     * @brief Takes a job token only if one is free right now
+     *
+     * @param token Receives the token byte, which must be passed to release()
+     * @return bool True if a token was taken
+     */
+    static bool tryAcquire(char &token);
+
+    /**
+     * @brief Returns a job token to the jobserver
+     *
+     * @param token Byte obtained from acquire() or tryAcquire()
+     */
+    static void release(char token);
+};
+
+#endif // JOBSERVER_H
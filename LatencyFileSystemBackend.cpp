@@ -0,0 +1,91 @@
+#include "LatencyFileSystemBackend.h"
+#include <thread>
+
+namespace fs = std::filesystem;
+
+LatencyFileSystemBackend::LatencyFileSystemBackend(std::unique_ptr<FileSystemBackend> inner,
+                                                   std::chrono::microseconds roundTrip)
+    : inner(std::move(inner)), roundTrip(roundTrip)
+{
+}
+
+void LatencyFileSystemBackend::roundTripDelay()
+{
+    roundTrips.fetch_add(1, std::memory_order_relaxed);
+    if (roundTrip.count() > 0)
+    {
+        std::this_thread::sleep_for(roundTrip);
+    }
+}
+
+bool LatencyFileSystemBackend::createDirectory(const fs::path &dirPath)
+{
+    roundTripDelay();
+    return inner->createDirectory(dirPath);
+}
+
+void LatencyFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content)
+{
+    // Open and write are separate round trips on NFS
+    roundTripDelay();
+    roundTripDelay();
+    inner->writeFile(filePath, content);
+}
+
+bool LatencyFileSystemBackend::createDirectory(const fs::path &dirPath, std::error_code &ec)
+{
+    roundTripDelay();
+    return inner->createDirectory(dirPath, ec);
+}
+
+void LatencyFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec)
+{
+    roundTripDelay();
+    roundTripDelay();
+    inner->writeFile(filePath, content, ec);
+}
+
+void LatencyFileSystemBackend::renameEntry(const fs::path &from, const fs::path &to)
+{
+    roundTripDelay();
+    inner->renameEntry(from, to);
+}
+
+std::vector<FileSystemBackend::DirectoryEntry> LatencyFileSystemBackend::listDirectory(const fs::path &dirPath)
+{
+    roundTripDelay();
+    return inner->listDirectory(dirPath);
+}
+
+void LatencyFileSystemBackend::forEachEntry(const fs::path &dirPath,
+                                            const std::function<void(const DirectoryEntry &)> &visitor)
+{
+    roundTripDelay();
+    inner->forEachEntry(dirPath, visitor);
+}
+
+FileSystemBackend::FileStatus LatencyFileSystemBackend::status(const fs::path &path)
+{
+    roundTripDelay();
+    return inner->status(path);
+}
+
+bool LatencyFileSystemBackend::isOnDisk() const
+{
+    return inner->isOnDisk();
+}
+
+std::string LatencyFileSystemBackend::getName() const
+{
+    return inner->getName() + "+latency(" + std::to_string(roundTrip.count()) + "us)";
+}
+
+std::uint64_t LatencyFileSystemBackend::getRoundTripCount() const
+{
+    return roundTrips.load(std::memory_order_relaxed);
+}
+
+FileSystemBackend &LatencyFileSystemBackend::getInner()
+{
+    return *inner;
+}
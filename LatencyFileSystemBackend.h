@@ -0,0 +1,61 @@
+#ifndef LATENCY_FILE_SYSTEM_BACKEND_H
+#define LATENCY_FILE_SYSTEM_BACKEND_H
+
+#include "FileSystemBackend.h"
+#include <chrono>
+#include <atomic>
+
+/**
+ * @brief Backend wrapper that injects a fixed round-trip delay into every operation
+ *
+ * LatencyFileSystemBackend simulates a network filesystem such as NFS on top of
+ * another backend. Each call sleeps for one round trip before being forwarded,
+ * so concurrent callers overlap their waits exactly as they would against a
+ * remote server.
+ */
+class LatencyFileSystemBackend : public FileSystemBackend
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param inner Backend that performs the actual operations
+     * @param roundTrip Delay added to every operation
+     */
+    LatencyFileSystemBackend(std::unique_ptr<FileSystemBackend> inner, std::chrono::microseconds roundTrip);
+
+    bool createDirectory(const fs::path &dirPath) override;
+    void writeFile(const fs::path &filePath, std::string_view content) override;
+    bool createDirectory(const fs::path &dirPath, std::error_code &ec) override;
+    void writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec) override;
+    void renameEntry(const fs::path &from, const fs::path &to) override;
+    std::vector<DirectoryEntry> listDirectory(const fs::path &dirPath) override;
+    void forEachEntry(const fs::path &dirPath, const std::function<void(const DirectoryEntry &)> &visitor) override;
+    FileStatus status(const fs::path &path) override;
+    bool isOnDisk() const override;
+    std::string getName() const override;
+
+    /**
+     * @brief Gets the number of simulated round trips so far
+     *
+     * @return std::uint64_t Round trip count
+     */
+    std::uint64_t getRoundTripCount() const;
+
+    /**
+     * @brief Gets the wrapped backend
+     *
+     * @return FileSystemBackend& The inner backend
+     */
+    FileSystemBackend &getInner();
+
+private:
+    // Sleeps for one round trip and counts it
+    void roundTripDelay();
+
+    std::unique_ptr<FileSystemBackend> inner;  // Backend doing the real work
+    std::chrono::microseconds roundTrip;       // Delay per operation
+    std::atomic<std::uint64_t> roundTrips{0};  // Number of delays injected
+};
+
+#endif // LATENCY_FILE_SYSTEM_BACKEND_H
@@ -0,0 +1,108 @@
+#include "MarkdownOutlineReader.h"
+#include <iostream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+bool MarkdownOutlineReader::open(const std::string &markdownPath)
+{
+    stemName.clear();
+
+    // Check if file exists
+    if (!fs::exists(markdownPath))
+    {
+        std::cerr << "Error: File does not exist: " << markdownPath << std::endl;
+        return false;
+    }
+
+    // Read markdown file
+    markdownFile.open(markdownPath);
+    if (!markdownFile)
+    {
+        std::cerr << "Error: Could not open file: " << markdownPath << std::endl;
+        return false;
+    }
+
+    // First non-empty line is considered the stem directory name
+    while (std::getline(markdownFile, line))
+    {
+        if (parseStemLine(line, stemName))
+            break;
+    }
+
+    return true;
+}
+
+const std::string &MarkdownOutlineReader::getStemName() const
+{
+    return stemName;
+}
+
+bool MarkdownOutlineReader::next(std::string &dirName)
+{
+    while (std::getline(markdownFile, line))
+    {
+        if (parseEntryLine(line, dirName))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MarkdownOutlineReader::parseEntryLine(std::string_view line, std::string &dirName)
+{
+    line = trim(line);
+
+    // Check if line represents a subdirectory (starts with |- or - or * or similar markdown list indicators)
+    if (line.substr(0, 2) != "|-" && line.substr(0, 2) != "- " && line.substr(0, 2) != "* ")
+    {
+        return false;
+    }
+
+    // Extract directory name by removing the marker and trimming
+    size_t nameStart = line.find_first_not_of("|- *");
+    if (nameStart == std::string_view::npos)
+    {
+        return false;
+    }
+    line.remove_prefix(nameStart);
+
+    size_t first = line.find_first_not_of(" \t");
+    if (first != std::string_view::npos)
+    {
+        line.remove_prefix(first);
+    }
+
+    if (line.empty())
+    {
+        return false;
+    }
+    dirName.assign(line);
+    return true;
+}
+
+bool MarkdownOutlineReader::parseStemLine(std::string_view line, std::string &stemName)
+{
+    std::string_view trimmed = trim(line);
+    if (trimmed.empty())
+        return false;
+
+    // Remove any markdown heading syntax (# ) if present
+    if (trimmed.substr(0, 2) == "# ")
+        trimmed.remove_prefix(2);
+
+    stemName.assign(trimmed);
+    return true;
+}
+
+std::string_view MarkdownOutlineReader::trim(std::string_view text)
+{
+    size_t first = text.find_first_not_of(" \t\n\r\f\v");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    size_t last = text.find_last_not_of(" \t\n\r\f\v");
+    return text.substr(first, last - first + 1);
+}
@@ -0,0 +1,80 @@
+#ifndef MARKDOWN_OUTLINE_READER_H
+#define MARKDOWN_OUTLINE_READER_H
+
+#include <string>
+#include <string_view>
+#include <fstream>
+
+/**
+ * @brief Reads a markdown outline one entry at a time
+ *
+ * MarkdownOutlineReader streams the outline instead of loading it into a
+ * vector, so consumers can start working on the first subdirectory while
+ * the rest of the file is still being read. The first non-empty line is the
+ * stem directory name; every line starting with "|-", "- " or "* " is a
+ * subdirectory.
+ */
+class MarkdownOutlineReader
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    MarkdownOutlineReader() = default;
+
+    /**
+     * @brief Opens an outline and reads its stem directory name
+     *
+     * @param markdownPath Path to the markdown file
+     * @return bool True if the file could be opened
+     */
+    bool open(const std::string &markdownPath);
+
+    /**
+     * @brief Gets the stem directory name read by open()
+     *
+     * @return const std::string& Stem name (empty if the file has no content)
+     */
+    const std::string &getStemName() const;
+
+    /**
+     * @brief Reads the next subdirectory name
+     *
+     * @param dirName Receives the subdirectory name
+     * @return bool False at the end of the file
+     */
+    bool next(std::string &dirName);
+
+    /**
+     * @brief Extracts a subdirectory name from one line of an outline
+     *
+     * @param line Raw line (whitespace is trimmed here)
+     * @param dirName Receives the subdirectory name
+     * @return bool True if the line is a list entry with a name
+     */
+    static bool parseEntryLine(std::string_view line, std::string &dirName);
+
+    /**
+     * @brief Extracts the stem directory name from a line
+     *
+     * @param line Raw line (whitespace and a "# " heading marker are removed)
+     * @param stemName Receives the stem name
+     * @return bool True if the line is not blank
+     */
+    static bool parseStemLine(std::string_view line, std::string &stemName);
+
+    /**
+     * @brief Removes leading and trailing whitespace
+     *
+     * @param text Text to trim
+     * @return std::string_view Trimmed view into text
+     */
+    static std::string_view trim(std::string_view text);
+
+private:
+    std::ifstream markdownFile; // Outline being read
+    std::string stemName;       // First non-empty line without heading marker
+    std::string line;           // Reused line buffer
+};
+
+#endif // MARKDOWN_OUTLINE_READER_H
@@ -0,0 +1,249 @@
+#include "MemoryFileSystemBackend.h"
+#include <mutex>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+std::string MemoryFileSystemBackend::makeKey(const fs::path &path)
+{
+    std::string key = path.lexically_normal().generic_string();
+
+    // Drop a trailing separator so "a/b/" and "a/b" map to the same node
+    while (key.size() > 1 && key.back() == '/')
+    {
+        key.pop_back();
+    }
+    if (key == ".")
+    {
+        key.clear();
+    }
+    return key;
+}
+
+std::string MemoryFileSystemBackend::parentKey(const std::string &key)
+{
+    return fs::path(key).parent_path().generic_string();
+}
+
+bool MemoryFileSystemBackend::isRoot(const std::string &key)
+{
+    return key.empty() || parentKey(key) == key;
+}
+
+std::string MemoryFileSystemBackend::leafName(const std::string &key)
+{
+    return fs::path(key).filename().generic_string();
+}
+
+bool MemoryFileSystemBackend::createDirectoryLocked(const std::string &key, std::error_code &ec)
+{
+    auto it = nodes.find(key);
+    if (it != nodes.end())
+    {
+        if (!it->second.isDirectory)
+        {
+            ec = std::make_error_code(std::errc::file_exists);
+        }
+        return false;
+    }
+
+    // Roots ("" for relative paths, "/" for absolute ones) exist implicitly
+    if (!isRoot(key))
+    {
+        std::string parent = parentKey(key);
+        createDirectoryLocked(parent, ec);
+        if (ec)
+        {
+            return false;
+        }
+        nodes[parent].children.insert(leafName(key));
+    }
+
+    nodes[key].isDirectory = true;
+    return true;
+}
+
+bool MemoryFileSystemBackend::createDirectory(const fs::path &dirPath)
+{
+    std::error_code ec;
+    bool created = createDirectory(dirPath, ec);
+    if (ec)
+    {
+        throw fs::filesystem_error("Path exists and is not a directory", dirPath, ec);
+    }
+    return created;
+}
+
+bool MemoryFileSystemBackend::createDirectory(const fs::path &dirPath, std::error_code &ec)
+{
+    ec.clear();
+    std::string key = makeKey(dirPath);
+    std::unique_lock lock(mutex);
+    return createDirectoryLocked(key, ec);
+}
+
+void MemoryFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content)
+{
+    std::error_code ec;
+    writeFile(filePath, content, ec);
+    if (ec)
+    {
+        throw fs::filesystem_error("Could not create file", filePath, ec);
+    }
+}
+
+void MemoryFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec)
+{
+    ec.clear();
+    std::string key = makeKey(filePath);
+    std::string parent = parentKey(key);
+
+    std::unique_lock lock(mutex);
+
+    // Like open(O_CREAT), the parent directory has to exist already
+    if (isRoot(parent))
+    {
+        createDirectoryLocked(parent, ec);
+    }
+    auto parentIt = nodes.find(parent);
+    if (parentIt == nodes.end() || !parentIt->second.isDirectory)
+    {
+        ec = std::make_error_code(std::errc::no_such_file_or_directory);
+        return;
+    }
+
+    auto it = nodes.find(key);
+    if (it != nodes.end())
+    {
+        if (it->second.isDirectory)
+        {
+            ec = std::make_error_code(std::errc::is_a_directory);
+            return;
+        }
+        totalBytes -= it->second.content.size();
+        it->second.content.assign(content);
+    }
+    else
+    {
+        Node &node = nodes[key];
+        node.content.assign(content);
+        nodes[parent].children.insert(leafName(key));
+        fileCount++;
+    }
+    totalBytes += content.size();
+}
+
+void MemoryFileSystemBackend::renameEntry(const fs::path &from, const fs::path &to)
+{
+    std::string fromKey = makeKey(from);
+    std::string toKey = makeKey(to);
+    std::string toParent = parentKey(toKey);
+
+    std::unique_lock lock(mutex);
+
+    if (nodes.find(fromKey) == nodes.end() || isRoot(fromKey))
+    {
+        throw fs::filesystem_error("Could not rename", from, to,
+                                   std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+    if (nodes.find(toKey) != nodes.end())
+    {
+        throw fs::filesystem_error("Rename target exists", from, to, std::make_error_code(std::errc::file_exists));
+    }
+    auto parentIt = nodes.find(toParent);
+    if (!isRoot(toParent) && (parentIt == nodes.end() || !parentIt->second.isDirectory))
+    {
+        throw fs::filesystem_error("Could not rename", from, to,
+                                   std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+    if (toKey.compare(0, fromKey.size() + 1, fromKey + "/") == 0)
+    {
+        throw fs::filesystem_error("Could not rename", from, to, std::make_error_code(std::errc::invalid_argument));
+    }
+
+    // Re-key the node and every descendant
+    std::string prefix = fromKey + "/";
+    std::vector<std::string> moved;
+    for (const auto &[key, node] : nodes)
+    {
+        if (key == fromKey || key.compare(0, prefix.size(), prefix) == 0)
+        {
+            moved.push_back(key);
+        }
+    }
+    for (const auto &key : moved)
+    {
+        auto handle = nodes.extract(key);
+        handle.key() = toKey + key.substr(fromKey.size());
+        nodes.insert(std::move(handle));
+    }
+
+    nodes[parentKey(fromKey)].children.erase(leafName(fromKey));
+    if (isRoot(toParent))
+    {
+        nodes[toParent].isDirectory = true;
+    }
+    nodes[toParent].children.insert(leafName(toKey));
+}
+
+std::vector<FileSystemBackend::DirectoryEntry> MemoryFileSystemBackend::listDirectory(const fs::path &dirPath)
+{
+    std::string key = makeKey(dirPath);
+    std::shared_lock lock(mutex);
+
+    auto it = nodes.find(key);
+    if (it == nodes.end() || !it->second.isDirectory)
+    {
+        throw fs::filesystem_error("Could not open directory", dirPath,
+                                   std::make_error_code(it == nodes.end() ? std::errc::no_such_file_or_directory
+                                                                          : std::errc::not_a_directory));
+    }
+
+    std::vector<DirectoryEntry> entries;
+    entries.reserve(it->second.children.size());
+    for (const auto &name : it->second.children)
+    {
+        std::string childKey = key.empty() ? name : (key.back() == '/' ? key + name : key + "/" + name);
+        entries.push_back({name, nodes.at(childKey).isDirectory});
+    }
+    return entries;
+}
+
+FileSystemBackend::FileStatus MemoryFileSystemBackend::status(const fs::path &path)
+{
+    std::string key = makeKey(path);
+    std::shared_lock lock(mutex);
+
+    FileStatus result;
+    auto it = nodes.find(key);
+    if (it != nodes.end())
+    {
+        result.exists = true;
+        result.isDirectory = it->second.isDirectory;
+        result.size = it->second.content.size();
+    }
+    return result;
+}
+
+std::string MemoryFileSystemBackend::getName() const
+{
+    return "memory";
+}
+
+size_t MemoryFileSystemBackend::getDirectoryCount() const
+{
+    std::shared_lock lock(mutex);
+    return nodes.size() - fileCount;
+}
+
+size_t MemoryFileSystemBackend::getFileCount() const
+{
+    std::shared_lock lock(mutex);
+    return fileCount;
+}
+
+std::uintmax_t MemoryFileSystemBackend::getTotalBytes() const
+{
+    std::shared_lock lock(mutex);
+    return totalBytes;
+}
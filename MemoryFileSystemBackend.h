@@ -0,0 +1,86 @@
+#ifndef MEMORY_FILE_SYSTEM_BACKEND_H
+#define MEMORY_FILE_SYSTEM_BACKEND_H
+
+#include "FileSystemBackend.h"
+#include <unordered_map>
+#include <set>
+#include <shared_mutex>
+
+/**
+ * @brief Thread-safe filesystem backend that keeps everything in memory
+ *
+ * MemoryFileSystemBackend lets the engine run at memory speed so that its
+ * CPU cost can be measured separately from kernel and disk cost. Paths are
+ * normalized lexically; relative and absolute paths live in the same tree.
+ */
+class MemoryFileSystemBackend : public FileSystemBackend
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    MemoryFileSystemBackend() = default;
+
+    bool createDirectory(const fs::path &dirPath) override;
+    void writeFile(const fs::path &filePath, std::string_view content) override;
+    bool createDirectory(const fs::path &dirPath, std::error_code &ec) override;
+    void writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec) override;
+    void renameEntry(const fs::path &from, const fs::path &to) override;
+    std::vector<DirectoryEntry> listDirectory(const fs::path &dirPath) override;
+    FileStatus status(const fs::path &path) override;
+    std::string getName() const override;
+
+    /**
+     * @brief Gets the number of directories stored
+     *
+     * @return size_t Directory count
+     */
+    size_t getDirectoryCount() const;
+
+    /**
+     * @brief Gets the number of files stored
+     *
+     * @return size_t File count
+     */
+    size_t getFileCount() const;
+
+    /**
+     * @brief Gets the total number of file bytes stored
+     *
+     * @return std::uintmax_t Byte count
+     */
+    std::uintmax_t getTotalBytes() const;
+
+private:
+    /**
+     * @brief Structure representing a node of the in-memory tree
+     */
+    struct Node
+    {
+        bool isDirectory = false;
+        std::string content;             // File content (files only)
+        std::set<std::string> children;  // Child names (directories only)
+    };
+
+    // Converts a path into the key used by the node map
+    static std::string makeKey(const fs::path &path);
+
+    // Returns the key of the parent (a root is its own parent)
+    static std::string parentKey(const std::string &key);
+
+    // Checks whether a key is a root ("" for relative paths, "/" for absolute ones)
+    static bool isRoot(const std::string &key);
+
+    // Returns the last component of a key
+    static std::string leafName(const std::string &key);
+
+    // Creates a directory node and its parents; caller must hold the write lock
+    bool createDirectoryLocked(const std::string &key, std::error_code &ec);
+
+    mutable std::shared_mutex mutex;              // Guards all members below
+    std::unordered_map<std::string, Node> nodes;  // All nodes keyed by normalized path
+    size_t fileCount = 0;                         // Number of file nodes
+    std::uintmax_t totalBytes = 0;                // Sum of file sizes
+};
+
+#endif // MEMORY_FILE_SYSTEM_BACKEND_H
@@ -0,0 +1,187 @@
+#include "NinjaBuildFile.h"
+#include "FileSystemBackend.h"
+#include "TemplateFiles.h"
+#include "ErrorLog.h"
+#include <atomic>
+#include <sstream>
+#include <algorithm>
+
+namespace
+{
+    // The shared precompiled header is off unless requested
+    std::atomic<bool> precompiledHeader{false};
+
+    // Rules shared by every lesson; flags follow the GCC task of the embedded tasks.json
+    constexpr const char *BUILD_FILE_HEADER = R"(# Generated by directory_template_tool; rerun create or sync after editing the outline.
+ninja_required_version = 1.3
+
+cxx = g++
+cxxflags = -g -std=c++20
+ldflags =
+
+rule cxx
+  command = $cxx -MMD -MF $out.d $cxxflags $pchflags -c $in -o $out
+  depfile = $out.d
+  deps = gcc
+  description = CXX $out
+
+rule pch
+  command = $cxx -MMD -MF $out.d $cxxflags -x c++-header $in -o $out
+  depfile = $out.d
+  deps = gcc
+  description = PCH $out
+
+rule link
+  command = $cxx $in -o $out $ldflags
+  description = LINK $out
+
+)";
+
+    // Names of the template sources compiled in each lesson, in build order
+    std::vector<std::string> getLessonSources()
+    {
+        std::vector<std::string> sources;
+        for (const auto &file : TemplateFiles::getAllTemplateFiles())
+        {
+            if (file.subdirectory.empty() && fs::path(file.filename).extension() == ".cpp")
+            {
+                sources.push_back(file.filename);
+            }
+        }
+        return sources;
+    }
+
+    // Standard headers included by the template sources, which every lesson would otherwise parse again
+    std::string getPrecompiledHeaderContent()
+    {
+        std::vector<std::string> includes;
+        for (const auto &file : TemplateFiles::getAllTemplateFiles())
+        {
+            if (!file.subdirectory.empty() || fs::path(file.filename).extension() != ".cpp")
+            {
+                continue;
+            }
+            std::istringstream lines(file.content);
+            std::string line;
+            while (std::getline(lines, line))
+            {
+                if (line.rfind("#include <", 0) == 0 &&
+                    std::find(includes.begin(), includes.end(), line) == includes.end())
+                {
+                    includes.push_back(line);
+                }
+            }
+        }
+
+        std::string content = "// Generated by directory_template_tool; precompiled once for every lesson.\n";
+        for (const auto &include : includes)
+        {
+            content += include + "\n";
+        }
+        return content;
+    }
+}
+
+void NinjaBuildFile::setPrecompiledHeader(bool enabled)
+{
+    precompiledHeader = enabled;
+}
+
+bool NinjaBuildFile::isPrecompiledHeaderEnabled()
+{
+    return precompiledHeader;
+}
+
+NinjaBuildFile::NinjaBuildFile(const fs::path &stemDir) : stemDir(stemDir), lessonCount(0)
+{
+}
+
+bool NinjaBuildFile::write(const std::vector<std::string> &lessons)
+{
+    const std::vector<std::string> sources = getLessonSources();
+    const std::string buildDir = BUILD_DIR_NAME;
+
+    std::string content = BUILD_FILE_HEADER;
+    content += "builddir = " + buildDir + "\n";
+
+    // GCC picks up pch.h.gch in place of the header it sits next to, as long as the flags match
+    std::string pchDependency;
+    if (precompiledHeader)
+    {
+        std::string header = buildDir + "/" + PRECOMPILED_HEADER_NAME;
+        if (!writePrecompiledHeader())
+        {
+            return false;
+        }
+        content += "pchflags = -include " + header + " -Winvalid-pch\n\n";
+        content += "build " + header + ".gch: pch " + header + "\n\n";
+        pchDependency = " | " + header + ".gch";
+    }
+    else
+    {
+        content += "pchflags =\n\n";
+    }
+
+    // One object per template source and one executable per lesson
+    std::string objects;
+    for (const auto &lesson : lessons)
+    {
+        std::string source = escapePath(lesson) + "/";
+        std::string output = buildDir + "/" + escapePath(lesson) + "/";
+        objects.clear();
+        for (const auto &file : sources)
+        {
+            std::string object = output + escapePath(fs::path(file).replace_extension(".o").string());
+            content += "build " + object + ": cxx " + source + escapePath(file) + pchDependency + "\n";
+            objects += " " + object;
+        }
+        content += "build " + output + EXECUTABLE_NAME + ": link" + objects + "\n\n";
+    }
+
+    std::error_code ec;
+    FileSystemBackend::getActive().writeFile(stemDir / BUILD_FILE_NAME, content, ec);
+    if (ec)
+    {
+        ErrorLog::record("write file", ec, stemDir, BUILD_FILE_NAME);
+        return false;
+    }
+    lessonCount = lessons.size();
+    return true;
+}
+
+bool NinjaBuildFile::writePrecompiledHeader()
+{
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    std::error_code ec;
+    backend.createDirectory(stemDir / BUILD_DIR_NAME, ec);
+    if (!ec)
+    {
+        backend.writeFile(stemDir / BUILD_DIR_NAME / PRECOMPILED_HEADER_NAME, getPrecompiledHeaderContent(), ec);
+    }
+    if (ec)
+    {
+        ErrorLog::record("write file", ec, stemDir / BUILD_DIR_NAME, PRECOMPILED_HEADER_NAME);
+        return false;
+    }
+    return true;
+}
+
+size_t NinjaBuildFile::getLessonCount() const
+{
+    return lessonCount;
+}
+
+std::string NinjaBuildFile::escapePath(const std::string &path)
+{
+    std::string escaped;
+    escaped.reserve(path.size());
+    for (char c : path)
+    {
+        if (c == '$' || c == ' ' || c == ':')
+        {
+            escaped += '$';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
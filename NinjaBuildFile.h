@@ -0,0 +1,94 @@
+#ifndef NINJA_BUILD_FILE_H
+#define NINJA_BUILD_FILE_H
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Writes a build.ninja at the stem that compiles every lesson
+ *
+ * The embedded tasks.json builds one lesson at a time with Windows paths.
+ * NinjaBuildFile instead writes a single Ninja file at the stem with one
+ * object per template source and one executable per lesson, built with g++
+ * from the PATH, so `ninja -j$(nproc)` in the stem compiles all lessons in
+ * parallel and rebuilds only what changed (header dependencies are tracked
+ * through depfiles). Objects and executables go to a hidden build directory
+ * in the stem, mirroring the lesson paths, so the lessons themselves stay
+ * untouched and pass verification.
+ *
+ * With the precompiled header enabled, the standard headers the templates
+ * include are collected into one pch.h in the build directory. It is compiled
+ * once into pch.h.gch and force-included into every lesson, so the standard
+ * library is parsed once per stem instead of once per lesson.
+ */
+class NinjaBuildFile
+{
+public:
+    // Name of the build file inside the stem directory
+    static constexpr const char *BUILD_FILE_NAME = "build.ninja";
+
+    // Directory inside the stem receiving objects and executables
+    static constexpr const char *BUILD_DIR_NAME = ".build";
+
+    // Name of each lesson's executable inside its build directory
+    static constexpr const char *EXECUTABLE_NAME = "rooster";
+
+    // Shared header inside the build directory, precompiled once for all lessons
+    static constexpr const char *PRECOMPILED_HEADER_NAME = "pch.h";
+
+    /**
+     * @brief Makes written build files compile the lessons against one shared precompiled header
+     *
+     * @param enabled True to generate pch.h from the templates' standard includes and force-include it
+     */
+    static void setPrecompiledHeader(bool enabled);
+
+    /**
+     * @brief Checks whether build files use the shared precompiled header
+     *
+     * @return bool True after setPrecompiledHeader(true)
+     */
+    static bool isPrecompiledHeaderEnabled();
+
+    /**
+     * @brief Constructor
+     *
+     * @param stemDir Stem directory the build file belongs to
+     */
+    explicit NinjaBuildFile(const fs::path &stemDir);
+
+    /**
+     * @brief Writes the build file for the given lessons
+     *
+     * @param lessons Lesson paths relative to the stem, e.g. "01 - Intro" or "000000-000999/01 - Intro"
+     * @return bool True if the file was written
+     */
+    bool write(const std::vector<std::string> &lessons);
+
+    /**
+     * @brief Gets the number of lessons in the last written build file
+     *
+     * @return size_t Lesson count
+     */
+    size_t getLessonCount() const;
+
+    /**
+     * @brief Escapes a path for use in a Ninja build statement
+     *
+     * @param path Path as it appears on disk
+     * @return std::string Path with '$', ' ' and ':' escaped
+     */
+    static std::string escapePath(const std::string &path);
+
+private:
+    // Writes the shared header into the build directory
+    bool writePrecompiledHeader();
+
+    fs::path stemDir;   // Stem directory
+    size_t lessonCount; // Lessons in the last written file
+};
+
+#endif // NINJA_BUILD_FILE_H
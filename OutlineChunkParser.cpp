@@ -0,0 +1,201 @@
+#include "OutlineChunkParser.h"
+#include "MarkdownOutlineReader.h"
+#include "ThreadPool.h"
+#include "AllocationStats.h"
+#include <iostream>
+#include <filesystem>
+#include <string_view>
+#include <algorithm>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Below this size a sequential read is faster than starting threads
+    constexpr size_t PARALLEL_MIN_BYTES = 8 * 1024 * 1024;
+
+    // Chunks are at least this large so per-chunk overhead stays negligible
+    constexpr size_t MIN_CHUNK_BYTES = 1024 * 1024;
+
+    // Several chunks per thread even out lines of uneven length
+    constexpr size_t CHUNKS_PER_THREAD = 4;
+
+    // Read-only view of a whole file; mapped where possible so multi-GB outlines are not copied
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile()
+        {
+#ifndef _WIN32
+            if (address != nullptr)
+            {
+                ::munmap(address, length);
+            }
+#endif
+        }
+
+        bool open(const std::string &path, size_t size)
+        {
+#ifndef _WIN32
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return false;
+            }
+            void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapped == MAP_FAILED)
+            {
+                return false;
+            }
+            ::madvise(mapped, size, MADV_SEQUENTIAL);
+            address = mapped;
+            length = size;
+            return true;
+#else
+            std::ifstream file(path, std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return static_cast<bool>(file) || file.eof();
+#endif
+        }
+
+        std::string_view view() const
+        {
+#ifndef _WIN32
+            return std::string_view(static_cast<const char *>(address), length);
+#else
+            return contents;
+#endif
+        }
+
+    private:
+#ifndef _WIN32
+        void *address = nullptr; // Start of the mapping
+        size_t length = 0;       // Mapped bytes
+#else
+        std::string contents; // Whole file
+#endif
+    };
+
+    // Splits off the first line of text, which is consumed
+    std::string_view takeLine(std::string_view &text)
+    {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        return line;
+    }
+
+    // Parses the entry lines of one chunk
+    void parseChunk(std::string_view text, std::vector<std::string> &names)
+    {
+        std::string name;
+        while (!text.empty())
+        {
+            if (MarkdownOutlineReader::parseEntryLine(takeLine(text), name))
+            {
+                names.push_back(name);
+            }
+        }
+    }
+
+    // Moves a chunk boundary forward to the start of the next line
+    size_t alignToLine(std::string_view text, size_t offset)
+    {
+        if (offset == 0 || offset >= text.size())
+        {
+            return std::min(offset, text.size());
+        }
+        size_t newline = text.find('\n', offset - 1);
+        return newline == std::string_view::npos ? text.size() : newline + 1;
+    }
+}
+
+OutlineChunkParser::OutlineChunkParser(size_t threadCount)
+    : threadCount(threadCount == 0 ? ThreadPool::getDefaultThreadCount() : threadCount)
+{
+}
+
+bool OutlineChunkParser::parse(const std::string &markdownPath, std::string &stemName, std::vector<std::string> &names)
+{
+    stemName.clear();
+    names.clear();
+
+    std::error_code ec;
+    size_t size = fs::file_size(markdownPath, ec);
+    if (ec || size < PARALLEL_MIN_BYTES || threadCount < 2)
+    {
+        // Small file: stream it on this thread (the reader reports missing files)
+        MarkdownOutlineReader reader;
+        if (!reader.open(markdownPath))
+        {
+            return false;
+        }
+        stemName = reader.getStemName();
+        std::string dirName;
+        while (reader.next(dirName))
+        {
+            names.push_back(dirName);
+        }
+        return true;
+    }
+
+    MappedFile file;
+    if (!file.open(markdownPath, size))
+    {
+        std::cerr << "Error: Could not open file: " << markdownPath << std::endl;
+        return false;
+    }
+
+    // First non-empty line is the stem directory name; entries follow it
+    std::string_view body = file.view();
+    while (!body.empty() && !MarkdownOutlineReader::parseStemLine(takeLine(body), stemName))
+    {
+    }
+
+    // Cut the rest into line-aligned chunks
+    size_t chunkCount = std::max<size_t>(1, std::min(threadCount * CHUNKS_PER_THREAD, body.size() / MIN_CHUNK_BYTES));
+    std::vector<size_t> bounds(chunkCount + 1);
+    for (size_t i = 0; i <= chunkCount; ++i)
+    {
+        bounds[i] = alignToLine(body, body.size() / chunkCount * i + (i == chunkCount ? body.size() % chunkCount : 0));
+    }
+
+    // Parse the chunks in parallel, each into its own list
+    std::vector<std::vector<std::string>> chunkNames(chunkCount);
+    {
+        ThreadPool pool(std::min(threadCount, chunkCount));
+        pool.parallelFor(chunkCount, [&](size_t i)
+                         {
+                             AllocationStats::Scope phase(AllocationStats::PHASE_PARSE);
+                             parseChunk(body.substr(bounds[i], bounds[i + 1] - bounds[i]), chunkNames[i]);
+                         });
+    }
+
+    // Stitch the lists together in file order so numbering matches a sequential read
+    size_t total = 0;
+    for (const auto &chunk : chunkNames)
+    {
+        total += chunk.size();
+    }
+    names.reserve(total);
+    for (auto &chunk : chunkNames)
+    {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(names));
+        std::vector<std::string>().swap(chunk);
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef OUTLINE_CHUNK_PARSER_H
+#define OUTLINE_CHUNK_PARSER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Parses a whole markdown outline on several threads
+ *
+ * The file is mapped into memory and the part after the stem line is split
+ * into chunks that start and end on line boundaries. Each chunk is parsed on
+ * a ThreadPool worker into its own list of names with the same rules as
+ * MarkdownOutlineReader, and the lists are then joined in file order, so the
+ * numbering is the same as a sequential read. Files below a size threshold
+ * are read sequentially, where threads would cost more than they save.
+ */
+class OutlineChunkParser
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param threadCount Number of parsing threads (0 selects the default thread count)
+     */
+    explicit OutlineChunkParser(size_t threadCount = 0);
+
+    /**
+     * @brief Reads the stem name and every subdirectory name of an outline
+     *
+     * @param markdownPath Path to the markdown file
+     * @param stemName Receives the stem directory name (empty if the file is blank)
+     * @param names Receives the subdirectory names in file order
+     * @return bool True if the file could be read
+     */
+    bool parse(const std::string &markdownPath, std::string &stemName, std::vector<std::string> &names);
+
+private:
+    size_t threadCount; // Parsing threads
+};
+
+#endif // OUTLINE_CHUNK_PARSER_H
@@ -0,0 +1,222 @@
+#include "OutlineWatcher.h"
+#include "DirectoryCreator.h"
+#include "TemplateFiles.h"
+#include "FileSystemBackend.h"
+#include "ErrorLog.h"
+#include "StemLock.h"
+#include "StemLayout.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace fs = std::filesystem;
+
+OutlineWatcher::OutlineWatcher(const fs::path &markdownPath, const fs::path &parentDir)
+    : markdownPath(markdownPath), parentDir(parentDir), inotifyFd(-1), watchDescriptor(-1)
+{
+}
+
+OutlineWatcher::~OutlineWatcher()
+{
+#ifdef __linux__
+    if (inotifyFd >= 0)
+    {
+        ::close(inotifyFd);
+    }
+#endif
+}
+
+bool OutlineWatcher::run()
+{
+#ifdef __linux__
+    // Watch the containing directory: editors often save by renaming a temp file over the outline
+    fs::path watchDir = markdownPath.parent_path().empty() ? fs::path(".") : markdownPath.parent_path();
+    inotifyFd = ::inotify_init1(IN_CLOEXEC);
+    if (inotifyFd >= 0)
+    {
+        watchDescriptor = ::inotify_add_watch(inotifyFd, watchDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    }
+    if (inotifyFd < 0 || watchDescriptor < 0)
+    {
+        std::cerr << "Error: Could not watch directory: " << watchDir << std::endl;
+        return false;
+    }
+#else
+    std::error_code ec;
+    lastWriteTime = fs::last_write_time(markdownPath, ec);
+#endif
+
+    if (!applyChanges())
+    {
+        return false;
+    }
+
+    std::cout << "Watching " << markdownPath.string() << " for changes (press Ctrl+C to stop)..." << std::endl;
+    while (waitForChange())
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (applyChanges())
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            std::cout << "Applied in " << elapsed.count() / 1000.0 << " ms." << std::endl;
+        }
+    }
+
+    return false;
+}
+
+bool OutlineWatcher::applyChanges()
+{
+    DirectoryCreator creator;
+    std::string newStemDirName;
+    std::vector<std::string> subDirNames;
+    if (!creator.readMarkdownStructure(markdownPath.string(), newStemDirName, subDirNames))
+    {
+        return false;
+    }
+    if (newStemDirName.empty())
+    {
+        std::cerr << "Error: No stem directory name found in " << markdownPath.string() << std::endl;
+        return false;
+    }
+
+    // A renamed stem is a different tree: start over with an empty previous parse
+    if (newStemDirName != stemDirName)
+    {
+        if (!stemDirName.empty())
+        {
+            std::cout << "Stem directory changed from '" << stemDirName << "' to '" << newStemDirName << "'." << std::endl;
+        }
+        stemDirName = newStemDirName;
+        knownNames.clear();
+    }
+
+    fs::path stemDir = parentDir / stemDirName;
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    if (StemLayout(stemDir).load())
+    {
+        std::cerr << "Error: --watch does not support sharded stems: " << stemDir.string() << std::endl;
+        return false;
+    }
+
+    // Build the new set of numbered names and create the ones not seen before
+    std::unordered_set<std::string> newNames;
+    newNames.reserve(subDirNames.size());
+    size_t created = 0;
+    try
+    {
+        backend.createDirectory(stemDir);
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Error creating stem directory: " << e.what() << std::endl;
+        return false;
+    }
+    StemLock stemLock(stemDir);
+
+    for (size_t i = 0; i < subDirNames.size(); ++i)
+    {
+        std::string formattedName = DirectoryCreator::formatSubdirectoryName(i + 1, subDirNames[i]);
+        bool isNew = knownNames.find(formattedName) == knownNames.end();
+        newNames.insert(formattedName);
+        if (!isNew)
+            continue;
+
+        // Only directories created now get templates; existing work is never overwritten
+        fs::path subDir = stemDir / formattedName;
+        try
+        {
+            if (backend.createDirectory(subDir))
+            {
+                std::cout << "  Created: " << formattedName << std::endl;
+                TemplateFiles::createTemplateFilesIn(subDir);
+                created++;
+            }
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            std::cerr << "  Error creating directory: " << e.what() << std::endl;
+        }
+    }
+
+    // Report entries that disappeared from the outline
+    std::vector<std::string> removedNames;
+    for (const auto &name : knownNames)
+    {
+        if (newNames.find(name) == newNames.end())
+        {
+            removedNames.push_back(name);
+        }
+    }
+    std::sort(removedNames.begin(), removedNames.end());
+    for (const auto &name : removedNames)
+    {
+        std::cout << "  Removed from outline (left on disk): " << name << std::endl;
+    }
+    size_t removed = removedNames.size();
+    ErrorLog::printSummary();
+
+    knownNames = std::move(newNames);
+    std::cout << "Outline has " << subDirNames.size() << " entries: " << created << " created, "
+              << removed << " removed." << std::endl;
+    return true;
+}
+
+bool OutlineWatcher::waitForChange()
+{
+#ifdef __linux__
+    const std::string fileName = markdownPath.filename().string();
+    alignas(struct inotify_event) char buffer[4096];
+
+    bool changed = false;
+    while (true)
+    {
+        // Block for the first event, then drain the burst an editor produces on save
+        struct pollfd pfd = {inotifyFd, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, changed ? 20 : -1);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready < 0)
+            return false;
+        if (ready == 0)
+            return true; // Quiet period after a change
+
+        ssize_t length = ::read(inotifyFd, buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR)
+            continue;
+        if (length <= 0)
+            return false;
+
+        for (char *ptr = buffer; ptr < buffer + length;)
+        {
+            auto *event = reinterpret_cast<struct inotify_event *>(ptr);
+            if (event->len > 0 && fileName == event->name)
+            {
+                changed = true;
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#else
+    // Without inotify, poll the modification time
+    while (true)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        std::error_code ec;
+        fs::file_time_type writeTime = fs::last_write_time(markdownPath, ec);
+        if (!ec && writeTime != lastWriteTime)
+        {
+            lastWriteTime = writeTime;
+            return true;
+        }
+    }
+#endif
+}
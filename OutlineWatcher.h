@@ -0,0 +1,70 @@
+#ifndef OUTLINE_WATCHER_H
+#define OUTLINE_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Keeps a stem directory in sync with a markdown outline while it is edited
+ *
+ * OutlineWatcher parses the outline once, then waits for the file to be saved
+ * (inotify on Linux, mtime polling elsewhere). After each save it re-parses the
+ * file, diffs the numbered subdirectory names against the previous parse and
+ * applies only the delta: new subdirectories are created and templated, removed
+ * ones are reported but left on disk.
+ */
+class OutlineWatcher
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param markdownPath Outline file to watch
+     * @param parentDir Directory in which the stem directory lives
+     */
+    OutlineWatcher(const fs::path &markdownPath, const fs::path &parentDir);
+
+    /**
+     * @brief Destructor releases the inotify instance
+     */
+    ~OutlineWatcher();
+
+    OutlineWatcher(const OutlineWatcher &) = delete;
+    OutlineWatcher &operator=(const OutlineWatcher &) = delete;
+
+    /**
+     * @brief Applies the outline and then watches it until interrupted
+     *
+     * @return bool False if the outline could not be watched
+     */
+    bool run();
+
+    /**
+     * @brief Re-parses the outline and applies the difference to disk
+     *
+     * @return bool True if the outline could be parsed
+     */
+    bool applyChanges();
+
+private:
+    /**
+     * @brief Blocks until the outline file has been written or replaced
+     *
+     * @return bool False if watching failed
+     */
+    bool waitForChange();
+
+    fs::path markdownPath;                       // Outline being watched
+    fs::path parentDir;                          // Parent of the stem directory
+    std::string stemDirName;                     // Stem name from the previous parse
+    std::unordered_set<std::string> knownNames;  // Numbered subdirectory names from the previous parse
+    int inotifyFd;                               // inotify instance (-1 when polling)
+    int watchDescriptor;                         // Watch on the outline's directory
+    fs::file_time_type lastWriteTime;            // Last seen modification time (polling mode)
+};
+
+#endif // OUTLINE_WATCHER_H
@@ -0,0 +1,668 @@
+#include "PosixFileSystemBackend.h"
+#include <system_error>
+#include <atomic>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <fstream>
+#include <process.h>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <grp.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Distinguishes temporary files created by different threads of this process
+    std::atomic<unsigned long> temporaryCounter{0};
+
+    // Builds a hidden, process-unique temporary name for a file about to be written
+    std::string makeTemporaryName(const fs::path &filePath)
+    {
+#ifdef _WIN32
+        unsigned long processId = static_cast<unsigned long>(_getpid());
+#else
+        unsigned long processId = static_cast<unsigned long>(::getpid());
+#endif
+        return "." + filePath.filename().string() + ".tmp." + std::to_string(processId) + "." +
+               std::to_string(temporaryCounter.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    // Parses a whole decimal number, as accepted in place of a user or group name
+    bool parseId(const std::string &text, long &id)
+    {
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        id = std::strtol(text.c_str(), nullptr, 10);
+        return true;
+    }
+}
+
+bool PosixFileSystemBackend::parseMode(const std::string &text, int &mode)
+{
+    if (text.empty() || text.size() > 5 || text.find_first_not_of("01234567") != std::string::npos)
+    {
+        return false;
+    }
+    long value = std::strtol(text.c_str(), nullptr, 8);
+    if (value > 07777)
+    {
+        return false;
+    }
+    mode = static_cast<int>(value);
+    return true;
+}
+
+bool PosixFileSystemBackend::isTemporaryName(const std::string &name)
+{
+    auto isNumber = [](const std::string &text, size_t begin, size_t end)
+    { return begin < end && text.find_first_not_of("0123456789", begin) >= end; };
+
+    // Matches makeTemporaryName() from the end: ".tmp", the process ID and the counter
+    if (name.empty() || name.front() != '.')
+    {
+        return false;
+    }
+    size_t counterDot = name.rfind('.');
+    if (counterDot == 0 || !isNumber(name, counterDot + 1, name.size()))
+    {
+        return false;
+    }
+    size_t processDot = name.rfind('.', counterDot - 1);
+    if (processDot == std::string::npos || !isNumber(name, processDot + 1, counterDot))
+    {
+        return false;
+    }
+    return processDot >= 6 && name.compare(processDot - 4, 4, ".tmp") == 0;
+}
+
+const PosixFileSystemBackend::Ownership &PosixFileSystemBackend::getOwnership() const
+{
+    return ownership;
+}
+
+#ifdef _WIN32
+
+PosixFileSystemBackend::PosixFileSystemBackend(const Ownership &ownership) : ownership(ownership)
+{
+}
+
+bool PosixFileSystemBackend::resolveOwner(const std::string &, long &)
+{
+    return false;
+}
+
+bool PosixFileSystemBackend::resolveGroup(const std::string &, long &)
+{
+    return false;
+}
+
+bool PosixFileSystemBackend::createDirectory(const fs::path &dirPath)
+{
+    return fs::create_directories(dirPath);
+}
+
+bool PosixFileSystemBackend::createDirectory(const fs::path &dirPath, std::error_code &ec)
+{
+    return fs::create_directories(dirPath, ec);
+}
+
+void PosixFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content)
+{
+    std::error_code ec;
+    writeFile(filePath, content, ec);
+    if (ec)
+    {
+        throw fs::filesystem_error("Could not write file", filePath, ec);
+    }
+}
+
+void PosixFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec)
+{
+    ec.clear();
+
+    // Write a private temporary file, then move it over the target in one step
+    fs::path tempPath = filePath.parent_path() / makeTemporaryName(filePath);
+    {
+        std::ofstream file(tempPath, std::ios::out | std::ios::binary);
+        if (!file)
+        {
+            ec = std::make_error_code(std::errc::io_error);
+            return;
+        }
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!file.flush())
+        {
+            file.close();
+            std::error_code ignored;
+            fs::remove(tempPath, ignored);
+            ec = std::make_error_code(std::errc::io_error);
+            return;
+        }
+    }
+
+    fs::rename(tempPath, filePath, ec);
+    if (ec)
+    {
+        std::error_code ignored;
+        fs::remove(tempPath, ignored);
+    }
+}
+
+void PosixFileSystemBackend::renameEntry(const fs::path &from, const fs::path &to)
+{
+    if (fs::exists(to))
+    {
+        throw fs::filesystem_error("Rename target exists", from, to, std::make_error_code(std::errc::file_exists));
+    }
+    fs::rename(from, to);
+}
+
+std::vector<FileSystemBackend::DirectoryEntry> PosixFileSystemBackend::listDirectory(const fs::path &dirPath)
+{
+    std::vector<DirectoryEntry> entries;
+    for (const auto &entry : fs::directory_iterator(dirPath))
+    {
+        entries.push_back({entry.path().filename().string(), entry.is_directory()});
+    }
+    return entries;
+}
+
+FileSystemBackend::FileStatus PosixFileSystemBackend::status(const fs::path &path)
+{
+    std::error_code ec;
+    fs::file_status st = fs::status(path, ec);
+
+    FileStatus result;
+    result.exists = !ec && fs::exists(st);
+    result.isDirectory = result.exists && fs::is_directory(st);
+    if (result.exists && !result.isDirectory)
+    {
+        result.size = fs::file_size(path, ec);
+    }
+    return result;
+}
+
+#else
+
+namespace
+{
+    // Throws a filesystem_error built from the current errno
+    [[noreturn]] void throwErrno(const char *what, const fs::path &path)
+    {
+        throw fs::filesystem_error(what, path, std::error_code(errno, std::generic_category()));
+    }
+
+    // Builds an error code from the current errno
+    std::error_code lastError()
+    {
+        return std::error_code(errno, std::generic_category());
+    }
+
+    // Mode passed to mkdir and mkdirat
+    mode_t directoryMode(const PosixFileSystemBackend::Ownership &ownership)
+    {
+        return ownership.dirMode < 0 ? 0777 : static_cast<mode_t>(ownership.dirMode);
+    }
+
+    // Mode passed to openat for new files
+    mode_t fileMode(const PosixFileSystemBackend::Ownership &ownership)
+    {
+        return ownership.fileMode < 0 ? 0666 : static_cast<mode_t>(ownership.fileMode);
+    }
+
+    // Checks whether new entries change hands at all
+    bool changesOwner(const PosixFileSystemBackend::Ownership &ownership)
+    {
+        return ownership.owner >= 0 || ownership.group >= 0;
+    }
+
+    // The umask may strip requested bits, mkdir ignores the set-ID bits and chown clears them,
+    // so a requested mode is always applied with an explicit chmod afterwards
+    bool needsChmod(int mode)
+    {
+        return mode >= 0;
+    }
+
+    // Hands a new entry to the configured owner through its open descriptor
+    bool applyOwnership(const PosixFileSystemBackend::Ownership &ownership, int fd, int mode, std::error_code &ec)
+    {
+        if (changesOwner(ownership) &&
+            ::fchown(fd, static_cast<uid_t>(ownership.owner), static_cast<gid_t>(ownership.group)) != 0)
+        {
+            ec = lastError();
+            return false;
+        }
+        if (needsChmod(mode) && ::fchmod(fd, static_cast<mode_t>(mode)) != 0)
+        {
+            ec = lastError();
+            return false;
+        }
+        return true;
+    }
+
+    // Same for a new directory that has no descriptor of its own, through its parent's descriptor
+    bool applyOwnershipAt(const PosixFileSystemBackend::Ownership &ownership, int dirFd, const char *path, int mode,
+                          std::error_code &ec)
+    {
+        if (changesOwner(ownership) &&
+            ::fchownat(dirFd, path, static_cast<uid_t>(ownership.owner), static_cast<gid_t>(ownership.group),
+                       AT_SYMLINK_NOFOLLOW) != 0)
+        {
+            ec = lastError();
+            return false;
+        }
+        if (needsChmod(mode) && ::fchmodat(dirFd, path, static_cast<mode_t>(mode), 0) != 0)
+        {
+            ec = lastError();
+            return false;
+        }
+        return true;
+    }
+
+    // Creates a directory and any missing parents; new parents always get the ownership, the leaf only if asked
+    bool makeDirectories(const PosixFileSystemBackend::Ownership &ownership, const fs::path &dirPath, bool ownLeaf,
+                         std::error_code &ec)
+    {
+        ec.clear();
+
+        // Fast path: the parent usually exists already
+        if (::mkdir(dirPath.c_str(), directoryMode(ownership)) == 0)
+        {
+            if (ownLeaf)
+            {
+                applyOwnershipAt(ownership, AT_FDCWD, dirPath.c_str(), ownership.dirMode, ec);
+            }
+            return true;
+        }
+
+        if (errno == EEXIST)
+        {
+            struct stat st;
+            if (::stat(dirPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+            {
+                return false;
+            }
+            ec = std::make_error_code(std::errc::not_a_directory);
+            return false;
+        }
+
+        std::error_code mkdirError = lastError();
+        fs::path parent = dirPath.parent_path();
+        if (mkdirError != std::errc::no_such_file_or_directory || parent.empty() || parent == dirPath)
+        {
+            ec = mkdirError;
+            return false;
+        }
+
+        // Create missing parents first, then retry
+        makeDirectories(ownership, parent, true, ec);
+        if (ec)
+        {
+            return false;
+        }
+        if (::mkdir(dirPath.c_str(), directoryMode(ownership)) != 0)
+        {
+            if (errno != EEXIST)
+            {
+                ec = lastError();
+            }
+            return false;
+        }
+        if (ownLeaf)
+        {
+            applyOwnershipAt(ownership, AT_FDCWD, dirPath.c_str(), ownership.dirMode, ec);
+        }
+        return true;
+    }
+
+    // Writes a file relative to a directory descriptor via a temporary file and renameat
+    void writeFileRelative(const PosixFileSystemBackend::Ownership &ownership, int dirFd, const fs::path &filePath,
+                           std::string_view content, std::error_code &ec)
+    {
+        ec.clear();
+
+        // Create a private temporary file next to the target; O_EXCL guarantees nobody else owns it
+        fs::path tempPath;
+        int fd = -1;
+        for (int attempt = 0; attempt < 16 && fd < 0; ++attempt)
+        {
+            tempPath = filePath.parent_path() / makeTemporaryName(filePath);
+            fd = ::openat(dirFd, tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, fileMode(ownership));
+            if (fd < 0 && errno != EEXIST)
+            {
+                break;
+            }
+        }
+        if (fd < 0)
+        {
+            ec = lastError();
+            return;
+        }
+
+        // Every failure from here on removes the temporary file again, so none is left behind
+        auto discard = [&](std::error_code error)
+        {
+            ec = error;
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+            ::unlinkat(dirFd, tempPath.c_str(), 0);
+        };
+
+        // Write until all bytes are out, retrying on interrupts
+        const char *data = content.data();
+        size_t remaining = content.size();
+        while (remaining > 0)
+        {
+            ssize_t written = ::write(fd, data, remaining);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                discard(lastError());
+                return;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+
+        // The temporary file is still open, so it is handed over before the rename makes it visible
+        std::error_code ownershipError;
+        if (!applyOwnership(ownership, fd, ownership.fileMode, ownershipError))
+        {
+            discard(ownershipError);
+            return;
+        }
+
+        int closeResult = ::close(fd);
+        fd = -1;
+        if (closeResult != 0)
+        {
+            discard(lastError());
+            return;
+        }
+
+        // Atomically replace the target; readers see either the old or the new file
+        if (::renameat(dirFd, tempPath.c_str(), dirFd, filePath.c_str()) != 0)
+        {
+            discard(lastError());
+        }
+    }
+}
+
+PosixFileSystemBackend::PosixFileSystemBackend(const Ownership &ownership) : ownership(ownership)
+{
+}
+
+bool PosixFileSystemBackend::resolveOwner(const std::string &name, long &id)
+{
+    if (parseId(name, id))
+    {
+        return true;
+    }
+    struct passwd *entry = ::getpwnam(name.c_str());
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    id = static_cast<long>(entry->pw_uid);
+    return true;
+}
+
+bool PosixFileSystemBackend::resolveGroup(const std::string &name, long &id)
+{
+    if (parseId(name, id))
+    {
+        return true;
+    }
+    struct group *entry = ::getgrnam(name.c_str());
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    id = static_cast<long>(entry->gr_gid);
+    return true;
+}
+
+bool PosixFileSystemBackend::createDirectory(const fs::path &dirPath)
+{
+    std::error_code ec;
+    bool created = createDirectory(dirPath, ec);
+    if (ec)
+    {
+        throw fs::filesystem_error("Could not create directory", dirPath, ec);
+    }
+    return created;
+}
+
+bool PosixFileSystemBackend::createDirectory(const fs::path &dirPath, std::error_code &ec)
+{
+    return makeDirectories(ownership, dirPath, true, ec);
+}
+
+void PosixFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content)
+{
+    std::error_code ec;
+    writeFileRelative(ownership, AT_FDCWD, filePath, content, ec);
+    if (ec)
+    {
+        throw fs::filesystem_error("Could not write file", filePath, ec);
+    }
+}
+
+void PosixFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec)
+{
+    writeFileRelative(ownership, AT_FDCWD, filePath, content, ec);
+}
+
+FileSystemBackend::DirectoryHandle PosixFileSystemBackend::createAndOpenDirectory(const fs::path &dirPath, bool &created)
+{
+    std::error_code ec;
+    DirectoryHandle handle = createAndOpenDirectory(dirPath, created, ec);
+    if (ec)
+    {
+        throw fs::filesystem_error("Could not create directory", dirPath, ec);
+    }
+    return handle;
+}
+
+FileSystemBackend::DirectoryHandle PosixFileSystemBackend::createAndOpenDirectory(const fs::path &dirPath, bool &created,
+                                                                                  std::error_code &ec)
+{
+    created = makeDirectories(ownership, dirPath, false, ec);
+    if (ec)
+    {
+        return DirectoryHandle();
+    }
+    int fd = ::open(dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        ec = lastError();
+        return DirectoryHandle();
+    }
+
+    // Chown through the descriptor that is open anyway
+    if (created && !applyOwnership(ownership, fd, ownership.dirMode, ec))
+    {
+        ::close(fd);
+        return DirectoryHandle();
+    }
+    return DirectoryHandle(dirPath, fd);
+}
+
+FileSystemBackend::DirectoryHandle PosixFileSystemBackend::openDirectory(const fs::path &dirPath)
+{
+    int fd = ::open(dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throwErrno("Could not open directory", dirPath);
+    }
+    return DirectoryHandle(dirPath, fd);
+}
+
+bool PosixFileSystemBackend::createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath)
+{
+    std::error_code ec;
+    bool created = createDirectoryAt(parent, relativePath, ec);
+    if (ec)
+    {
+        throw fs::filesystem_error("Could not create directory", parent.getPath() / relativePath, ec);
+    }
+    return created;
+}
+
+bool PosixFileSystemBackend::createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath,
+                                               std::error_code &ec)
+{
+    // Handles without a descriptor only carry the path
+    if (parent.getDescriptor() < 0)
+    {
+        return createDirectory(parent.getPath() / relativePath, ec);
+    }
+
+    ec.clear();
+    if (::mkdirat(parent.getDescriptor(), relativePath.c_str(), directoryMode(ownership)) == 0)
+    {
+        applyOwnershipAt(ownership, parent.getDescriptor(), relativePath.c_str(), ownership.dirMode, ec);
+        return true;
+    }
+    ec = lastError();
+    if (errno == EEXIST)
+    {
+        // Existing directories are fine; anything else in the way is reported like in createDirectory
+        struct stat st;
+        if (::fstatat(parent.getDescriptor(), relativePath.c_str(), &st, 0) == 0)
+        {
+            ec = S_ISDIR(st.st_mode) ? std::error_code() : std::make_error_code(std::errc::not_a_directory);
+        }
+    }
+    return false;
+}
+
+void PosixFileSystemBackend::writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content)
+{
+    std::error_code ec;
+    writeFileAt(parent, relativePath, content, ec);
+    if (ec)
+    {
+        throw fs::filesystem_error("Could not write file", parent.getPath() / relativePath, ec);
+    }
+}
+
+void PosixFileSystemBackend::writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath,
+                                         std::string_view content, std::error_code &ec)
+{
+    if (parent.getDescriptor() < 0)
+    {
+        writeFileRelative(ownership, AT_FDCWD, parent.getPath() / relativePath, content, ec);
+        return;
+    }
+    writeFileRelative(ownership, parent.getDescriptor(), relativePath, content, ec);
+}
+
+void PosixFileSystemBackend::renameEntry(const fs::path &from, const fs::path &to)
+{
+#ifdef RENAME_NOREPLACE
+    // Atomically refuse to clobber an existing destination
+    if (::renameat2(AT_FDCWD, from.c_str(), AT_FDCWD, to.c_str(), RENAME_NOREPLACE) == 0)
+    {
+        return;
+    }
+    if (errno != EINVAL && errno != ENOSYS)
+    {
+        throw fs::filesystem_error("Could not rename", from, to, std::error_code(errno, std::generic_category()));
+    }
+#endif
+
+    // Filesystem without RENAME_NOREPLACE support: check, then rename
+    struct stat st;
+    if (::lstat(to.c_str(), &st) == 0)
+    {
+        throw fs::filesystem_error("Rename target exists", from, to, std::make_error_code(std::errc::file_exists));
+    }
+    if (::renameat(AT_FDCWD, from.c_str(), AT_FDCWD, to.c_str()) != 0)
+    {
+        throw fs::filesystem_error("Could not rename", from, to, std::error_code(errno, std::generic_category()));
+    }
+}
+
+std::vector<FileSystemBackend::DirectoryEntry> PosixFileSystemBackend::listDirectory(const fs::path &dirPath)
+{
+    std::vector<DirectoryEntry> entries;
+    forEachEntry(dirPath, [&entries](const DirectoryEntry &entry)
+                 { entries.push_back(entry); });
+    return entries;
+}
+
+void PosixFileSystemBackend::forEachEntry(const fs::path &dirPath,
+                                          const std::function<void(const DirectoryEntry &)> &visitor)
+{
+    DIR *dir = ::opendir(dirPath.c_str());
+    if (!dir)
+    {
+        throwErrno("Could not open directory", dirPath);
+    }
+
+    // Close the stream even if the visitor throws
+    std::unique_ptr<DIR, int (*)(DIR *)> closer(dir, ::closedir);
+    DirectoryEntry current;
+    while (struct dirent *entry = ::readdir(dir))
+    {
+        std::string_view name(entry->d_name);
+        if (name == "." || name == "..")
+            continue;
+
+        bool isDirectory = false;
+        if (entry->d_type == DT_DIR)
+        {
+            isDirectory = true;
+        }
+        else if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK)
+        {
+            // Filesystem did not fill in d_type (or it is a symlink): ask stat
+            struct stat st;
+            isDirectory = ::fstatat(::dirfd(dir), entry->d_name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        current.name.assign(name);
+        current.isDirectory = isDirectory;
+        visitor(current);
+    }
+}
+
+FileSystemBackend::FileStatus PosixFileSystemBackend::status(const fs::path &path)
+{
+    FileStatus result;
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0)
+    {
+        result.exists = true;
+        result.isDirectory = S_ISDIR(st.st_mode);
+        result.size = result.isDirectory ? 0 : static_cast<std::uintmax_t>(st.st_size);
+    }
+    return result;
+}
+
+#endif
+
+bool PosixFileSystemBackend::isOnDisk() const
+{
+    return true;
+}
+
+std::string PosixFileSystemBackend::getName() const
+{
+    return "posix";
+}
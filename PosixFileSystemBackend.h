@@ -0,0 +1,123 @@
+#ifndef POSIX_FILE_SYSTEM_BACKEND_H
+#define POSIX_FILE_SYSTEM_BACKEND_H
+
+#include "FileSystemBackend.h"
+
+/**
+ * @brief Filesystem backend that performs real disk I/O
+ *
+ * On POSIX systems the backend talks to the kernel directly through
+ * mkdir/open/write/readdir/stat so that no stream or locale machinery sits
+ * between the engine and the system calls. On Windows it falls back to
+ * std::filesystem and std::ofstream.
+ *
+ * Files are never written in place: content goes to an exclusively created
+ * temporary file in the same directory which is then renamed over the
+ * target, so concurrent writers and readers never observe a torn file.
+ *
+ * An Ownership can be given to hand everything the backend creates to
+ * another user: the modes are passed straight to mkdir/mkdirat/openat and
+ * the new directory or temporary file is chowned through the descriptor or
+ * parent descriptor already at hand, so no second walk over the tree is
+ * needed. Directories that already existed are left as they are.
+ */
+class PosixFileSystemBackend : public FileSystemBackend
+{
+public:
+    /**
+     * @brief Owner and permission bits applied to created entries
+     */
+    struct Ownership
+    {
+        long owner = -1;   // User ID for new entries (-1 keeps the caller's)
+        long group = -1;   // Group ID for new entries (-1 keeps the caller's)
+        int dirMode = -1;  // Mode of new directories (-1 for 0777 less the umask)
+        int fileMode = -1; // Mode of new files (-1 for 0666 less the umask)
+    };
+
+    /**
+     * @brief Constructor
+     */
+    PosixFileSystemBackend() = default;
+
+    /**
+     * @brief Constructor that applies an owner, group and modes to everything created
+     *
+     * The process umask is left alone; a requested mode is applied with chmod after creation.
+     *
+     * @param ownership Owner, group and modes for new directories and files
+     */
+    explicit PosixFileSystemBackend(const Ownership &ownership);
+
+    /**
+     * @brief Resolves a user name or numeric ID
+     *
+     * @param name User name, or a number
+     * @param id Receives the user ID
+     * @return bool True if the user exists (always false on Windows)
+     */
+    static bool resolveOwner(const std::string &name, long &id);
+
+    /**
+     * @brief Resolves a group name or numeric ID
+     *
+     * @param name Group name, or a number
+     * @param id Receives the group ID
+     * @return bool True if the group exists (always false on Windows)
+     */
+    static bool resolveGroup(const std::string &name, long &id);
+
+    /**
+     * @brief Parses an octal permission mode such as "0750" or "2770"
+     *
+     * @param text Octal digits
+     * @param mode Receives the mode
+     * @return bool True if the text is an octal number no larger than 07777
+     */
+    static bool parseMode(const std::string &text, int &mode);
+
+    /**
+     * @brief Checks whether a name is one of the temporary files writeFile renames into place
+     *
+     * Such files are only left behind when the process dies between creating and renaming them.
+     *
+     * @param name Entry name without path components
+     * @return bool True for names of the form ".<file>.tmp.<pid>.<counter>"
+     */
+    static bool isTemporaryName(const std::string &name);
+
+    /**
+     * @brief Gets the owner, group and modes applied to created entries
+     *
+     * @return const Ownership& Configured ownership (all -1 when unset)
+     */
+    const Ownership &getOwnership() const;
+
+    bool createDirectory(const fs::path &dirPath) override;
+    void writeFile(const fs::path &filePath, std::string_view content) override;
+    bool createDirectory(const fs::path &dirPath, std::error_code &ec) override;
+    void writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec) override;
+    void renameEntry(const fs::path &from, const fs::path &to) override;
+#ifndef _WIN32
+    DirectoryHandle createAndOpenDirectory(const fs::path &dirPath, bool &created) override;
+    DirectoryHandle createAndOpenDirectory(const fs::path &dirPath, bool &created, std::error_code &ec) override;
+    DirectoryHandle openDirectory(const fs::path &dirPath) override;
+    bool createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath) override;
+    bool createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath, std::error_code &ec) override;
+    void writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content) override;
+    void writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content,
+                     std::error_code &ec) override;
+#endif
+    std::vector<DirectoryEntry> listDirectory(const fs::path &dirPath) override;
+#ifndef _WIN32
+    void forEachEntry(const fs::path &dirPath, const std::function<void(const DirectoryEntry &)> &visitor) override;
+#endif
+    FileStatus status(const fs::path &path) override;
+    bool isOnDisk() const override;
+    std::string getName() const override;
+
+private:
+    Ownership ownership; // Owner, group and modes for new entries
+};
+
+#endif // POSIX_FILE_SYSTEM_BACKEND_H
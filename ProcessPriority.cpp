@@ -0,0 +1,92 @@
+#include "ProcessPriority.h"
+#include <iostream>
+#include <atomic>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    // Nice level for worker threads; kNoNiceLevel leaves them unchanged
+    constexpr int kNoNiceLevel = 1000;
+    std::atomic<int> workerNiceLevel{kNoNiceLevel};
+
+#ifdef __linux__
+    // Values from linux/ioprio.h, which is not installed everywhere
+    constexpr int IOPRIO_CLASS_SHIFT = 13;
+    constexpr int IOPRIO_CLASS_BE = 2;
+    constexpr int IOPRIO_CLASS_IDLE = 3;
+    constexpr int IOPRIO_WHO_PROCESS = 1;
+#endif
+}
+
+bool ProcessPriority::setIoPriority(const std::string &spec)
+{
+    bool idle = false;
+    int level = 0;
+    if (spec == "idle")
+    {
+        idle = true;
+    }
+    else if (spec.size() == 4 && spec.compare(0, 3, "be:") == 0 && spec[3] >= '0' && spec[3] <= '7')
+    {
+        level = spec[3] - '0';
+    }
+    else
+    {
+        std::cerr << "Error: --ioprio expects 'idle' or 'be:N' with N from 0 to 7." << std::endl;
+        return false;
+    }
+
+#ifdef __linux__
+    int value = ((idle ? IOPRIO_CLASS_IDLE : IOPRIO_CLASS_BE) << IOPRIO_CLASS_SHIFT) | level;
+    if (::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, value) != 0)
+    {
+        std::cerr << "Error: Could not set I/O priority: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+#else
+    (void)idle;
+    (void)level;
+    std::cerr << "Error: --ioprio is only supported on Linux." << std::endl;
+    return false;
+#endif
+}
+
+bool ProcessPriority::setWorkerNiceLevel(int level)
+{
+    if (level < -20 || level > 19)
+    {
+        std::cerr << "Error: --nice expects a level from -20 to 19." << std::endl;
+        return false;
+    }
+#ifdef __linux__
+    workerNiceLevel = level;
+    return true;
+#else
+    std::cerr << "Error: --nice is only supported on Linux." << std::endl;
+    return false;
+#endif
+}
+
+void ProcessPriority::applyWorkerNiceLevel()
+{
+#ifdef __linux__
+    // On Linux the nice value is per thread, so this leaves the main thread alone
+    int level = workerNiceLevel.load();
+    if (level != kNoNiceLevel && ::setpriority(PRIO_PROCESS, static_cast<id_t>(::gettid()), level) != 0)
+    {
+        static std::atomic<bool> warned{false};
+        if (!warned.exchange(true))
+        {
+            std::cerr << "Warning: Could not set worker nice level: " << std::strerror(errno) << std::endl;
+        }
+    }
+#endif
+}
@@ -0,0 +1,39 @@
+#ifndef PROCESS_PRIORITY_H
+#define PROCESS_PRIORITY_H
+
+#include <string>
+
+/**
+ * @brief Lowers the I/O and CPU priority of the tool on busy hosts
+ *
+ * The I/O priority is set once for the whole process before any worker is
+ * started, so every thread inherits it. The CPU nice level only applies to
+ * ThreadPool workers, which call applyWorkerNiceLevel() when they start.
+ * Both are Linux features; elsewhere they are reported as unsupported.
+ */
+class ProcessPriority
+{
+public:
+    /**
+     * @brief Sets the I/O scheduling class of the process
+     *
+     * @param spec "idle" or "be:N" with N from 0 (highest) to 7 (lowest)
+     * @return bool True if the specification was valid and applied
+     */
+    static bool setIoPriority(const std::string &spec);
+
+    /**
+     * @brief Sets the nice level that worker threads apply when they start
+     *
+     * @param level Nice level from -20 to 19
+     * @return bool True if the level is in range and supported on this platform
+     */
+    static bool setWorkerNiceLevel(int level);
+
+    /**
+     * @brief Applies the configured nice level to the calling thread
+     */
+    static void applyWorkerNiceLevel();
+};
+
+#endif // PROCESS_PRIORITY_H
@@ -0,0 +1,113 @@
+#include "PrototypeFanOut.h"
+#include "DirectoryCreator.h"
+#include "ProvisioningPipeline.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <system_error>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+PrototypeFanOut::PrototypeFanOut(size_t creatorCount, size_t templateWorkerCount)
+    : creatorCount(creatorCount), templateWorkerCount(templateWorkerCount)
+{
+}
+
+bool PrototypeFanOut::run(const std::string &markdownPath, const std::vector<fs::path> &parentDirs, ThreadPool &pool,
+                          Result &result)
+{
+    DirectoryCreator creator;
+    std::string stemDirName;
+    std::vector<std::string> subDirNames;
+    if (!creator.readMarkdownStructure(markdownPath, stemDirName, subDirNames))
+    {
+        return false;
+    }
+    if (stemDirName.empty())
+    {
+        std::cerr << "Error: No stem directory name found in " << markdownPath << std::endl;
+        return false;
+    }
+
+    // Only parents that exist and do not have the stem yet receive a copy
+    std::vector<fs::path> targets;
+    for (const auto &parentDir : parentDirs)
+    {
+        std::error_code ec;
+        if (!fs::is_directory(parentDir, ec))
+        {
+            std::cerr << "Error: Parent directory does not exist: " << parentDir.string() << std::endl;
+            result.parentsFailed++;
+        }
+        else if (fs::exists(parentDir / stemDirName, ec))
+        {
+            std::cout << "Skipping " << parentDir.string() << ": " << stemDirName << " already exists." << std::endl;
+            result.parentsSkipped++;
+        }
+        else
+        {
+            targets.push_back(parentDir);
+        }
+    }
+    if (targets.empty())
+    {
+        return result.parentsFailed == 0;
+    }
+
+    // Build the prototype once, on the same filesystem as the first parent so it can be cloned
+    auto start = std::chrono::steady_clock::now();
+    fs::path prototypeDir = makePrototypePath(targets.front());
+    ProvisioningPipeline pipeline(creatorCount, templateWorkerCount, 256);
+    ProvisioningPipeline::Result built;
+    bool success = pipeline.run(markdownPath, prototypeDir, built);
+    result.prototypeDirectories = built.entries;
+    auto builtAt = std::chrono::steady_clock::now();
+    result.prototypeTime = std::chrono::duration_cast<std::chrono::microseconds>(builtAt - start);
+
+    // Replicate the prototype into every parent at once
+    if (success)
+    {
+        SourceTreeCopier copier(prototypeDir);
+        success = copier.scan();
+        if (success)
+        {
+            result.copy = copier.copyTo(targets, pool);
+            result.parentsFailed += result.copy.destinationsFailed;
+            result.parentsProvisioned = targets.size() - result.copy.destinationsFailed;
+            success = result.copy.filesFailed == 0 && result.copy.destinationsFailed == 0;
+        }
+    }
+    else
+    {
+        std::cerr << "Error: Could not build the prototype stem; no parent was changed." << std::endl;
+        result.parentsFailed += targets.size();
+    }
+    result.replicateTime =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - builtAt);
+
+    // The prototype is scratch space; leaving it behind would only confuse later runs
+    std::error_code ec;
+    fs::remove_all(prototypeDir, ec);
+    if (ec)
+    {
+        std::cerr << "Warning: Could not remove prototype " << prototypeDir.string() << ": " << ec.message()
+                  << std::endl;
+    }
+
+    return success && result.parentsFailed == 0;
+}
+
+fs::path PrototypeFanOut::makePrototypePath(const fs::path &parentDir)
+{
+#ifdef _WIN32
+    unsigned long processId = static_cast<unsigned long>(_getpid());
+#else
+    unsigned long processId = static_cast<unsigned long>(::getpid());
+#endif
+    return parentDir / (".dirtemplate-prototype." + std::to_string(processId));
+}
@@ -0,0 +1,75 @@
+#ifndef PROTOTYPE_FAN_OUT_H
+#define PROTOTYPE_FAN_OUT_H
+
+#include "SourceTreeCopier.h"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+class ThreadPool;
+
+/**
+ * @brief Provisions the same outline under many parent directories
+ *
+ * PrototypeFanOut parses the outline and builds one fully templated stem
+ * only once, in a hidden prototype directory next to the first parent.
+ * The prototype is then replicated into every parent in parallel with
+ * SourceTreeCopier, so on reflink filesystems each additional parent costs
+ * a clone of the prototype rather than a full provisioning pass. The
+ * prototype is removed afterwards. Parents that already contain the stem
+ * are skipped so existing work is never overwritten.
+ */
+class PrototypeFanOut
+{
+public:
+    /**
+     * @brief Structure summarizing a fan-out run
+     */
+    struct Result
+    {
+        size_t parentsProvisioned = 0;              // Parents that received a complete stem
+        size_t parentsSkipped = 0;                  // Parents that already contained the stem
+        size_t parentsFailed = 0;                   // Parents that are missing or could not be written
+        size_t prototypeDirectories = 0;            // Lesson directories in the prototype
+        SourceTreeCopier::CopyResult copy;          // Totals of the replication phase
+        std::chrono::microseconds prototypeTime{0}; // Time spent building the prototype
+        std::chrono::microseconds replicateTime{0}; // Time spent replicating it into the parents
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param creatorCount Directory creation workers used to build the prototype
+     * @param templateWorkerCount Template workers used to build the prototype
+     */
+    PrototypeFanOut(size_t creatorCount, size_t templateWorkerCount);
+
+    /**
+     * @brief Provisions the stem described by an outline under every parent
+     *
+     * @param markdownPath Path to the markdown outline
+     * @param parentDirs Directories that each receive a copy of the stem
+     * @param pool Worker pool used for the replication
+     * @param result Receives the run summary
+     * @return bool True if every parent was provisioned or skipped without errors
+     */
+    bool run(const std::string &markdownPath, const std::vector<fs::path> &parentDirs, ThreadPool &pool,
+             Result &result);
+
+private:
+    /**
+     * @brief Builds a hidden prototype directory name unique to this process
+     *
+     * @param parentDir Parent next to whose stem the prototype is built
+     * @return fs::path Path of the prototype directory
+     */
+    static fs::path makePrototypePath(const fs::path &parentDir);
+
+    size_t creatorCount;        // Directory creation workers for the prototype
+    size_t templateWorkerCount; // Template workers for the prototype
+};
+
+#endif // PROTOTYPE_FAN_OUT_H
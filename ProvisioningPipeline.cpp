@@ -0,0 +1,452 @@
+#include "ProvisioningPipeline.h"
+#include "BoundedQueue.h"
+#include "MarkdownOutlineReader.h"
+#include "DirectoryCreator.h"
+#include "TemplateFiles.h"
+#include "FileSystemBackend.h"
+#include "StemLock.h"
+#include "ThreadPool.h"
+#include "AsyncFileSystem.h"
+#include "ErrorLog.h"
+#include "StemLayout.h"
+#include "Jobserver.h"
+#include "AllocationStats.h"
+#include "RunJournal.h"
+#include "NinjaBuildFile.h"
+#include <iostream>
+#include <atomic>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Work item passed from the parser to the creators
+    struct NamedEntry
+    {
+        size_t number;    // One-based position in the outline
+        std::string name; // Raw subdirectory name
+    };
+
+    // Directory handed from the creators to the template workers
+    struct OpenedDirectory
+    {
+        size_t number = 0;                      // One-based position in the outline
+        std::uint32_t nameHash = 0;             // Journal hash of the path relative to the stem
+        FileSystemBackend::DirectoryHandle dir; // Open lesson directory
+    };
+
+    // Counters shared by the coroutines of one runCoroutines() call
+    struct CoroutineProgress
+    {
+        std::chrono::steady_clock::time_point start; // Start of the run
+        std::atomic<size_t> directoriesCreated{0};   // Directories that did not exist before
+        std::atomic<size_t> directoriesFailed{0};    // Directories that could not be created
+        std::atomic<size_t> templatedDirectories{0}; // Directories that received all templates
+        std::atomic<size_t> templateFailures{0};     // Directories with a failed template
+        std::atomic<bool> firstFileWritten{false};   // Set by the first templated directory
+        std::atomic<long long> timeToFirstFile{0};   // Microseconds until the first templated directory
+    };
+
+    // Creates one subdirectory and writes its templates, one awaited operation at a time
+    AsyncFileSystem::Task provisionDirectory(AsyncFileSystem &io, fs::path subDir,
+                                             const std::vector<TemplateFiles::TemplateFile> &files,
+                                             CoroutineProgress &progress)
+    {
+        AsyncFileSystem::CreateResult lesson = co_await io.createDirectory(subDir);
+        if (lesson.error)
+        {
+            progress.directoriesFailed++;
+            ErrorLog::record("create directory", lesson.error, subDir.parent_path(), subDir.filename());
+            co_return;
+        }
+        if (lesson.created)
+        {
+            progress.directoriesCreated++;
+        }
+
+        std::string lastSubdirectory;
+        for (const auto &file : files)
+        {
+            if (!file.subdirectory.empty() && file.subdirectory != lastSubdirectory)
+            {
+                AsyncFileSystem::CreateResult nested = co_await io.createDirectory(subDir / file.subdirectory);
+                if (nested.error)
+                {
+                    progress.templateFailures++;
+                    ErrorLog::record("create directory", nested.error, subDir, file.subdirectory);
+                    co_return;
+                }
+                lastSubdirectory = file.subdirectory;
+            }
+            std::error_code ec = co_await io.writeFile(subDir / file.subdirectory / file.filename, file.content);
+            if (ec)
+            {
+                progress.templateFailures++;
+                ErrorLog::record("write file", ec, subDir, fs::path(file.subdirectory) / file.filename);
+                co_return;
+            }
+        }
+
+        progress.templatedDirectories++;
+        if (!progress.firstFileWritten.exchange(true))
+        {
+            progress.timeToFirstFile = std::chrono::duration_cast<std::chrono::microseconds>(
+                                           std::chrono::steady_clock::now() - progress.start)
+                                           .count();
+        }
+    }
+
+    // Chooses the layout of the stem; for a new stem, reads up to fan-out + 1 names ahead to see whether to shard
+    bool prepareLayout(MarkdownOutlineReader &reader, bool newStem, StemLayout &layout,
+                       std::vector<std::string> &pendingNames)
+    {
+        if (layout.load() || !newStem || StemLayout::getDefaultFanOut() == 0)
+        {
+            return true;
+        }
+
+        AllocationStats::Scope phase(AllocationStats::PHASE_PARSE);
+        std::string name;
+        while (pendingNames.size() <= StemLayout::getDefaultFanOut() && reader.next(name))
+        {
+            pendingNames.push_back(std::move(name));
+        }
+        if (StemLayout::shouldShard(pendingNames.size()))
+        {
+            return layout.enableSharding(StemLayout::getDefaultFanOut());
+        }
+        return true;
+    }
+}
+
+ProvisioningPipeline::ProvisioningPipeline(size_t creatorCount, size_t templateWorkerCount, size_t queueCapacity)
+    : creatorCount(creatorCount == 0 ? 1 : creatorCount), templateWorkerCount(templateWorkerCount),
+      queueCapacity(queueCapacity), resume(false), buildFile(false)
+{
+}
+
+void ProvisioningPipeline::setResume(bool resume)
+{
+    this->resume = resume;
+}
+
+void ProvisioningPipeline::setBuildFile(bool enabled)
+{
+    buildFile = enabled;
+}
+
+bool ProvisioningPipeline::run(const std::string &markdownPath, const fs::path &parentDir, Result &result)
+{
+    auto start = std::chrono::steady_clock::now();
+    result = Result();
+
+    MarkdownOutlineReader reader;
+    if (!reader.open(markdownPath))
+    {
+        return false;
+    }
+    if (reader.getStemName().empty())
+    {
+        std::cerr << "Error: No stem directory name found in " << markdownPath << std::endl;
+        return false;
+    }
+
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    fs::path stemDir = parentDir / reader.getStemName();
+    if (resume && !backend.status(stemDir / RunJournal::JOURNAL_FILE_NAME).exists)
+    {
+        std::cerr << "Error: No journal to resume in " << stemDir.string() << std::endl;
+        return false;
+    }
+    bool newStem = false;
+    try
+    {
+        newStem = backend.createDirectory(stemDir);
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Error creating stem directory: " << e.what() << std::endl;
+        return false;
+    }
+    StemLock stemLock(stemDir);
+
+    StemLayout layout(stemDir);
+    std::vector<std::string> pendingNames;
+    if (!prepareLayout(reader, newStem, layout, pendingNames))
+    {
+        return false;
+    }
+
+    // Record what this run does; a resumed run continues the interrupted run's journal
+    RunJournal journal(stemDir);
+    if (resume && !journal.load())
+    {
+        return false;
+    }
+    if (backend.isOnDisk() && !journal.open(resume))
+    {
+        return false;
+    }
+    if (newStem)
+    {
+        journal.record(RunJournal::OP_STEM_CREATED, 0, 0);
+    }
+
+    BoundedQueue<NamedEntry> nameQueue(queueCapacity);
+    BoundedQueue<OpenedDirectory> directoryQueue(queueCapacity);
+
+    std::atomic<size_t> directoriesCreated{0};
+    std::atomic<size_t> directoriesFailed{0};
+    std::atomic<size_t> templatedDirectories{0};
+    std::atomic<size_t> templateFailures{0};
+    // Stage workers run for the whole pipeline and wait on each other, so they all need a job slot
+    // at once; under a make jobserver, shrink the stages to the slots make can spare. The parse
+    // stage runs on this thread and uses the process's implicit slot, so every worker takes a token.
+    size_t creators = creatorCount;
+    size_t templateWorkers = templateWorkerCount;
+    Jobserver::Reservation reservation(creators + templateWorkers, 1);
+    size_t slots = reservation.size();
+    bool inlineTemplates = false;
+    if (slots < creators + templateWorkers)
+    {
+        // With a single slot, the one worker writes the templates itself instead of handing them on
+        inlineTemplates = templateWorkers > 0 && slots < 2;
+        creators = templateWorkers > 0 && !inlineTemplates ? std::max<size_t>(1, slots / 4) : slots;
+        templateWorkers = templateWorkers > 0 && !inlineTemplates ? slots - creators : 0;
+    }
+
+    result.creators = creators;
+    result.templateWorkers = templateWorkers;
+
+    std::atomic<size_t> activeCreators{creators};
+    std::atomic<bool> firstFileWritten{false};
+    std::atomic<long long> timeToFirstFile{0};
+
+    // Writes the templates of one open directory, in a template worker or inline in the creator
+    auto templateDirectory = [&](OpenedDirectory &opened)
+    {
+        if (TemplateFiles::createTemplateFilesIn(opened.dir))
+        {
+            templatedDirectories++;
+            journal.record(RunJournal::OP_TEMPLATED, opened.number, opened.nameHash);
+            if (!firstFileWritten.exchange(true))
+            {
+                timeToFirstFile = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count();
+            }
+        }
+        else
+        {
+            templateFailures++;
+        }
+        opened.dir = FileSystemBackend::DirectoryHandle(); // Close the descriptor promptly
+    };
+
+    ThreadPool pool(creators + templateWorkers, false);
+
+    // Stage 2: create and open directories, handing the open directory on
+    for (size_t c = 0; c < creators; ++c)
+    {
+        pool.submit([&]
+                    {
+            AllocationStats::Scope phase(AllocationStats::PHASE_CREATE);
+            NamedEntry entry;
+            while (nameQueue.pop(entry))
+            {
+                fs::path relativePath =
+                    layout.getRelativePath(entry.number, DirectoryCreator::formatSubdirectoryName(entry.number, entry.name));
+                std::error_code ec;
+                bool created = false;
+                FileSystemBackend::DirectoryHandle dir = backend.createAndOpenDirectory(stemDir / relativePath, created, ec);
+                if (ec)
+                {
+                    directoriesFailed++;
+                    ErrorLog::record("create directory", ec, stemDir, relativePath);
+                    continue;
+                }
+                if (created)
+                {
+                    directoriesCreated++;
+                }
+                std::uint32_t nameHash = RunJournal::hashName(relativePath);
+                journal.record(created ? RunJournal::OP_DIRECTORY_CREATED : RunJournal::OP_DIRECTORY_EXISTED,
+                               entry.number, nameHash);
+                if (inlineTemplates)
+                {
+                    AllocationStats::Scope templatePhase(AllocationStats::PHASE_TEMPLATE);
+                    OpenedDirectory opened{entry.number, nameHash, std::move(dir)};
+                    templateDirectory(opened);
+                }
+                else if (templateWorkers > 0)
+                {
+                    directoryQueue.push({entry.number, nameHash, std::move(dir)});
+                }
+            }
+
+            // The last creator to finish tells the template workers no more work is coming
+            if (activeCreators.fetch_sub(1) == 1)
+            {
+                directoryQueue.close();
+            } });
+    }
+
+    // Stage 3: write templates through the open directory descriptors
+    for (size_t t = 0; t < templateWorkers; ++t)
+    {
+        pool.submit([&]
+                    {
+            AllocationStats::Scope phase(AllocationStats::PHASE_TEMPLATE);
+            OpenedDirectory opened;
+            while (directoryQueue.pop(opened))
+            {
+                templateDirectory(opened);
+            } });
+    }
+
+    // Stage 1: stream names out of the outline on this thread, starting with any read ahead
+    std::vector<std::string> lessonPaths;
+    {
+        AllocationStats::Scope phase(AllocationStats::PHASE_PARSE);
+        auto pushEntry = [&](std::string &entryName)
+        {
+            result.entries++;
+            if (resume || buildFile)
+            {
+                fs::path relativePath = layout.getRelativePath(
+                    result.entries, DirectoryCreator::formatSubdirectoryName(result.entries, entryName));
+                if (buildFile)
+                {
+                    lessonPaths.push_back(relativePath.generic_string());
+                }
+
+                // Lessons finished by the interrupted run are skipped without touching the filesystem
+                if (resume && journal.isTemplated(result.entries, RunJournal::hashName(relativePath)))
+                {
+                    result.directoriesSkipped++;
+                    return;
+                }
+            }
+            nameQueue.push({result.entries, std::move(entryName)});
+        };
+        for (auto &pendingName : pendingNames)
+        {
+            pushEntry(pendingName);
+        }
+        std::string name;
+        while (reader.next(name))
+        {
+            pushEntry(name);
+        }
+        nameQueue.close();
+    }
+    pool.wait();
+
+    result.directoriesCreated = directoriesCreated;
+    result.directoriesFailed = directoriesFailed;
+    result.templatedDirectories = templatedDirectories;
+    result.templateFailures = templateFailures;
+    result.timeToFirstFile = std::chrono::microseconds(timeToFirstFile.load());
+    result.totalTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    // Written while the stem is still locked, so concurrent runs never interleave it
+    if (buildFile)
+    {
+        result.buildFileWritten = NinjaBuildFile(stemDir).write(lessonPaths);
+    }
+
+    if (result.directoriesFailed == 0 && result.templateFailures == 0)
+    {
+        journal.record(RunJournal::OP_RUN_COMPLETE, 0, 0);
+    }
+
+    ErrorLog::printSummary();
+    return result.directoriesFailed == 0 && result.templateFailures == 0 && (!buildFile || result.buildFileWritten);
+}
+
+bool ProvisioningPipeline::runCoroutines(const std::string &markdownPath, const fs::path &parentDir, Result &result)
+{
+    CoroutineProgress progress;
+    progress.start = std::chrono::steady_clock::now();
+    result = Result();
+
+    MarkdownOutlineReader reader;
+    if (!reader.open(markdownPath))
+    {
+        return false;
+    }
+    if (reader.getStemName().empty())
+    {
+        std::cerr << "Error: No stem directory name found in " << markdownPath << std::endl;
+        return false;
+    }
+
+    fs::path stemDir = parentDir / reader.getStemName();
+    bool newStem = false;
+    try
+    {
+        newStem = FileSystemBackend::getActive().createDirectory(stemDir);
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Error creating stem directory: " << e.what() << std::endl;
+        return false;
+    }
+    StemLock stemLock(stemDir);
+
+    StemLayout layout(stemDir);
+    std::vector<std::string> pendingNames;
+    if (!prepareLayout(reader, newStem, layout, pendingNames))
+    {
+        return false;
+    }
+
+    // Template payloads are fetched once; every coroutine writes from the same strings
+    const std::vector<TemplateFiles::TemplateFile> files =
+        templateWorkerCount > 0 ? TemplateFiles::getAllTemplateFiles() : std::vector<TemplateFiles::TemplateFile>();
+
+    std::vector<std::string> lessonPaths;
+    {
+        AsyncFileSystem io(creatorCount + templateWorkerCount, queueCapacity);
+        auto spawnEntry = [&](const std::string &entryName)
+        {
+            result.entries++;
+            fs::path relativePath =
+                layout.getRelativePath(result.entries, DirectoryCreator::formatSubdirectoryName(result.entries, entryName));
+            if (buildFile)
+            {
+                lessonPaths.push_back(relativePath.generic_string());
+            }
+            io.spawn(provisionDirectory(io, stemDir / relativePath, files, progress));
+        };
+        for (const auto &pendingName : pendingNames)
+        {
+            spawnEntry(pendingName);
+        }
+        std::string name;
+        while (reader.next(name))
+        {
+            spawnEntry(name);
+        }
+        io.wait();
+    }
+
+    result.directoriesCreated = progress.directoriesCreated;
+    result.directoriesFailed = progress.directoriesFailed;
+    result.templatedDirectories = templateWorkerCount > 0 ? progress.templatedDirectories.load() : 0;
+    result.creators = creatorCount;
+    result.templateWorkers = templateWorkerCount;
+    result.templateFailures = progress.templateFailures;
+    result.timeToFirstFile = std::chrono::microseconds(progress.timeToFirstFile.load());
+    result.totalTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - progress.start);
+
+    if (buildFile)
+    {
+        result.buildFileWritten = NinjaBuildFile(stemDir).write(lessonPaths);
+    }
+
+    ErrorLog::printSummary();
+    return result.directoriesFailed == 0 && result.templateFailures == 0 && (!buildFile || result.buildFileWritten);
+}
@@ -0,0 +1,105 @@
+#ifndef PROVISIONING_PIPELINE_H
+#define PROVISIONING_PIPELINE_H
+
+#include <string>
+#include <filesystem>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Creates and templates a stem from an outline in overlapping stages
+ *
+ * ProvisioningPipeline runs three stages connected by bounded queues: the
+ * calling thread streams subdirectory names out of the outline, creator
+ * workers make and open each directory, and template workers write the
+ * template files through the already open directory. The stem is never
+ * re-scanned, the first files land as soon as the first outline entry has
+ * been read, and the total time approaches that of the slowest stage.
+ *
+ * runCoroutines() is the alternative for high-latency filesystems: each
+ * subdirectory is one coroutine on an AsyncFileSystem executor, so many more
+ * directories can be in flight than there are threads.
+ */
+class ProvisioningPipeline
+{
+public:
+    /**
+     * @brief Structure summarizing a pipeline run
+     */
+    struct Result
+    {
+        size_t entries = 0;                             // Outline entries read
+        size_t directoriesCreated = 0;                  // Directories that did not exist before
+        size_t directoriesFailed = 0;                   // Directories that could not be created or opened
+        size_t templatedDirectories = 0;                // Directories that received all templates
+        size_t templateFailures = 0;                    // Directories with at least one failed template
+        size_t directoriesSkipped = 0;                  // Directories the journal marks as done (resume only)
+        size_t creators = 0;                            // Create workers that ran, after jobserver limits
+        size_t templateWorkers = 0;                     // Template workers that ran, after jobserver limits
+        bool buildFileWritten = false;                  // build.ninja was written (setBuildFile only)
+        std::chrono::microseconds timeToFirstFile{0};   // Start until the first directory was templated
+        std::chrono::microseconds totalTime{0};         // Start until every stage finished
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param creatorCount Number of directory creation workers
+     * @param templateWorkerCount Number of template workers (0 skips templating)
+     * @param queueCapacity Capacity of each queue between stages
+     */
+    ProvisioningPipeline(size_t creatorCount, size_t templateWorkerCount, size_t queueCapacity);
+
+    /**
+     * @brief Makes run() continue the journal of an interrupted run
+     *
+     * Lessons the journal marks as templated are skipped without touching
+     * the filesystem; everything else is provisioned again.
+     *
+     * @param resume True to continue the stem's journal instead of starting a new one
+     */
+    void setResume(bool resume);
+
+    /**
+     * @brief Makes both runs write a NinjaBuildFile for the outline's lessons into the stem
+     *
+     * @param enabled True to write build.ninja once every lesson was provisioned
+     */
+    void setBuildFile(bool enabled);
+
+    /**
+     * @brief Provisions the stem described by an outline
+     *
+     * On disk, every created directory and completed template set is
+     * recorded in the stem's RunJournal.
+     *
+     * @param markdownPath Path to the markdown outline
+     * @param parentDir Directory in which the stem directory is created
+     * @param result Receives the run summary
+     * @return bool True if the outline was read and every operation succeeded
+     */
+    bool run(const std::string &markdownPath, const fs::path &parentDir, Result &result);
+
+    /**
+     * @brief Provisions the stem with one coroutine per subdirectory
+     *
+     * The worker counts given to the constructor are added up to size the
+     * I/O pool; queueCapacity bounds the number of coroutines in flight.
+     *
+     * @param markdownPath Path to the markdown outline
+     * @param parentDir Directory in which the stem directory is created
+     * @param result Receives the run summary
+     * @return bool True if the outline was read and every operation succeeded
+     */
+    bool runCoroutines(const std::string &markdownPath, const fs::path &parentDir, Result &result);
+
+private:
+    size_t creatorCount;        // Directory creation workers
+    size_t templateWorkerCount; // Template workers
+    size_t queueCapacity;       // Capacity of each queue
+    bool resume;                // Continue the stem's journal in run()
+    bool buildFile;             // Write build.ninja at the stem
+};
+
+#endif // PROVISIONING_PIPELINE_H
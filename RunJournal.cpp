@@ -0,0 +1,354 @@
+#include "RunJournal.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <iterator>
+
+#ifdef _WIN32
+#include <cstdio>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Header: magic, record size and padding to one record
+    constexpr char MAGIC[8] = {'D', 'T', 'J', 'R', 'N', 'L', '0', '1'};
+    constexpr size_t HEADER_SIZE = 16;
+    constexpr size_t RECORD_SIZE = 16;
+
+    // Record slots reserved up front; the file doubles when they run out
+    constexpr size_t INITIAL_CAPACITY = 65536;
+
+    // On-disk record; every field is written in host byte order
+    struct Record
+    {
+        std::uint32_t number;      // Outline number (0 for the stem)
+        std::uint32_t nameHash;    // Hash of the lesson's relative path
+        std::uint8_t operation;    // RunJournal::Operation
+        std::uint8_t reserved[3];  // Zero
+        std::uint32_t checksum;    // FNV-1a of the first 12 bytes
+    };
+    static_assert(sizeof(Record) == RECORD_SIZE, "journal records must be 16 bytes");
+
+    std::uint32_t fnv1a(const void *data, size_t size)
+    {
+        std::uint32_t hash = 2166136261u;
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    Record makeRecord(RunJournal::Operation operation, size_t number, std::uint32_t nameHash)
+    {
+        Record record{};
+        record.number = static_cast<std::uint32_t>(number);
+        record.nameHash = nameHash;
+        record.operation = operation;
+        record.checksum = fnv1a(&record, offsetof(Record, checksum));
+        return record;
+    }
+
+    // Decodes one slot; an unused or torn slot is invalid
+    bool decodeRecord(const char *bytes, Record &record)
+    {
+        std::memcpy(&record, bytes, RECORD_SIZE);
+        return record.operation != RunJournal::OP_NONE && record.operation <= RunJournal::OP_RUN_COMPLETE &&
+               record.checksum == fnv1a(&record, offsetof(Record, checksum));
+    }
+}
+
+RunJournal::RunJournal(const fs::path &stemDir)
+    : journalPath(stemDir / JOURNAL_FILE_NAME), stemCreated(false), complete(false), recordCount(0), capacity(0),
+#ifdef _WIN32
+      file(nullptr)
+#else
+      fd(-1), mapping(nullptr)
+#endif
+{
+}
+
+RunJournal::~RunJournal()
+{
+    close();
+}
+
+bool RunJournal::load()
+{
+    lessons.clear();
+    stemCreated = false;
+    complete = false;
+    recordCount = 0;
+
+    std::ifstream in(journalPath, std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (contents.size() < HEADER_SIZE || std::memcmp(contents.data(), MAGIC, sizeof(MAGIC)) != 0)
+    {
+        std::cerr << "Warning: Ignoring unreadable journal " << journalPath.string() << std::endl;
+        return false;
+    }
+
+    Record record;
+    for (size_t offset = HEADER_SIZE; offset + RECORD_SIZE <= contents.size(); offset += RECORD_SIZE)
+    {
+        if (!decodeRecord(contents.data() + offset, record))
+        {
+            break;
+        }
+        apply(static_cast<Operation>(record.operation), record.number, record.nameHash);
+        recordCount++;
+    }
+    return true;
+}
+
+bool RunJournal::open(bool keepRecords)
+{
+    close();
+    if (!keepRecords)
+    {
+        recordCount = 0;
+    }
+    capacity = recordCount + INITIAL_CAPACITY;
+
+#ifdef _WIN32
+    std::FILE *stream = std::fopen(journalPath.string().c_str(), keepRecords ? "r+b" : "w+b");
+    if (stream == nullptr && keepRecords)
+    {
+        stream = std::fopen(journalPath.string().c_str(), "w+b");
+        recordCount = 0;
+    }
+    if (stream == nullptr)
+    {
+        std::cerr << "Error: Could not open journal " << journalPath.string() << std::endl;
+        return false;
+    }
+    char header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    header[8] = static_cast<char>(RECORD_SIZE);
+    std::fwrite(header, 1, HEADER_SIZE, stream);
+    std::fseek(stream, static_cast<long>(HEADER_SIZE + recordCount * RECORD_SIZE), SEEK_SET);
+    file = stream;
+    return true;
+#else
+    fd = ::open(journalPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Error: Could not open journal " << journalPath.string() << ": " << std::strerror(errno)
+                  << std::endl;
+        return false;
+    }
+
+    // Cut off everything after the kept records, including a torn last record, then reserve zeroed slots
+    size_t size = HEADER_SIZE + capacity * RECORD_SIZE;
+    if (::ftruncate(fd, static_cast<off_t>(HEADER_SIZE + recordCount * RECORD_SIZE)) != 0 ||
+        ::ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        std::cerr << "Error: Could not size journal " << journalPath.string() << ": " << std::strerror(errno)
+                  << std::endl;
+        close();
+        return false;
+    }
+    void *mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map journal " << journalPath.string() << ": " << std::strerror(errno)
+                  << std::endl;
+        close();
+        return false;
+    }
+    mapping = static_cast<unsigned char *>(mapped);
+    std::memcpy(mapping, MAGIC, sizeof(MAGIC));
+    mapping[8] = static_cast<unsigned char>(RECORD_SIZE);
+    return true;
+#endif
+}
+
+void RunJournal::record(Operation operation, size_t number, std::uint32_t nameHash)
+{
+    Record record = makeRecord(operation, number, nameHash);
+    bool flushNow = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!isOpen() || (recordCount == capacity && !grow()))
+        {
+            return;
+        }
+#ifdef _WIN32
+        pending.append(reinterpret_cast<const char *>(&record), RECORD_SIZE);
+        recordCount++;
+        if (recordCount % FLUSH_INTERVAL == 0)
+        {
+            std::FILE *stream = static_cast<std::FILE *>(file);
+            std::fwrite(pending.data(), 1, pending.size(), stream);
+            std::fflush(stream);
+            pending.clear();
+        }
+#else
+        std::memcpy(mapping + HEADER_SIZE + recordCount * RECORD_SIZE, &record, RECORD_SIZE);
+        recordCount++;
+        flushNow = recordCount % FLUSH_INTERVAL == 0;
+#endif
+    }
+
+#ifndef _WIN32
+    // The records are already in the page cache; the sync only protects against power loss
+    if (flushNow)
+    {
+        ::fdatasync(fd);
+    }
+#else
+    (void)flushNow;
+#endif
+}
+
+void RunJournal::close()
+{
+#ifdef _WIN32
+    if (file != nullptr)
+    {
+        std::FILE *stream = static_cast<std::FILE *>(file);
+        std::fwrite(pending.data(), 1, pending.size(), stream);
+        std::fclose(stream);
+        pending.clear();
+        file = nullptr;
+    }
+#else
+    if (mapping != nullptr)
+    {
+        ::munmap(mapping, HEADER_SIZE + capacity * RECORD_SIZE);
+        mapping = nullptr;
+    }
+    if (fd >= 0)
+    {
+        // Drop the unused slots so the file holds exactly the records written
+        if (::ftruncate(fd, static_cast<off_t>(HEADER_SIZE + recordCount * RECORD_SIZE)) == 0)
+        {
+            ::fdatasync(fd);
+        }
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+bool RunJournal::isOpen() const
+{
+#ifdef _WIN32
+    return file != nullptr;
+#else
+    return mapping != nullptr;
+#endif
+}
+
+bool RunJournal::isTemplated(size_t number, std::uint32_t nameHash) const
+{
+    return number < lessons.size() && lessons[number].nameHash == nameHash && lessons[number].templated;
+}
+
+bool RunJournal::wasCreated(size_t number, std::uint32_t nameHash) const
+{
+    return number < lessons.size() && lessons[number].nameHash == nameHash && lessons[number].created;
+}
+
+bool RunJournal::wasStemCreated() const
+{
+    return stemCreated;
+}
+
+bool RunJournal::isComplete() const
+{
+    return complete;
+}
+
+size_t RunJournal::getRecordCount() const
+{
+    return recordCount;
+}
+
+std::uint32_t RunJournal::hashName(const fs::path &relativePath)
+{
+    std::string name = relativePath.generic_string();
+    return fnv1a(name.data(), name.size());
+}
+
+void RunJournal::remove(const fs::path &stemDir)
+{
+    std::error_code ec;
+    fs::remove(stemDir / JOURNAL_FILE_NAME, ec);
+}
+
+void RunJournal::apply(Operation operation, size_t number, std::uint32_t nameHash)
+{
+    complete = operation == OP_RUN_COMPLETE;
+    if (operation == OP_STEM_CREATED)
+    {
+        stemCreated = true;
+        return;
+    }
+    if (operation == OP_RUN_COMPLETE)
+    {
+        return;
+    }
+
+    if (number >= lessons.size())
+    {
+        lessons.resize(number + 1);
+    }
+
+    // A different path under the same number means the outline changed; start over for that lesson
+    LessonState &lesson = lessons[number];
+    if (lesson.nameHash != nameHash)
+    {
+        lesson = LessonState();
+        lesson.nameHash = nameHash;
+    }
+    if (operation == OP_DIRECTORY_CREATED)
+    {
+        lesson.created = true;
+    }
+    else if (operation == OP_TEMPLATED)
+    {
+        lesson.templated = true;
+    }
+}
+
+bool RunJournal::grow()
+{
+#ifdef _WIN32
+    capacity *= 2;
+    return true;
+#else
+    // The mapping is replaced while the mutex keeps every writer out
+    size_t oldSize = HEADER_SIZE + capacity * RECORD_SIZE;
+    size_t newSize = HEADER_SIZE + capacity * 2 * RECORD_SIZE;
+    ::munmap(mapping, oldSize);
+    mapping = nullptr;
+    void *mapped = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(newSize)) == 0)
+    {
+        mapped = ::mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (mapped == MAP_FAILED)
+    {
+        // Later records are dropped; the ones written so far stay valid
+        std::cerr << "Error: Could not grow journal " << journalPath.string() << ": " << std::strerror(errno)
+                  << std::endl;
+        return false;
+    }
+    mapping = static_cast<unsigned char *>(mapped);
+    capacity *= 2;
+    return true;
+#endif
+}
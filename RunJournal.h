@@ -0,0 +1,188 @@
+#ifndef RUN_JOURNAL_H
+#define RUN_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Append-only journal of what a provisioning run did to a stem
+ *
+ * RunJournal keeps a binary file in the stem made of a short header and
+ * fixed 16-byte records, one per completed operation: the stem or a lesson
+ * directory was created, a lesson directory already existed, or a lesson
+ * received all its templates. Records name a lesson by its outline number
+ * and a hash of its relative path, so a journal only applies to the outline
+ * it was written for. Records are appended with a single copy into a shared
+ * mapping of the file, so they survive the process being killed; the file is
+ * synced to disk every FLUSH_INTERVAL records and when the journal closes.
+ * A record that was only partly written fails its checksum and ends the
+ * journal. On Windows, records are buffered and written in the same batches.
+ *
+ * `create --resume` loads the journal and skips lessons that were templated.
+ * `create --rollback` removes exactly the lesson directories, and the stem,
+ * that the journal says were created.
+ */
+class RunJournal
+{
+public:
+    /**
+     * @brief Operations recorded in the journal
+     */
+    enum Operation : std::uint8_t
+    {
+        OP_NONE = 0,              // Unused slot; ends the journal
+        OP_STEM_CREATED = 1,      // The run created the stem directory
+        OP_DIRECTORY_CREATED = 2, // The run created a lesson directory
+        OP_DIRECTORY_EXISTED = 3, // A lesson directory was already there
+        OP_TEMPLATED = 4,         // A lesson received all its template files
+        OP_RUN_COMPLETE = 5       // The run finished without failures
+    };
+
+    // Name of the journal file inside the stem directory
+    static constexpr const char *JOURNAL_FILE_NAME = ".dirtemplate.journal";
+
+    // Records between syncs to disk
+    static constexpr size_t FLUSH_INTERVAL = 4096;
+
+    /**
+     * @brief Constructor
+     *
+     * @param stemDir Stem directory the journal belongs to
+     */
+    explicit RunJournal(const fs::path &stemDir);
+
+    /**
+     * @brief Destructor closes the journal, syncing it first
+     */
+    ~RunJournal();
+
+    RunJournal(const RunJournal &) = delete;
+    RunJournal &operator=(const RunJournal &) = delete;
+
+    /**
+     * @brief Reads an existing journal
+     *
+     * @return bool True if a journal with a valid header was found
+     */
+    bool load();
+
+    /**
+     * @brief Opens the journal for appending
+     *
+     * @param keepRecords True to continue after the loaded records, false to start a new journal
+     * @return bool True if the journal can be written
+     */
+    bool open(bool keepRecords);
+
+    /**
+     * @brief Appends a record; safe to call from several threads
+     *
+     * @param operation Operation that completed
+     * @param number Outline number of the lesson (0 for the stem)
+     * @param nameHash Hash of the lesson's path relative to the stem
+     */
+    void record(Operation operation, size_t number, std::uint32_t nameHash);
+
+    /**
+     * @brief Syncs the journal and closes it
+     */
+    void close();
+
+    /**
+     * @brief Checks whether the journal is open for appending
+     *
+     * @return bool True if records are being written
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Checks whether a loaded journal says a lesson received all its templates
+     *
+     * @param number Outline number of the lesson
+     * @param nameHash Hash of the lesson's relative path
+     * @return bool True if the lesson can be skipped
+     */
+    bool isTemplated(size_t number, std::uint32_t nameHash) const;
+
+    /**
+     * @brief Checks whether a loaded journal says the run created a lesson directory
+     *
+     * @param number Outline number of the lesson
+     * @param nameHash Hash of the lesson's relative path
+     * @return bool True if rolling back must remove the lesson
+     */
+    bool wasCreated(size_t number, std::uint32_t nameHash) const;
+
+    /**
+     * @brief Checks whether a loaded journal says the run created the stem
+     *
+     * @return bool True if rolling back may remove the stem
+     */
+    bool wasStemCreated() const;
+
+    /**
+     * @brief Checks whether a loaded journal ends with a completed run
+     *
+     * @return bool True if the last run recorded OP_RUN_COMPLETE
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief Gets the number of records loaded or written
+     *
+     * @return size_t Record count
+     */
+    size_t getRecordCount() const;
+
+    /**
+     * @brief Hashes a lesson path as stored in the records
+     *
+     * @param relativePath Lesson path relative to the stem, e.g. "01 - Intro" or "000000-000999/01 - Intro"
+     * @return std::uint32_t 32-bit FNV-1a hash of the generic path string
+     */
+    static std::uint32_t hashName(const fs::path &relativePath);
+
+    /**
+     * @brief Deletes the journal file of a stem
+     *
+     * @param stemDir Stem directory
+     */
+    static void remove(const fs::path &stemDir);
+
+private:
+    // What a loaded journal says about one lesson
+    struct LessonState
+    {
+        std::uint32_t nameHash = 0; // Hash from the latest record
+        bool created = false;       // A run created the directory
+        bool templated = false;     // A run wrote all its templates
+    };
+
+    // Applies one loaded record
+    void apply(Operation operation, size_t number, std::uint32_t nameHash);
+
+    // Makes room for more records in the mapping (mutex held)
+    bool grow();
+
+    fs::path journalPath;             // Journal file
+    std::vector<LessonState> lessons; // Loaded lesson states, indexed by outline number
+    bool stemCreated;                 // Loaded OP_STEM_CREATED
+    bool complete;                    // Loaded journal ends with OP_RUN_COMPLETE
+    size_t recordCount;               // Records loaded or written
+    size_t capacity;                  // Record slots in the file
+    std::mutex mutex;                 // Serializes appends
+#ifdef _WIN32
+    std::string pending;              // Records not yet written
+    void *file;                       // FILE* of the journal
+#else
+    int fd;                           // Journal file descriptor
+    unsigned char *mapping;           // Shared mapping of the whole file
+#endif
+};
+
+#endif // RUN_JOURNAL_H
@@ -0,0 +1,358 @@
+#include "SourceTreeCopier.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <mutex>
+#include <system_error>
+
+#ifdef _WIN32
+#include <chrono>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Serializes error output from worker threads
+    std::mutex outputMutex;
+
+#ifndef _WIN32
+    // Throws a filesystem_error built from the current errno
+    [[noreturn]] void throwErrno(const char *what, const fs::path &path)
+    {
+        throw fs::filesystem_error(what, path, std::error_code(errno, std::generic_category()));
+    }
+
+    // Closes a file descriptor when it goes out of scope
+    struct FileDescriptor
+    {
+        int fd;
+        explicit FileDescriptor(int fd) : fd(fd) {}
+        ~FileDescriptor()
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+        FileDescriptor(const FileDescriptor &) = delete;
+        FileDescriptor &operator=(const FileDescriptor &) = delete;
+    };
+
+    // Copies bytes between two descriptors through a user-space buffer (last resort)
+    void copyWithBuffer(int in, int out, off_t offset, off_t size, const fs::path &target)
+    {
+        std::vector<char> buffer(128 * 1024);
+        while (offset < size)
+        {
+            ssize_t bytesRead = ::pread(in, buffer.data(), buffer.size(), offset);
+            if (bytesRead < 0 && errno == EINTR)
+                continue;
+            if (bytesRead <= 0)
+                throwErrno("Could not read source file", target);
+
+            ssize_t done = 0;
+            while (done < bytesRead)
+            {
+                ssize_t written = ::pwrite(out, buffer.data() + done, static_cast<size_t>(bytesRead - done), offset + done);
+                if (written < 0 && errno == EINTR)
+                    continue;
+                if (written < 0)
+                    throwErrno("Could not write file", target);
+                done += written;
+            }
+            offset += bytesRead;
+        }
+    }
+#endif
+}
+
+SourceTreeCopier::SourceTreeCopier(const fs::path &sourceDir) : sourceDir(sourceDir), totalBytes(0)
+{
+}
+
+bool SourceTreeCopier::scan()
+{
+    entries.clear();
+    totalBytes = 0;
+
+    try
+    {
+        for (auto it = fs::recursive_directory_iterator(sourceDir); it != fs::recursive_directory_iterator(); ++it)
+        {
+            const fs::directory_entry &entry = *it;
+            if (entry.is_symlink())
+            {
+                continue;
+            }
+
+            SourceEntry sourceEntry;
+            sourceEntry.relativePath = entry.path().lexically_relative(sourceDir);
+            sourceEntry.isDirectory = entry.is_directory();
+            sourceEntry.size = 0;
+
+#ifdef _WIN32
+            sourceEntry.mode = static_cast<unsigned>(entry.status().permissions()) & 0777;
+            auto mtime = entry.last_write_time().time_since_epoch();
+            sourceEntry.mtimeSeconds = std::chrono::duration_cast<std::chrono::seconds>(mtime).count();
+            sourceEntry.mtimeNanoseconds = 0;
+            if (!sourceEntry.isDirectory)
+            {
+                sourceEntry.size = entry.file_size();
+            }
+#else
+            struct stat st;
+            if (::lstat(entry.path().c_str(), &st) != 0)
+            {
+                throwErrno("Could not stat source entry", entry.path());
+            }
+            if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode))
+            {
+                continue; // Sockets, fifos and devices are not copied
+            }
+            sourceEntry.mode = st.st_mode & 07777;
+            sourceEntry.mtimeSeconds = st.st_mtim.tv_sec;
+            sourceEntry.mtimeNanoseconds = st.st_mtim.tv_nsec;
+            if (!sourceEntry.isDirectory)
+            {
+                sourceEntry.size = static_cast<std::uintmax_t>(st.st_size);
+            }
+#endif
+
+            totalBytes += sourceEntry.size;
+            entries.push_back(std::move(sourceEntry));
+        }
+        return true;
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Error scanning source directory: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+const std::vector<SourceTreeCopier::SourceEntry> &SourceTreeCopier::getEntries() const
+{
+    return entries;
+}
+
+std::uintmax_t SourceTreeCopier::getTotalBytes() const
+{
+    return totalBytes;
+}
+
+SourceTreeCopier::CopyResult SourceTreeCopier::copyTo(const std::vector<fs::path> &destinations, ThreadPool &pool)
+{
+    CopyResult result;
+
+    // Collect indices of files and directories once
+    std::vector<size_t> fileIndices;
+    std::vector<size_t> dirIndices;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        (entries[i].isDirectory ? dirIndices : fileIndices).push_back(i);
+    }
+
+    // Phase 1: create the directory skeleton in every destination
+    std::vector<char> destinationReady(destinations.size(), 0);
+    pool.parallelFor(destinations.size(), [&](size_t d)
+                     {
+        try
+        {
+            for (size_t index : dirIndices)
+            {
+                fs::path target = destinations[d] / entries[index].relativePath;
+                std::error_code ec;
+                fs::create_directory(target, ec);
+                if (ec)
+                {
+                    throw fs::filesystem_error("Could not create directory", target, ec);
+                }
+            }
+            destinationReady[d] = 1;
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cerr << "  Error preparing " << destinations[d].filename().string() << ": " << e.what() << std::endl;
+        } });
+
+    // Phase 2: copy every file into every ready destination
+    std::vector<std::pair<size_t, size_t>> copies;
+    for (size_t d = 0; d < destinations.size(); ++d)
+    {
+        if (!destinationReady[d])
+        {
+            result.destinationsFailed++;
+            continue;
+        }
+        for (size_t index : fileIndices)
+        {
+            copies.emplace_back(d, index);
+        }
+    }
+
+    std::atomic<size_t> filesCopied{0};
+    std::atomic<size_t> filesCloned{0};
+    std::atomic<size_t> filesFailed{0};
+    std::atomic<std::uintmax_t> bytesCopied{0};
+    pool.parallelFor(copies.size(), [&](size_t c)
+                     {
+        const auto &[d, index] = copies[c];
+        try
+        {
+            bool cloned = false;
+            bytesCopied += copyFile(entries[index], destinations[d], cloned);
+            filesCopied++;
+            if (cloned)
+            {
+                filesCloned++;
+            }
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            filesFailed++;
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cerr << "  Error copying file: " << e.what() << std::endl;
+        } });
+
+    // Phase 3: fix directory modes and times, deepest first so parents are not touched again
+    pool.parallelFor(destinations.size(), [&](size_t d)
+                     {
+        if (!destinationReady[d])
+            return;
+        for (auto it = dirIndices.rbegin(); it != dirIndices.rend(); ++it)
+        {
+            const SourceEntry &entry = entries[*it];
+            fs::path target = destinations[d] / entry.relativePath;
+            std::error_code ec;
+            fs::permissions(target, static_cast<fs::perms>(entry.mode), ec);
+            applyModificationTime(entry, target);
+        } });
+
+    result.filesCopied = filesCopied;
+    result.filesCloned = filesCloned;
+    result.filesFailed = filesFailed;
+    result.bytesCopied = bytesCopied;
+    return result;
+}
+
+std::uintmax_t SourceTreeCopier::copyFile(const SourceEntry &entry, const fs::path &destination, bool &cloned) const
+{
+    fs::path source = sourceDir / entry.relativePath;
+    fs::path target = destination / entry.relativePath;
+
+#ifdef _WIN32
+    fs::copy_file(source, target, fs::copy_options::overwrite_existing);
+    std::error_code ec;
+    fs::permissions(target, static_cast<fs::perms>(entry.mode), ec);
+    applyModificationTime(entry, target);
+    return entry.size;
+#else
+    FileDescriptor in(::open(source.c_str(), O_RDONLY | O_CLOEXEC));
+    if (in.fd < 0)
+    {
+        throwErrno("Could not open source file", source);
+    }
+
+    FileDescriptor out(::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, entry.mode & 0777));
+    if (out.fd < 0)
+    {
+        throwErrno("Could not create file", target);
+    }
+
+    off_t size = static_cast<off_t>(entry.size);
+    off_t offset = 0;
+
+#ifdef __linux__
+#ifdef FICLONE
+    // Best: share the source extents outright on btrfs, XFS and other reflink filesystems
+    if (size > 0 && !cloneUnsupported.load(std::memory_order_relaxed))
+    {
+        if (::ioctl(out.fd, FICLONE, in.fd) == 0)
+        {
+            offset = size;
+            cloned = true;
+        }
+        else if (errno == EOPNOTSUPP || errno == ENOTTY || errno == EINVAL || errno == ENOSYS)
+        {
+            cloneUnsupported.store(true, std::memory_order_relaxed);
+        }
+    }
+#endif
+
+    // Preferred otherwise: in-kernel copy, which may also share extents on CoW filesystems
+    while (offset < size)
+    {
+        loff_t inOffset = offset;
+        loff_t outOffset = offset;
+        ssize_t copied = ::copy_file_range(in.fd, &inOffset, out.fd, &outOffset, static_cast<size_t>(size - offset), 0);
+        if (copied < 0 && errno == EINTR)
+            continue;
+        if (copied <= 0)
+            break; // Unsupported here (EXDEV, ENOSYS, EINVAL...) or source shrank
+        offset += copied;
+    }
+
+    // Fallback: sendfile still keeps the data inside the kernel
+    while (offset < size)
+    {
+        off_t inOffset = offset;
+        if (::lseek(out.fd, offset, SEEK_SET) < 0)
+            throwErrno("Could not seek file", target);
+        ssize_t copied = ::sendfile(out.fd, in.fd, &inOffset, static_cast<size_t>(size - offset));
+        if (copied < 0 && errno == EINTR)
+            continue;
+        if (copied <= 0)
+            break;
+        offset += copied;
+    }
+#endif
+
+    // Last resort for kernels or filesystems without either call
+    if (offset < size)
+    {
+        copyWithBuffer(in.fd, out.fd, offset, size, target);
+    }
+
+    // Preserve the exact mode (open() applied the umask) and the modification time
+    if (::fchmod(out.fd, entry.mode) != 0)
+    {
+        throwErrno("Could not set file mode", target);
+    }
+    struct timespec times[2];
+    times[0].tv_sec = 0;
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1].tv_sec = static_cast<time_t>(entry.mtimeSeconds);
+    times[1].tv_nsec = static_cast<long>(entry.mtimeNanoseconds);
+    if (::futimens(out.fd, times) != 0)
+    {
+        throwErrno("Could not set modification time", target);
+    }
+
+    return entry.size;
+#endif
+}
+
+void SourceTreeCopier::applyModificationTime(const SourceEntry &entry, const fs::path &target) const
+{
+#ifdef _WIN32
+    std::error_code ec;
+    fs::last_write_time(target, fs::file_time_type(std::chrono::seconds(entry.mtimeSeconds)), ec);
+#else
+    struct timespec times[2];
+    times[0].tv_sec = 0;
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1].tv_sec = static_cast<time_t>(entry.mtimeSeconds);
+    times[1].tv_nsec = static_cast<long>(entry.mtimeNanoseconds);
+    ::utimensat(AT_FDCWD, target.c_str(), times, 0);
+#endif
+}
@@ -0,0 +1,116 @@
+#ifndef SOURCE_TREE_COPIER_H
+#define SOURCE_TREE_COPIER_H
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <cstdint>
+#include <atomic>
+
+namespace fs = std::filesystem;
+
+class ThreadPool;
+
+/**
+ * @brief Replicates an on-disk starter directory into many destinations
+ *
+ * SourceTreeCopier scans the source tree once and then fans it out to every
+ * destination directory in parallel. On Linux each file is first cloned
+ * with the FICLONE ioctl, which shares extents on btrfs and XFS; elsewhere
+ * data is moved with copy_file_range (falling back to sendfile), so large
+ * files never pass through user-space buffers. Permission bits and modification times are
+ * preserved. Copies always operate on the real filesystem.
+ */
+class SourceTreeCopier
+{
+public:
+    /**
+     * @brief Structure representing one entry of the scanned source tree
+     */
+    struct SourceEntry
+    {
+        fs::path relativePath;         // Path relative to the source root
+        bool isDirectory;              // True for directories
+        unsigned mode;                 // Permission bits
+        std::int64_t mtimeSeconds;     // Modification time, seconds part
+        std::int64_t mtimeNanoseconds; // Modification time, nanoseconds part
+        std::uintmax_t size;           // Size in bytes (files only)
+    };
+
+    /**
+     * @brief Structure summarizing a fan-out run
+     */
+    struct CopyResult
+    {
+        size_t filesCopied = 0;         // Files copied successfully
+        size_t filesCloned = 0;         // Copied files that share extents with the source (reflinks)
+        size_t filesFailed = 0;         // Files that could not be copied
+        size_t destinationsFailed = 0;  // Destinations whose skeleton could not be created
+        std::uintmax_t bytesCopied = 0; // Total payload bytes copied
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param sourceDir Root of the tree to replicate
+     */
+    explicit SourceTreeCopier(const fs::path &sourceDir);
+
+    /**
+     * @brief Scans the source tree
+     *
+     * Hidden entries are included; symbolic links are skipped.
+     *
+     * @return bool True if the source could be scanned
+     */
+    bool scan();
+
+    /**
+     * @brief Gets the scanned entries (directories before their contents)
+     *
+     * @return const std::vector<SourceEntry>& Scanned entries
+     */
+    const std::vector<SourceEntry> &getEntries() const;
+
+    /**
+     * @brief Gets the total size of all scanned files
+     *
+     * @return std::uintmax_t Byte count
+     */
+    std::uintmax_t getTotalBytes() const;
+
+    /**
+     * @brief Copies the scanned tree into every destination directory
+     *
+     * @param destinations Directories that receive a copy of the source contents
+     * @param pool Worker pool used for the copies
+     * @return CopyResult Summary of the run
+     */
+    CopyResult copyTo(const std::vector<fs::path> &destinations, ThreadPool &pool);
+
+private:
+    /**
+     * @brief Copies one file, preserving mode and modification time
+     *
+     * @param entry Source entry to copy
+     * @param destination Destination root
+     * @param cloned Set to true if the file was cloned instead of copied
+     * @return std::uintmax_t Bytes copied
+     */
+    std::uintmax_t copyFile(const SourceEntry &entry, const fs::path &destination, bool &cloned) const;
+
+    /**
+     * @brief Applies the preserved modification time to a path
+     *
+     * @param entry Source entry whose time should be applied
+     * @param target Destination path
+     */
+    void applyModificationTime(const SourceEntry &entry, const fs::path &target) const;
+
+    fs::path sourceDir;                                // Root of the source tree
+    std::vector<SourceEntry> entries;                  // Scanned entries
+    std::uintmax_t totalBytes;                         // Sum of scanned file sizes
+    mutable std::atomic<bool> cloneUnsupported{false}; // Set once cloning is refused, so it is not retried per file
+};
+
+#endif // SOURCE_TREE_COPIER_H
@@ -0,0 +1,352 @@
+#include "StemIndex.h"
+#include "DirectorySynchronizer.h"
+#include "FileSystemBackend.h"
+#include "TemplateFiles.h"
+#include "StemLayout.h"
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <chrono>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // File signature; the last bytes carry the format version
+    constexpr char INDEX_MAGIC[8] = {'D', 'T', 'I', 'D', 'X', 0, 0, 1};
+
+    // Fixed-size header at the start of the index (host byte order; the index is a local cache)
+    struct IndexHeader
+    {
+        char magic[8];             // INDEX_MAGIC
+        std::int64_t stemMtime;    // Stem mtime in nanoseconds when written
+        std::int64_t stemCtime;    // Stem ctime in nanoseconds when written
+        std::uint64_t entryCount;  // Number of entries in the payload
+        std::uint64_t payloadSize; // Bytes following the header
+        std::uint64_t payloadHash; // FNV-1a hash of the payload
+    };
+
+    // Appends a value's bytes to a buffer
+    template <typename T>
+    void appendValue(std::string &buffer, T value)
+    {
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    // Reads a value from a buffer, advancing the offset; false if the buffer is too short
+    template <typename T>
+    bool readValue(const std::string &buffer, size_t &offset, T &value)
+    {
+        if (buffer.size() - offset < sizeof(value))
+            return false;
+        std::memcpy(&value, buffer.data() + offset, sizeof(value));
+        offset += sizeof(value);
+        return true;
+    }
+}
+
+StemIndex::StemIndex(const fs::path &stemDir)
+    : stemDir(stemDir), indexPath(stemDir / INDEX_FILE_NAME), scanMtime(0), scanCtime(0), scanStarted(false)
+{
+}
+
+bool StemIndex::isSupported()
+{
+    return FileSystemBackend::getActive().isOnDisk();
+}
+
+bool StemIndex::load()
+{
+    return read(true);
+}
+
+bool StemIndex::read(bool requireFresh)
+{
+    entries.clear();
+    if (!isSupported())
+        return false;
+
+    // A change in the same timestamp tick as the last write cannot be told apart from none
+    std::int64_t mtime = 0, ctime = 0, newest = 0, written = 0;
+    if (requireFresh && (!readStemStamp(mtime, ctime, newest) || !readIndexTime(written) || newest >= written))
+        return false;
+
+    std::ifstream file(indexPath, std::ios::binary);
+    if (!file)
+        return false;
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Header checks: signature, stamp and a complete, untorn payload
+    IndexHeader header;
+    if (data.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+        (requireFresh && (header.stemMtime != mtime || header.stemCtime != ctime)) || header.payloadSize != data.size() - sizeof(header) ||
+        header.payloadHash != TemplateFiles::hashContent(std::string_view(data).substr(sizeof(header))))
+        return false;
+
+    size_t offset = sizeof(header);
+    entries.reserve(header.entryCount);
+    for (std::uint64_t i = 0; i < header.entryCount; ++i)
+    {
+        Entry entry;
+        std::uint16_t nameLength = 0;
+        if (!readValue(data, offset, entry.number) || !readValue(data, offset, entry.state) ||
+            !readValue(data, offset, nameLength) || data.size() - offset < nameLength)
+        {
+            entries.clear();
+            return false;
+        }
+        entry.name.assign(data, offset, nameLength);
+        offset += nameLength;
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+bool StemIndex::beginScan()
+{
+    scanStarted = false;
+    if (!isSupported())
+        return false;
+
+#ifndef _WIN32
+    // Create the file now so its creation is already part of the recorded stamp
+    int fd = ::open(indexPath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0)
+        return false;
+    ::close(fd);
+#else
+    if (!fs::exists(indexPath))
+    {
+        std::ofstream create(indexPath, std::ios::binary);
+        if (!create)
+            return false;
+    }
+#endif
+
+    std::int64_t newest;
+    scanStarted = readStemStamp(scanMtime, scanCtime, newest);
+    return scanStarted;
+}
+
+bool StemIndex::save(const std::vector<std::string> &names)
+{
+    if (!scanStarted)
+        return false;
+    scanStarted = false;
+
+    // A stem that changed during the scan would be indexed with the wrong stamp
+    std::int64_t mtime, ctime, newest;
+    if (!readStemStamp(mtime, ctime, newest) || mtime != scanMtime || ctime != scanCtime)
+        return false;
+
+    // Carry recorded states over from the previous index, whether fresh or not
+    std::unordered_map<std::string, std::uint8_t> previousStates;
+    {
+        StemIndex previous(stemDir);
+        if (previous.read(false))
+        {
+            for (const auto &entry : previous.entries)
+            {
+                previousStates[entry.name] = entry.state;
+            }
+        }
+    }
+
+    entries.clear();
+    entries.reserve(names.size());
+    for (const auto &name : names)
+    {
+        Entry entry;
+        entry.name = name;
+        size_t number = 0;
+        std::string baseName;
+        size_t slash = name.rfind('/');
+        std::string lessonName = slash == std::string::npos ? name : name.substr(slash + 1);
+        if (DirectorySynchronizer::splitNumberedName(lessonName, number, baseName))
+        {
+            entry.number = static_cast<std::uint32_t>(number);
+        }
+        auto it = previousStates.find(name);
+        if (it != previousStates.end())
+        {
+            entry.state = it->second;
+        }
+        entries.push_back(std::move(entry));
+    }
+    return write();
+}
+
+bool StemIndex::recordStates(const std::unordered_map<std::string, std::uint8_t> &states)
+{
+    if (!load())
+        return false;
+
+    for (auto &entry : entries)
+    {
+        auto it = states.find(entry.name);
+        if (it != states.end())
+        {
+            entry.state = it->second;
+        }
+    }
+    return write();
+}
+
+const std::vector<StemIndex::Entry> &StemIndex::getEntries() const
+{
+    return entries;
+}
+
+bool StemIndex::readIndexTime(std::int64_t &time) const
+{
+#ifdef _WIN32
+    std::error_code ec;
+    auto writeTime = fs::last_write_time(indexPath, ec);
+    if (ec)
+        return false;
+    time = std::chrono::duration_cast<std::chrono::nanoseconds>(writeTime.time_since_epoch()).count();
+    return true;
+#else
+    // ctime, like the stem's change time it is compared with, cannot be set back by utimes()
+    struct stat st;
+    if (::stat(indexPath.c_str(), &st) != 0)
+        return false;
+    time = static_cast<std::int64_t>(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+    return true;
+#endif
+}
+
+bool StemIndex::readStemStamp(std::int64_t &mtime, std::int64_t &ctime, std::int64_t &newest) const
+{
+#ifdef _WIN32
+    std::error_code ec;
+    auto time = fs::last_write_time(stemDir, ec);
+    if (ec)
+        return false;
+    mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    ctime = 0;
+    newest = mtime;
+    return true;
+#else
+    struct stat st;
+    if (::stat(stemDir.c_str(), &st) != 0)
+        return false;
+    mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    ctime = static_cast<std::int64_t>(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+    newest = ctime;
+
+    // Lessons of a sharded stem change the bucket timestamps, not the stem's; fold every bucket in
+    if (StemLayout(stemDir).load())
+    {
+        std::uint64_t mtimeSum = static_cast<std::uint64_t>(mtime);
+        std::uint64_t ctimeSum = static_cast<std::uint64_t>(ctime);
+        bool success = true;
+        try
+        {
+            FileSystemBackend::getActive().forEachEntry(stemDir, [&](const FileSystemBackend::DirectoryEntry &entry)
+                                                        {
+                if (!entry.isDirectory || !StemLayout::isBucketName(entry.name))
+                    return;
+                struct stat bucketStat;
+                if (::stat((stemDir / entry.name).c_str(), &bucketStat) != 0)
+                {
+                    success = false;
+                    return;
+                }
+                // Order-independent, so the directory stream order does not matter
+                std::uint64_t salt = TemplateFiles::hashContent(entry.name);
+                std::int64_t bucketMtime = static_cast<std::int64_t>(bucketStat.st_mtim.tv_sec) * 1000000000 +
+                                           bucketStat.st_mtim.tv_nsec;
+                std::int64_t bucketCtime = static_cast<std::int64_t>(bucketStat.st_ctim.tv_sec) * 1000000000 +
+                                           bucketStat.st_ctim.tv_nsec;
+                mtimeSum += salt ^ static_cast<std::uint64_t>(bucketMtime);
+                ctimeSum += salt ^ static_cast<std::uint64_t>(bucketCtime);
+                newest = std::max(newest, bucketCtime); });
+        }
+        catch (const fs::filesystem_error &)
+        {
+            return false;
+        }
+        mtime = static_cast<std::int64_t>(mtimeSum);
+        ctime = static_cast<std::int64_t>(ctimeSum);
+        return success;
+    }
+    return true;
+#endif
+}
+
+bool StemIndex::write()
+{
+    std::string payload;
+    for (const auto &entry : entries)
+    {
+        if (entry.name.size() > UINT16_MAX)
+            return false;
+        appendValue(payload, entry.number);
+        appendValue(payload, entry.state);
+        appendValue(payload, static_cast<std::uint16_t>(entry.name.size()));
+        payload += entry.name;
+    }
+
+#ifdef _WIN32
+    std::int64_t mtime, ctime, newest;
+    std::ofstream file(indexPath, std::ios::binary | std::ios::trunc);
+    if (!file || !readStemStamp(mtime, ctime, newest))
+        return false;
+#else
+    // Rewrite in place: replacing the file would change the stem's timestamps again
+    int fd = ::open(indexPath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0)
+        return false;
+    std::int64_t mtime, ctime, newest;
+    if (!readStemStamp(mtime, ctime, newest))
+    {
+        ::close(fd);
+        return false;
+    }
+#endif
+
+    IndexHeader header;
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.stemMtime = mtime;
+    header.stemCtime = ctime;
+    header.entryCount = entries.size();
+    header.payloadSize = payload.size();
+    header.payloadHash = TemplateFiles::hashContent(payload);
+
+    std::string data(reinterpret_cast<const char *>(&header), sizeof(header));
+    data += payload;
+
+#ifdef _WIN32
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file.flush());
+#else
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t count = ::pwrite(fd, data.data() + written, data.size() - written, static_cast<off_t>(written));
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        written += static_cast<size_t>(count);
+    }
+    bool success = ::ftruncate(fd, static_cast<off_t>(data.size())) == 0;
+    return ::close(fd) == 0 && success;
+#endif
+}
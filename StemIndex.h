@@ -0,0 +1,140 @@
+#ifndef STEM_INDEX_H
+#define STEM_INDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Persistent cache of a stem's sorted subdirectory list
+ *
+ * StemIndex keeps a small binary file in the stem holding the sorted
+ * subdirectory names, their numeric prefixes and the template state last
+ * recorded for each. The file is stamped with the stem directory's mtime and
+ * ctime; any entry created, removed or renamed in the stem changes those, so
+ * a stamp mismatch means the index is stale and the stem must be rescanned.
+ * For sharded stems the stamps of every bucket directory are folded in.
+ * Template states only change when the tool records them and are hints.
+ *
+ * On filesystems with coarse timestamps, a subdirectory created in the same
+ * tick as the index was written leaves the stamp unchanged. Like a racily
+ * clean git index, an index that is not strictly newer than the last change
+ * to the stem (or a bucket) is therefore not trusted; the next scan rewrites
+ * it, which makes it newer.
+ *
+ * The index is rewritten in place once it exists, so saving it does not
+ * itself change the stem's timestamps. A checksum over the payload detects
+ * torn reads from concurrent writers, which are treated as stale.
+ */
+class StemIndex
+{
+public:
+    /**
+     * @brief Template state last recorded for a subdirectory
+     */
+    enum TemplateState : std::uint8_t
+    {
+        STATE_UNKNOWN = 0,    // Nothing recorded
+        STATE_TEMPLATED = 1,  // Template files were written by the tool
+        STATE_VERIFIED = 2,   // verify found the templates intact
+        STATE_DIFFERS = 3     // verify found missing, modified or extra files
+    };
+
+    /**
+     * @brief Structure representing one indexed subdirectory
+     */
+    struct Entry
+    {
+        std::string name;                   // Subdirectory name
+        std::uint32_t number = 0;           // Numeric "NN - " prefix (0 if none)
+        std::uint8_t state = STATE_UNKNOWN; // Recorded template state
+    };
+
+    // Name of the index file inside the stem directory
+    static constexpr const char *INDEX_FILE_NAME = ".dirtemplate.idx";
+
+    /**
+     * @brief Constructor
+     *
+     * @param stemDir Stem directory the index belongs to
+     */
+    explicit StemIndex(const fs::path &stemDir);
+
+    /**
+     * @brief Loads the index if it exists and matches the stem's timestamps
+     *
+     * @return bool True if a fresh index was loaded
+     */
+    bool load();
+
+    /**
+     * @brief Prepares a rescan whose result will be passed to save()
+     *
+     * Creates the index file if needed and records the stem's timestamps,
+     * so save() can tell whether the stem changed while it was scanned.
+     *
+     * @return bool True if the index can be written afterwards
+     */
+    bool beginScan();
+
+    /**
+     * @brief Writes the index for a complete, sorted subdirectory list
+     *
+     * Nothing is written if the stem changed since beginScan(). Template
+     * states of names in the previous index are carried over.
+     *
+     * @param names Sorted names of every visible subdirectory
+     * @return bool True if the index was written
+     */
+    bool save(const std::vector<std::string> &names);
+
+    /**
+     * @brief Records template states in a fresh index
+     *
+     * Does nothing if the index is missing or stale.
+     *
+     * @param states New states keyed by subdirectory name
+     * @return bool True if the index was updated
+     */
+    bool recordStates(const std::unordered_map<std::string, std::uint8_t> &states);
+
+    /**
+     * @brief Gets the entries read by load() or written by save()
+     *
+     * @return const std::vector<Entry>& Entries sorted by name
+     */
+    const std::vector<Entry> &getEntries() const;
+
+    /**
+     * @brief Checks whether the active backend supports an index
+     *
+     * @return bool True for on-disk backends
+     */
+    static bool isSupported();
+
+private:
+    // Reads the index file; with requireFresh, only if its stamp matches the stem
+    bool read(bool requireFresh);
+
+    // Reads the stem's mtime and ctime in nanoseconds, and the newest change time of the stem or a bucket
+    bool readStemStamp(std::int64_t &mtime, std::int64_t &ctime, std::int64_t &newest) const;
+
+    // Reads the time the index file was last written, at the filesystem's own granularity
+    bool readIndexTime(std::int64_t &time) const;
+
+    // Writes the entries, creating the file first so the stamp covers its creation
+    bool write();
+
+    fs::path stemDir;           // Stem directory
+    fs::path indexPath;         // Index file inside the stem
+    std::vector<Entry> entries; // Indexed subdirectories
+    std::int64_t scanMtime;     // Stem mtime recorded by beginScan()
+    std::int64_t scanCtime;     // Stem ctime recorded by beginScan()
+    bool scanStarted;           // True between beginScan() and save()
+};
+
+#endif // STEM_INDEX_H
@@ -0,0 +1,122 @@
+#include "StemLayout.h"
+#include "FileSystemBackend.h"
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+// Sharding of new stems is opt-in
+static size_t defaultFanOut = 0;
+
+void StemLayout::setDefaultFanOut(size_t fanOut)
+{
+    defaultFanOut = fanOut;
+}
+
+size_t StemLayout::getDefaultFanOut()
+{
+    return defaultFanOut;
+}
+
+bool StemLayout::shouldShard(size_t entryCount)
+{
+    return defaultFanOut > 0 && entryCount > defaultFanOut;
+}
+
+StemLayout::StemLayout(const fs::path &stemDir) : stemDir(stemDir), fanOut(0)
+{
+}
+
+bool StemLayout::load()
+{
+    // Backends without on-disk files cannot be read back; their stems are enumerated as flat
+    fanOut = 0;
+    if (!FileSystemBackend::getActive().isOnDisk())
+    {
+        return false;
+    }
+
+    std::ifstream marker(stemDir / LAYOUT_FILE_NAME);
+    std::string key;
+    size_t value = 0;
+    if (marker && std::getline(marker, key, '=') && key == "fanout" && marker >> value)
+    {
+        fanOut = value;
+    }
+    return fanOut > 0;
+}
+
+bool StemLayout::enableSharding(size_t fanOut)
+{
+    try
+    {
+        FileSystemBackend::getActive().writeFile(stemDir / LAYOUT_FILE_NAME, "fanout=" + std::to_string(fanOut) + "\n");
+        this->fanOut = fanOut;
+        return true;
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Error writing stem layout: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool StemLayout::isSharded() const
+{
+    return fanOut > 0;
+}
+
+size_t StemLayout::getFanOut() const
+{
+    return fanOut;
+}
+
+fs::path StemLayout::getRelativePath(size_t number, const std::string &formattedName) const
+{
+    if (fanOut == 0)
+    {
+        return formattedName;
+    }
+    return fs::path(bucketName(number, fanOut)) / formattedName;
+}
+
+std::string StemLayout::bucketName(size_t number, size_t fanOut)
+{
+    // Wide enough that a thousand buckets of this size keep their order when sorted by name
+    size_t first = number / fanOut * fanOut;
+    size_t last = first + fanOut - 1;
+    size_t width = std::max<size_t>(6, std::to_string(fanOut * 1000 - 1).size());
+
+    std::string firstText = std::to_string(first);
+    std::string lastText = std::to_string(last);
+    return std::string(width - std::min(width, firstText.size()), '0') + firstText + "-" +
+           std::string(width - std::min(width, lastText.size()), '0') + lastText;
+}
+
+bool StemLayout::isBucketName(const std::string &name)
+{
+    size_t dash = name.find('-');
+    if (dash == 0 || dash == std::string::npos || dash + 1 == name.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        if (i != dash && (name[i] < '0' || name[i] > '9'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string StemLayout::entryName(const fs::path &stemDir, const fs::path &subDir)
+{
+    fs::path parent = subDir.parent_path();
+    if (parent != stemDir)
+    {
+        return parent.filename().string() + "/" + subDir.filename().string();
+    }
+    return subDir.filename().string();
+}
@@ -0,0 +1,126 @@
+#ifndef STEM_LAYOUT_H
+#define STEM_LAYOUT_H
+
+#include <string>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Describes how the lesson directories of a stem are laid out
+ *
+ * A flat stem holds its "NN - Name" directories directly. A sharded stem
+ * groups them into bucket directories of at most fanOut lessons each, named
+ * after the range of numbers they hold, e.g. "000000-000999/0001 - Name",
+ * so no directory grows beyond fanOut + 1 entries. The layout is recorded
+ * in a small marker file in the stem, and enumeration reports sharded
+ * lessons by their "bucket/lesson" path relative to the stem, so the
+ * copier, verifier and stem index handle both layouts the same way.
+ */
+class StemLayout
+{
+public:
+    // Name of the marker file inside a sharded stem
+    static constexpr const char *LAYOUT_FILE_NAME = ".dirtemplate.layout";
+
+    /**
+     * @brief Sets the fan-out used when creation decides to shard a new stem
+     *
+     * @param fanOut Lessons per bucket (0 never shards new stems)
+     */
+    static void setDefaultFanOut(size_t fanOut);
+
+    /**
+     * @brief Gets the fan-out used when creation decides to shard a new stem
+     *
+     * @return size_t Lessons per bucket (0 if automatic sharding is off)
+     */
+    static size_t getDefaultFanOut();
+
+    /**
+     * @brief Checks whether creation should shard a stem of the given size
+     *
+     * @param entryCount Number of lessons in the outline (or a lower bound)
+     * @return bool True if the count exceeds the default fan-out
+     */
+    static bool shouldShard(size_t entryCount);
+
+    /**
+     * @brief Constructor
+     *
+     * @param stemDir Stem directory the layout belongs to
+     */
+    explicit StemLayout(const fs::path &stemDir);
+
+    /**
+     * @brief Reads the layout marker of the stem
+     *
+     * @return bool True if the stem is sharded
+     */
+    bool load();
+
+    /**
+     * @brief Marks the stem as sharded with the given fan-out
+     *
+     * @param fanOut Lessons per bucket
+     * @return bool True if the marker was written
+     */
+    bool enableSharding(size_t fanOut);
+
+    /**
+     * @brief Checks whether the stem is sharded
+     *
+     * @return bool True after a successful load() or enableSharding()
+     */
+    bool isSharded() const;
+
+    /**
+     * @brief Gets the fan-out of a sharded stem
+     *
+     * @return size_t Lessons per bucket (0 for flat stems)
+     */
+    size_t getFanOut() const;
+
+    /**
+     * @brief Gets where a lesson directory lives relative to the stem
+     *
+     * @param number One-based lesson number
+     * @param formattedName Formatted "NN - Name" directory name
+     * @return fs::path "bucket/NN - Name" for sharded stems, otherwise the name itself
+     */
+    fs::path getRelativePath(size_t number, const std::string &formattedName) const;
+
+    /**
+     * @brief Builds the bucket directory name for a lesson number
+     *
+     * Bounds are zero-padded so the first thousand buckets sort in order.
+     *
+     * @param number One-based lesson number
+     * @param fanOut Lessons per bucket
+     * @return std::string Bucket name such as "000000-000999"
+     */
+    static std::string bucketName(size_t number, size_t fanOut);
+
+    /**
+     * @brief Checks whether a directory name has the "<digits>-<digits>" bucket form
+     *
+     * @param name Directory name
+     * @return bool True for bucket names
+     */
+    static bool isBucketName(const std::string &name);
+
+    /**
+     * @brief Gets the name of a lesson directory relative to its stem
+     *
+     * @param stemDir Stem directory that was enumerated
+     * @param subDir Path of a lesson directory as produced by enumeration
+     * @return std::string "bucket/NN - Name" inside buckets, otherwise "NN - Name"
+     */
+    static std::string entryName(const fs::path &stemDir, const fs::path &subDir);
+
+private:
+    fs::path stemDir; // Stem directory
+    size_t fanOut;    // Lessons per bucket (0 for flat stems)
+};
+
+#endif // STEM_LAYOUT_H
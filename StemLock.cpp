@@ -0,0 +1,110 @@
+#include "StemLock.h"
+#include "FileSystemBackend.h"
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+
+StemLock::StemLock(const fs::path &stemDir) : handle(INVALID_HANDLE_VALUE), locked(false)
+{
+    if (!FileSystemBackend::getActive().isOnDisk())
+    {
+        return;
+    }
+
+    fs::path lockPath = stemDir / LOCK_FILE_NAME;
+    handle = ::CreateFileW(lockPath.c_str(), GENERIC_READ | GENERIC_WRITE,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                           OPEN_ALWAYS, FILE_ATTRIBUTE_HIDDEN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "Warning: Could not create lock file: " << lockPath.string() << std::endl;
+        return;
+    }
+
+    OVERLAPPED overlapped = {};
+    if (!::LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &overlapped))
+    {
+        std::cout << "Waiting for another process working on " << stemDir.string() << "..." << std::endl;
+        locked = ::LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped) != 0;
+    }
+    else
+    {
+        locked = true;
+    }
+}
+
+StemLock::~StemLock()
+{
+    if (handle != INVALID_HANDLE_VALUE)
+    {
+        if (locked)
+        {
+            OVERLAPPED overlapped = {};
+            ::UnlockFileEx(handle, 0, 1, 0, &overlapped);
+        }
+        ::CloseHandle(handle);
+    }
+}
+
+#else
+
+StemLock::StemLock(const fs::path &stemDir) : fd(-1), locked(false)
+{
+    if (!FileSystemBackend::getActive().isOnDisk())
+    {
+        return;
+    }
+
+    fs::path lockPath = stemDir / LOCK_FILE_NAME;
+    fd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0)
+    {
+        std::cerr << "Warning: Could not create lock file: " << lockPath.string() << std::endl;
+        return;
+    }
+
+    // Try without blocking first so the user knows why we are waiting
+    if (::flock(fd, LOCK_EX | LOCK_NB) == 0)
+    {
+        locked = true;
+        return;
+    }
+
+    std::cout << "Waiting for another process working on " << stemDir.string() << "..." << std::endl;
+    while (::flock(fd, LOCK_EX) != 0)
+    {
+        if (errno != EINTR)
+        {
+            std::cerr << "Warning: Could not lock " << lockPath.string() << std::endl;
+            return;
+        }
+    }
+    locked = true;
+}
+
+StemLock::~StemLock()
+{
+    // Closing the descriptor releases the flock
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+#endif
+
+bool StemLock::isLocked() const
+{
+    return locked;
+}
@@ -0,0 +1,57 @@
+#ifndef STEM_LOCK_H
+#define STEM_LOCK_H
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Exclusive advisory lock on a stem directory
+ *
+ * StemLock serializes processes that provision the same stem. It holds an
+ * flock (LockFileEx on Windows) on a hidden lock file inside the stem for
+ * as long as the object lives, so workers on different stems never wait
+ * for each other. The lock file is left in place on release because
+ * removing it would let two processes lock different inodes. Locking is
+ * skipped for backends that are not on disk.
+ */
+class StemLock
+{
+public:
+    /**
+     * @brief Name of the lock file created inside each stem
+     */
+    static constexpr const char *LOCK_FILE_NAME = ".dirtemplate.lock";
+
+    /**
+     * @brief Constructor blocks until the lock is acquired
+     *
+     * @param stemDir Stem directory to lock (must already exist)
+     */
+    explicit StemLock(const fs::path &stemDir);
+
+    /**
+     * @brief Destructor releases the lock
+     */
+    ~StemLock();
+
+    StemLock(const StemLock &) = delete;
+    StemLock &operator=(const StemLock &) = delete;
+
+    /**
+     * @brief Checks whether the lock is held
+     *
+     * @return bool True if the lock was acquired
+     */
+    bool isLocked() const;
+
+private:
+#ifdef _WIN32
+    void *handle; // Lock file handle
+#else
+    int fd;       // Lock file descriptor
+#endif
+    bool locked;  // True while the lock is held
+};
+
+#endif // STEM_LOCK_H
@@ -0,0 +1,123 @@
+#include "StemPrescan.h"
+#include "SubdirectoryStream.h"
+#include "StemLayout.h"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+StemPrescan::StemPrescan(const fs::path &stemDir, size_t memoryLimit, size_t maxOpenDirectories, bool sorted)
+    : stemDir(stemDir), memoryLimit(memoryLimit), maxOpenDirectories(maxOpenDirectories), sorted(sorted), readOk(false),
+      complete(false), servedFromIndex(false), listingReady(false), planReady(false)
+{
+    worker = std::thread(&StemPrescan::run, this);
+}
+
+StemPrescan::~StemPrescan()
+{
+    cancelled = true;
+    worker.join();
+}
+
+bool StemPrescan::waitForListing()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [this]
+               { return listingReady; });
+    return readOk;
+}
+
+bool StemPrescan::isComplete() const
+{
+    return complete;
+}
+
+bool StemPrescan::wasServedFromIndex() const
+{
+    return servedFromIndex;
+}
+
+const std::vector<std::string> &StemPrescan::getNames() const
+{
+    return names;
+}
+
+void StemPrescan::waitForPlan()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [this]
+               { return planReady; });
+}
+
+FileSystemBackend::DirectoryHandle StemPrescan::takeDirectory(size_t index)
+{
+    if (index < handles.size() && handles[index].getDescriptor() >= 0)
+    {
+        return std::move(handles[index]);
+    }
+    return FileSystemBackend::DirectoryHandle(stemDir / names[index], -1);
+}
+
+size_t StemPrescan::getOpenedCount() const
+{
+    return handles.size();
+}
+
+void StemPrescan::run()
+{
+    // Phase 1: the listing the confirmation prompt needs
+    SubdirectoryStream stream(stemDir, 4096, memoryLimit, sorted);
+    size_t namesBytes = 0;
+    bool overflow = false;
+    bool success = stream.forEachBatch([&](const std::vector<fs::path> &batch)
+                                       {
+        for (const auto &subDir : batch)
+        {
+            std::string name = StemLayout::entryName(stemDir, subDir);
+            namesBytes += sizeof(std::string) + name.size();
+            if (namesBytes > memoryLimit)
+            {
+                overflow = true;
+                return false;
+            }
+            names.push_back(std::move(name));
+        }
+        return !cancelled.load(); });
+
+    if (overflow)
+    {
+        std::vector<std::string>().swap(names);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        readOk = success;
+        complete = success && !overflow && !cancelled;
+        servedFromIndex = stream.wasServedFromIndex();
+        listingReady = true;
+    }
+    ready.notify_all();
+
+    // Phase 2: open the subdirectories while the user is still reading
+    if (complete)
+    {
+        FileSystemBackend &backend = FileSystemBackend::getActive();
+        size_t openCount = std::min(names.size(), maxOpenDirectories);
+        handles.reserve(openCount);
+        for (size_t i = 0; i < openCount && !cancelled; ++i)
+        {
+            try
+            {
+                handles.push_back(backend.openDirectory(stemDir / names[i]));
+            }
+            catch (const fs::filesystem_error &)
+            {
+                // Reported when the templates are written through the path instead
+                handles.push_back(FileSystemBackend::DirectoryHandle(stemDir / names[i], -1));
+            }
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        planReady = true;
+    }
+    ready.notify_all();
+}
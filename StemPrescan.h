@@ -0,0 +1,121 @@
+#ifndef STEM_PRESCAN_H
+#define STEM_PRESCAN_H
+
+#include "FileSystemBackend.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Speculatively scans a stem and opens its subdirectories in the background
+ *
+ * StemPrescan starts as soon as a stem path is known. Its thread first lists
+ * the subdirectories, in name order unless unordered enumeration was asked
+ * for, which is all the confirmation prompt needs, and then keeps opening the subdirectories while the user reads the
+ * listing and answers. Once the user confirms, template writes start at
+ * once through the already open directories. If the user declines, the scan
+ * is abandoned and the descriptors are closed.
+ *
+ * A stem whose names exceed the memory limit is not collected; callers then
+ * fall back to batched streaming.
+ */
+class StemPrescan
+{
+public:
+    /**
+     * @brief Constructor starts the background scan
+     *
+     * @param stemDir Stem directory to scan
+     * @param memoryLimit Approximate bytes of names the scan may hold
+     * @param maxOpenDirectories Maximum number of subdirectories opened ahead
+     * @param sorted True to list the names in name order, false for directory order
+     */
+    StemPrescan(const fs::path &stemDir, size_t memoryLimit, size_t maxOpenDirectories, bool sorted);
+
+    /**
+     * @brief Destructor abandons any remaining work and joins the thread
+     */
+    ~StemPrescan();
+
+    StemPrescan(const StemPrescan &) = delete;
+    StemPrescan &operator=(const StemPrescan &) = delete;
+
+    /**
+     * @brief Waits until the subdirectory list is available
+     *
+     * @return bool True if the stem could be read
+     */
+    bool waitForListing();
+
+    /**
+     * @brief Checks whether the full list was collected (valid after waitForListing)
+     *
+     * @return bool False if the stem had too many names for the memory limit
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief Checks whether the list came from the stem index
+     *
+     * @return bool True if no directory scan was needed
+     */
+    bool wasServedFromIndex() const;
+
+    /**
+     * @brief Gets the subdirectory names (valid after waitForListing)
+     *
+     * @return const std::vector<std::string>& Subdirectory names
+     */
+    const std::vector<std::string> &getNames() const;
+
+    /**
+     * @brief Waits until the subdirectories have been opened ahead
+     */
+    void waitForPlan();
+
+    /**
+     * @brief Hands over the directory for one name (valid after waitForPlan)
+     *
+     * Subdirectories beyond the open limit, or that could not be opened,
+     * are returned as path-only handles.
+     *
+     * @param index Position in getNames()
+     * @return FileSystemBackend::DirectoryHandle Open or path-only directory
+     */
+    FileSystemBackend::DirectoryHandle takeDirectory(size_t index);
+
+    /**
+     * @brief Gets the number of subdirectories opened ahead
+     *
+     * @return size_t Count of open descriptors prepared
+     */
+    size_t getOpenedCount() const;
+
+private:
+    // Background thread body
+    void run();
+
+    fs::path stemDir;                                        // Stem being scanned
+    size_t memoryLimit;                                      // Byte budget for names
+    size_t maxOpenDirectories;                               // Open-ahead limit
+    bool sorted;                                             // List in name order
+    std::vector<std::string> names;                          // Subdirectory names in listing order
+    std::vector<FileSystemBackend::DirectoryHandle> handles; // Directories opened ahead
+    bool readOk;                                             // True if the stem could be read
+    bool complete;                                           // True if every name was collected
+    bool servedFromIndex;                                    // True if the list came from the index
+    bool listingReady;                                       // Set once names is final
+    bool planReady;                                          // Set once handles is final
+    std::atomic<bool> cancelled{false};                      // Set by the destructor
+    std::mutex mutex;                                        // Guards the ready flags
+    std::condition_variable ready;                           // Signalled when a phase finishes
+    std::thread worker;                                      // Background scan
+};
+
+#endif // STEM_PRESCAN_H
@@ -0,0 +1,315 @@
+#include "SubdirectoryStream.h"
+#include "FileSystemBackend.h"
+#include "StemIndex.h"
+#include "StemLayout.h"
+#include <iostream>
+#include <algorithm>
+#include <queue>
+
+namespace fs = std::filesystem;
+
+SubdirectoryStream::SubdirectoryStream(const fs::path &stemDir, size_t batchSize, size_t memoryLimit, bool sorted)
+    : stemDir(stemDir), batchSize(batchSize == 0 ? 1 : batchSize), memoryLimit(memoryLimit), sorted(sorted),
+      spilledRuns(0), servedFromIndex(false), runBytes(0)
+{
+}
+
+bool SubdirectoryStream::countAndSample(size_t sampleSize, size_t &count, std::vector<std::string> &sample)
+{
+    count = 0;
+    sample.clear();
+
+    // When sorted, keep the smallest names in a max-heap bounded by sampleSize
+    std::priority_queue<std::string> smallest;
+    bool success = forEachName([&](const std::string &name)
+                               {
+        count++;
+        if (sampleSize == 0)
+            return;
+        if (!sorted)
+        {
+            if (sample.size() < sampleSize)
+                sample.push_back(name);
+        }
+        else if (smallest.size() < sampleSize)
+        {
+            smallest.push(name);
+        }
+        else if (name < smallest.top())
+        {
+            smallest.pop();
+            smallest.push(name);
+        } });
+
+    if (sorted)
+    {
+        while (!smallest.empty())
+        {
+            sample.push_back(smallest.top());
+            smallest.pop();
+        }
+        std::reverse(sample.begin(), sample.end());
+    }
+    return success;
+}
+
+bool SubdirectoryStream::forEachBatch(const std::function<bool(const std::vector<fs::path> &)> &body)
+{
+    return sorted ? streamSorted(body) : streamUnsorted(body);
+}
+
+size_t SubdirectoryStream::getSpilledRunCount() const
+{
+    return spilledRuns;
+}
+
+bool SubdirectoryStream::wasServedFromIndex() const
+{
+    return servedFromIndex;
+}
+
+bool SubdirectoryStream::forEachName(const std::function<void(const std::string &)> &visitor)
+{
+    // An unchanged stem is listed from its index without scanning
+    servedFromIndex = false;
+    StemIndex index(stemDir);
+    if (index.load())
+    {
+        servedFromIndex = true;
+        for (const auto &entry : index.getEntries())
+        {
+            visitor(entry.name);
+        }
+        return true;
+    }
+
+    // Otherwise collect the names for a new index while they fit in the memory budget, which they
+    // share with the current sort run; when both do not fit, the index is given up, not the sort
+    bool indexing = index.beginScan();
+    std::vector<std::string> names;
+    size_t namesBytes = 0;
+
+    auto offer = [&](const std::string &name)
+    {
+        if (indexing)
+        {
+            namesBytes += nameCost(name);
+            if (namesBytes + runBytes <= memoryLimit)
+            {
+                names.push_back(name);
+            }
+            else
+            {
+                indexing = false;
+                std::vector<std::string>().swap(names);
+            }
+        }
+        visitor(name);
+    };
+
+    // Lessons of a sharded stem live one level down, inside the bucket directories
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    bool sharded = StemLayout(stemDir).load();
+    try
+    {
+        backend.forEachEntry(stemDir, [&](const FileSystemBackend::DirectoryEntry &entry)
+                             {
+            // Only visible directories, as in the interactive listing
+            if (!entry.isDirectory || entry.name.empty() || entry.name[0] == '.')
+                return;
+            if (!sharded || !StemLayout::isBucketName(entry.name))
+            {
+                offer(entry.name);
+                return;
+            }
+            const std::string bucket = entry.name;
+            backend.forEachEntry(stemDir / bucket, [&](const FileSystemBackend::DirectoryEntry &lesson)
+                                 {
+                if (lesson.isDirectory && !lesson.name.empty() && lesson.name[0] != '.')
+                {
+                    offer(bucket + "/" + lesson.name);
+                } }); });
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Error reading directory: " << e.what() << std::endl;
+        return false;
+    }
+
+    if (indexing)
+    {
+        std::sort(names.begin(), names.end());
+        index.save(names);
+    }
+    return true;
+}
+
+bool SubdirectoryStream::streamUnsorted(const std::function<bool(const std::vector<fs::path> &)> &body)
+{
+    // Work happens inside the subdirectories, so the stem's directory stream stays stable
+    std::vector<fs::path> batch;
+    batch.reserve(batchSize);
+    bool stopped = false;
+    bool success = forEachName([&](const std::string &name)
+                               {
+        if (stopped)
+            return;
+        batch.push_back(stemDir / name);
+        if (batch.size() == batchSize)
+        {
+            stopped = !body(batch);
+            batch.clear();
+        } });
+
+    if (success && !stopped && !batch.empty())
+    {
+        body(batch);
+    }
+    return success;
+}
+
+bool SubdirectoryStream::streamSorted(const std::function<bool(const std::vector<fs::path> &)> &body)
+{
+    spilledRuns = 0;
+    runBytes = 0;
+    std::vector<std::FILE *> runs;
+    std::vector<std::string> run;
+    bool success = true;
+
+    // Phase 1: collect names, spilling a sorted run whenever the budget is used up
+    bool readOk = forEachName([&](const std::string &name)
+                              {
+        if (!success)
+            return;
+        runBytes += nameCost(name);
+        run.push_back(name);
+        if (runBytes >= memoryLimit)
+        {
+            success = spillRun(run, runs);
+            runBytes = 0;
+        } });
+    success = success && readOk;
+    runBytes = 0;
+
+    std::vector<fs::path> batch;
+    batch.reserve(batchSize);
+    bool stopped = false;
+    auto emit = [&](const std::string &name)
+    {
+        batch.push_back(stemDir / name);
+        if (batch.size() == batchSize)
+        {
+            stopped = !body(batch);
+            batch.clear();
+        }
+    };
+
+    if (success && runs.empty())
+    {
+        // Everything fit in memory
+        std::sort(run.begin(), run.end());
+        for (size_t i = 0; i < run.size() && !stopped; ++i)
+        {
+            emit(run[i]);
+        }
+    }
+    else if (success)
+    {
+        if (!run.empty())
+        {
+            success = spillRun(run, runs);
+        }
+
+        // Phase 2: k-way merge of the spilled runs, one pending name per run
+        using Head = std::pair<std::string, size_t>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        std::string name;
+        for (size_t r = 0; success && r < runs.size(); ++r)
+        {
+            if (readName(runs[r], name))
+            {
+                heads.push({name, r});
+            }
+        }
+        while (success && !stopped && !heads.empty())
+        {
+            Head head = heads.top();
+            heads.pop();
+            emit(head.first);
+            if (readName(runs[head.second], name))
+            {
+                heads.push({name, head.second});
+            }
+        }
+        for (std::FILE *file : runs)
+        {
+            if (std::ferror(file))
+            {
+                std::cerr << "Error reading sorted run from temporary file." << std::endl;
+                success = false;
+            }
+        }
+    }
+
+    if (success && !stopped && !batch.empty())
+    {
+        body(batch);
+    }
+
+    for (std::FILE *file : runs)
+    {
+        std::fclose(file);
+    }
+    return success;
+}
+
+bool SubdirectoryStream::spillRun(std::vector<std::string> &run, std::vector<std::FILE *> &runs)
+{
+    // tmpfile() is removed automatically when closed or when the process exits
+    std::FILE *file = std::tmpfile();
+    if (!file)
+    {
+        std::cerr << "Error: Could not create a temporary file for sorting." << std::endl;
+        return false;
+    }
+    runs.push_back(file);
+    spilledRuns++;
+
+    std::sort(run.begin(), run.end());
+    for (const auto &name : run)
+    {
+        // Names cannot contain NUL, so it is a safe separator
+        std::fwrite(name.data(), 1, name.size() + 1, file);
+    }
+    run.clear();
+    run.shrink_to_fit();
+
+    if (std::fflush(file) != 0 || std::ferror(file))
+    {
+        std::cerr << "Error: Could not write a sorted run to a temporary file." << std::endl;
+        return false;
+    }
+    std::rewind(file);
+    return true;
+}
+
+bool SubdirectoryStream::readName(std::FILE *run, std::string &name)
+{
+    name.clear();
+    int c;
+    while ((c = std::getc(run)) != EOF)
+    {
+        if (c == '\0')
+        {
+            return true;
+        }
+        name.push_back(static_cast<char>(c));
+    }
+    return false;
+}
+
+size_t SubdirectoryStream::nameCost(const std::string &name)
+{
+    // Short names live inside the string object; longer ones add a heap block
+    return sizeof(std::string) + (name.size() >= sizeof(std::string) ? name.size() + 1 : 0);
+}
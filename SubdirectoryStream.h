@@ -0,0 +1,110 @@
+#ifndef SUBDIRECTORY_STREAM_H
+#define SUBDIRECTORY_STREAM_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdio>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Enumerates the subdirectories of a stem in fixed-size batches
+ *
+ * SubdirectoryStream reads the stem straight from the directory stream and
+ * hands out batches of at most batchSize paths, so stems with millions of
+ * subdirectories are processed without materializing the full list. Hidden
+ * directories are skipped, as in the interactive listing.
+ *
+ * Sorted enumeration uses an external merge sort: names are collected until
+ * the memory limit is reached, each full run is sorted and spilled to an
+ * anonymous temporary file, and the runs are merged on the way out. A stem
+ * that fits within the limit is sorted in memory without spilling. Names
+ * collected for the stem index count against the same limit.
+ *
+ * In a sharded stem (see StemLayout) the lessons inside the bucket
+ * directories are enumerated instead of the buckets, and reported by their
+ * "bucket/NN - Name" path relative to the stem.
+ *
+ * On disk, a fresh StemIndex replaces the directory scan entirely. When a
+ * scan has to run and the names fit within the memory limit, the index is
+ * rewritten so the next enumeration of an unchanged stem starts instantly.
+ */
+class SubdirectoryStream
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param stemDir Stem directory to enumerate
+     * @param batchSize Maximum number of paths per batch
+     * @param memoryLimit Approximate bytes of names held in memory while sorting
+     * @param sorted True to deliver batches in name order
+     */
+    SubdirectoryStream(const fs::path &stemDir, size_t batchSize, size_t memoryLimit, bool sorted);
+
+    /**
+     * @brief Counts the subdirectories and collects a small sample of names
+     *
+     * When sorted, the sample holds the first names in order; otherwise it
+     * holds the first names the directory stream returned.
+     *
+     * @param sampleSize Maximum number of sample names
+     * @param count Receives the number of subdirectories
+     * @param sample Receives the sample names
+     * @return bool True if the stem could be read
+     */
+    bool countAndSample(size_t sampleSize, size_t &count, std::vector<std::string> &sample);
+
+    /**
+     * @brief Calls body for consecutive batches of subdirectory paths
+     *
+     * @param body Called with each batch; returning false stops the enumeration
+     * @return bool True if the stem and every spilled run could be read
+     */
+    bool forEachBatch(const std::function<bool(const std::vector<fs::path> &)> &body);
+
+    /**
+     * @brief Gets the number of sorted runs spilled to temporary files
+     *
+     * @return size_t Spilled run count of the last sorted enumeration
+     */
+    size_t getSpilledRunCount() const;
+
+    /**
+     * @brief Checks whether the last enumeration was served from the stem index
+     *
+     * @return bool True if no directory scan was needed
+     */
+    bool wasServedFromIndex() const;
+
+private:
+    // Reads the stem and calls visitor with the name of every visible subdirectory
+    bool forEachName(const std::function<void(const std::string &)> &visitor);
+
+    // Delivers names in directory-stream order
+    bool streamUnsorted(const std::function<bool(const std::vector<fs::path> &)> &body);
+
+    // Delivers names in sorted order via in-memory or external merge sort
+    bool streamSorted(const std::function<bool(const std::vector<fs::path> &)> &body);
+
+    // Sorts a run and writes it NUL-separated to a new temporary file
+    bool spillRun(std::vector<std::string> &run, std::vector<std::FILE *> &runs);
+
+    // Reads the next NUL-terminated name from a run; false at end of run
+    static bool readName(std::FILE *run, std::string &name);
+
+    // Approximate heap cost of holding a name in a vector
+    static size_t nameCost(const std::string &name);
+
+    fs::path stemDir;       // Stem directory being enumerated
+    size_t batchSize;       // Maximum paths per batch
+    size_t memoryLimit;     // Byte budget for names held while sorting
+    bool sorted;            // True to deliver batches in name order
+    size_t spilledRuns;     // Runs spilled by the last sorted enumeration
+    bool servedFromIndex;   // True if the last enumeration used the stem index
+    size_t runBytes;        // Approximate bytes held by the current sort run
+};
+
+#endif // SUBDIRECTORY_STREAM_H
@@ -0,0 +1,235 @@
+#include "TarArchiveWriter.h"
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+    /**
+     * @brief Layout of a ustar header block
+     */
+    struct UstarHeader
+    {
+        char name[100];
+        char mode[8];
+        char uid[8];
+        char gid[8];
+        char size[12];
+        char mtime[12];
+        char checksum[8];
+        char typeFlag;
+        char linkName[100];
+        char magic[6];
+        char version[2];
+        char userName[32];
+        char groupName[32];
+        char deviceMajor[8];
+        char deviceMinor[8];
+        char prefix[155];
+        char padding[12];
+    };
+
+    static_assert(sizeof(UstarHeader) == 512, "ustar header must be exactly one block");
+
+    // Writes an octal number right-aligned in a NUL-terminated field, or base-256 if it does not fit
+    void writeNumber(char *field, size_t width, std::uint64_t value)
+    {
+        std::uint64_t limit = 1;
+        for (size_t i = 0; i < width - 1; ++i)
+        {
+            limit *= 8;
+        }
+
+        if (value < limit)
+        {
+            field[width - 1] = '\0';
+            for (size_t i = width - 1; i-- > 0;)
+            {
+                field[i] = static_cast<char>('0' + (value & 7));
+                value >>= 3;
+            }
+        }
+        else
+        {
+            // GNU/star base-256 extension for very large sizes
+            std::memset(field, 0, width);
+            for (size_t i = width; i-- > 1;)
+            {
+                field[i] = static_cast<char>(value & 0xff);
+                value >>= 8;
+            }
+            field[0] = static_cast<char>(0x80);
+        }
+    }
+
+    // Splits a path into ustar prefix and name fields; returns false if it cannot fit
+    bool splitPath(const std::string &path, std::string &prefix, std::string &name)
+    {
+        if (path.size() <= sizeof(UstarHeader::name))
+        {
+            prefix.clear();
+            name = path;
+            return true;
+        }
+
+        // Look for the right-most slash that gives a prefix of at most 155 bytes
+        size_t pos = path.rfind('/', sizeof(UstarHeader::prefix));
+        while (pos != std::string::npos && pos > 0)
+        {
+            if (path.size() - pos - 1 <= sizeof(UstarHeader::name) && pos + 1 < path.size())
+            {
+                prefix = path.substr(0, pos);
+                name = path.substr(pos + 1);
+                return true;
+            }
+            pos = path.rfind('/', pos - 1);
+        }
+        return false;
+    }
+
+    // Builds one pax record: "<length> <key>=<value>\n" where length counts itself
+    std::string makePaxRecord(const std::string &key, const std::string &value)
+    {
+        size_t baseLength = key.size() + value.size() + 3; // space, '=', newline
+        size_t length = baseLength + 1;
+        while (std::to_string(length).size() + baseLength != length)
+        {
+            length = std::to_string(length).size() + baseLength;
+        }
+        return std::to_string(length) + " " + key + "=" + value + "\n";
+    }
+}
+
+TarArchiveWriter::TarArchiveWriter(std::FILE *out, std::time_t modificationTime)
+    : out(out), modificationTime(modificationTime), bytesWritten(0), failed(false), owner(0), group(0),
+      dirMode(0755), fileMode(0644)
+{
+    buffer.reserve(BUFFER_SIZE);
+}
+
+void TarArchiveWriter::setOwnership(std::uint64_t owner, std::uint64_t group, unsigned dirMode, unsigned fileMode)
+{
+    this->owner = owner;
+    this->group = group;
+    this->dirMode = dirMode;
+    this->fileMode = fileMode;
+}
+
+void TarArchiveWriter::addDirectory(const std::string &path)
+{
+    writeHeader(path + "/", '5', dirMode, 0);
+}
+
+void TarArchiveWriter::addFile(const std::string &path, std::string_view content)
+{
+    writeHeader(path, '0', fileMode, content.size());
+    append(content);
+    appendPadding(content.size());
+}
+
+bool TarArchiveWriter::finish()
+{
+    // End of archive is two zero blocks
+    static const char zeros[BLOCK_SIZE * 2] = {};
+    append(std::string_view(zeros, sizeof(zeros)));
+    flush();
+
+    if (std::fflush(out) != 0)
+    {
+        failed = true;
+    }
+    return !failed;
+}
+
+std::uint64_t TarArchiveWriter::getBytesWritten() const
+{
+    return bytesWritten;
+}
+
+void TarArchiveWriter::writeHeader(const std::string &path, char typeFlag, unsigned mode, std::uint64_t size)
+{
+    std::string prefix;
+    std::string name;
+
+    // Paths that do not fit ustar get a pax extended header carrying the full path
+    if (!splitPath(path, prefix, name))
+    {
+        std::string record = makePaxRecord("path", path);
+        writeHeader("PaxHeaders/" + path.substr(0, 80), 'x', 0644, record.size());
+        append(record);
+        appendPadding(record.size());
+
+        prefix.clear();
+        name = path.substr(0, sizeof(UstarHeader::name));
+    }
+
+    UstarHeader header;
+    std::memset(&header, 0, sizeof(header));
+
+    std::memcpy(header.name, name.data(), std::min(name.size(), sizeof(header.name)));
+    std::memcpy(header.prefix, prefix.data(), std::min(prefix.size(), sizeof(header.prefix)));
+    writeNumber(header.mode, sizeof(header.mode), mode);
+    writeNumber(header.uid, sizeof(header.uid), owner);
+    writeNumber(header.gid, sizeof(header.gid), group);
+    writeNumber(header.size, sizeof(header.size), size);
+    writeNumber(header.mtime, sizeof(header.mtime), static_cast<std::uint64_t>(modificationTime));
+    header.typeFlag = typeFlag;
+    std::memcpy(header.magic, "ustar", 6);
+    std::memcpy(header.version, "00", 2);
+
+    // Checksum is computed with the checksum field filled with spaces
+    std::memset(header.checksum, ' ', sizeof(header.checksum));
+    unsigned checksum = 0;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&header);
+    for (size_t i = 0; i < sizeof(header); ++i)
+    {
+        checksum += bytes[i];
+    }
+    writeNumber(header.checksum, 7, checksum);
+    header.checksum[7] = ' ';
+
+    append(std::string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+}
+
+void TarArchiveWriter::append(std::string_view data)
+{
+    // Large payloads bypass the buffer entirely
+    if (data.size() >= BUFFER_SIZE)
+    {
+        flush();
+        if (!failed && std::fwrite(data.data(), 1, data.size(), out) != data.size())
+        {
+            failed = true;
+        }
+        bytesWritten += data.size();
+        return;
+    }
+
+    if (buffer.size() + data.size() > BUFFER_SIZE)
+    {
+        flush();
+    }
+    buffer.insert(buffer.end(), data.begin(), data.end());
+    bytesWritten += data.size();
+}
+
+void TarArchiveWriter::appendPadding(std::uint64_t size)
+{
+    static const char zeros[BLOCK_SIZE] = {};
+    size_t remainder = static_cast<size_t>(size % BLOCK_SIZE);
+    if (remainder != 0)
+    {
+        append(std::string_view(zeros, BLOCK_SIZE - remainder));
+    }
+}
+
+void TarArchiveWriter::flush()
+{
+    if (!buffer.empty())
+    {
+        if (!failed && std::fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size())
+        {
+            failed = true;
+        }
+        buffer.clear();
+    }
+}
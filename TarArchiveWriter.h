@@ -0,0 +1,116 @@
+#ifndef TAR_ARCHIVE_WRITER_H
+#define TAR_ARCHIVE_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+
+/**
+ * @brief Streams a POSIX ustar archive to a stdio stream
+ *
+ * TarArchiveWriter produces a single sequential stream with constant memory:
+ * entries are encoded into a fixed-size buffer which is flushed whenever it
+ * fills up. Paths that do not fit the ustar name/prefix fields are written
+ * with a pax extended header.
+ */
+class TarArchiveWriter
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param out Stream to write to (not closed by the writer)
+     * @param modificationTime Timestamp stored for every entry
+     */
+    TarArchiveWriter(std::FILE *out, std::time_t modificationTime);
+
+    /**
+     * @brief Sets the owner and permission bits stored for the entries that follow
+     *
+     * @param owner User ID of the entries (0 by default)
+     * @param group Group ID of the entries (0 by default)
+     * @param dirMode Mode of directory entries (0755 by default)
+     * @param fileMode Mode of file entries (0644 by default)
+     */
+    void setOwnership(std::uint64_t owner, std::uint64_t group, unsigned dirMode, unsigned fileMode);
+
+    /**
+     * @brief Adds a directory entry
+     *
+     * @param path Archive path of the directory (without trailing slash)
+     */
+    void addDirectory(const std::string &path);
+
+    /**
+     * @brief Adds a regular file entry
+     *
+     * The content is copied straight into the output buffer, so the same
+     * payload can be passed for every directory without any re-encoding.
+     *
+     * @param path Archive path of the file
+     * @param content File content
+     */
+    void addFile(const std::string &path, std::string_view content);
+
+    /**
+     * @brief Writes the end-of-archive marker and flushes the stream
+     *
+     * @return bool True if every byte was written successfully
+     */
+    bool finish();
+
+    /**
+     * @brief Gets the number of archive bytes produced so far
+     *
+     * @return std::uint64_t Byte count
+     */
+    std::uint64_t getBytesWritten() const;
+
+private:
+    static constexpr size_t BLOCK_SIZE = 512;          // Size of a tar block
+    static constexpr size_t BUFFER_SIZE = 1024 * 1024; // Size of the output buffer
+
+    /**
+     * @brief Writes the header block(s) for an entry
+     *
+     * @param path Archive path
+     * @param typeFlag ustar type flag ('0' for files, '5' for directories)
+     * @param mode Permission bits
+     * @param size Size of the payload that follows
+     */
+    void writeHeader(const std::string &path, char typeFlag, unsigned mode, std::uint64_t size);
+
+    /**
+     * @brief Appends bytes to the output buffer, flushing as needed
+     *
+     * @param data Bytes to append
+     */
+    void append(std::string_view data);
+
+    /**
+     * @brief Appends zero bytes up to the next block boundary
+     *
+     * @param size Size of the payload that was just written
+     */
+    void appendPadding(std::uint64_t size);
+
+    /**
+     * @brief Writes the buffered bytes to the stream
+     */
+    void flush();
+
+    std::FILE *out;                 // Destination stream
+    std::time_t modificationTime;   // Timestamp for all entries
+    std::vector<char> buffer;       // Pending output bytes
+    std::uint64_t bytesWritten;     // Bytes produced so far
+    bool failed;                    // True after a write error
+    std::uint64_t owner;            // User ID stored in every header
+    std::uint64_t group;            // Group ID stored in every header
+    unsigned dirMode;               // Mode of directory entries
+    unsigned fileMode;              // Mode of file entries
+};
+
+#endif // TAR_ARCHIVE_WRITER_H
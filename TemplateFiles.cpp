@@ -1,15 +1,34 @@
 #include "TemplateFiles.h"
+#include "FileSystemBackend.h"
+#include "GitSkeleton.h"
+#include "ErrorLog.h"
 #include <iostream>
-#include <fstream>
 #include <filesystem>
+#include <atomic>
+#include <array>
+#include <iterator>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
-// Get all template files with their content and location
-std::vector<TemplateFiles::TemplateFile> TemplateFiles::getAllTemplateFiles()
+// Progress messages are on by default for the interactive flow
+static std::atomic<bool> verbose{true};
+
+// Lessons become git repositories only on request
+static std::atomic<bool> gitRepository{false};
+
+namespace
 {
-    // Define all template files in a vector for easier maintenance
-    std::vector<TemplateFile> files = {
+    // Template file as embedded in the binary; usable in constant expressions
+    struct EmbeddedTemplate
+    {
+        std::string_view filename;     // Name of the file
+        std::string_view content;      // Content of the file
+        std::string_view subdirectory; // Subdirectory where the file should be placed (empty for root)
+    };
+
+    // Define all template files in one table for easier maintenance
+    constexpr EmbeddedTemplate embeddedTemplates[] = {
         // Main.cpp in root directory
         {
             "main.cpp",
@@ -126,111 +145,209 @@ int main()
 })",
             ".vscode"}};
 
-    return files;
-}
-
-bool TemplateFiles::createTemplateFilesIn(const fs::path &targetDir)
-{
-    try
+    // Content hashes computed by the compiler, so verification never hashes the templates at run time
+    constexpr auto embeddedHashes = []
     {
-        // Get all template files
-        std::vector<TemplateFile> files = getAllTemplateFiles();
-
-        // Ensure the target directory exists
-        if (!createDirectoryIfNeeded(targetDir))
+        std::array<std::uint64_t, std::size(embeddedTemplates)> hashes{};
+        for (size_t i = 0; i < hashes.size(); ++i)
         {
-            return false;
+            hashes[i] = TemplateFiles::hashContent(embeddedTemplates[i].content);
         }
+        return hashes;
+    }();
 
-        // Create all template files
-        bool allSuccessful = true;
-        for (const auto &file : files)
+    // One template inside a lesson directory, built once instead of per directory
+    struct TemplateLayout
+    {
+        fs::path relativePath;               // Path of the file relative to the lesson directory
+        fs::path subdirectory;               // Directory that has to exist first (empty for root)
+        std::vector<fs::path> newDirectories; // Directories first needed by this file, parents first
+        std::string content;                 // Content of the file
+    };
+
+    const std::vector<TemplateLayout> &getTemplateLayouts()
+    {
+        static const std::vector<TemplateLayout> layouts = []
         {
-            // Determine the full path for the file
-            fs::path filePath;
-            if (file.subdirectory.empty())
+            std::vector<TemplateLayout> result;
+            std::vector<fs::path> known;
+            for (auto &file : TemplateFiles::getAllTemplateFiles())
             {
-                // File goes in the root directory
-                filePath = targetDir / file.filename;
-            }
-            else
-            {
-                // File goes in a subdirectory
-                fs::path subDir = targetDir / file.subdirectory;
-                if (!createDirectoryIfNeeded(subDir))
+                TemplateLayout layout;
+                layout.subdirectory = file.subdirectory;
+                layout.relativePath = layout.subdirectory / file.filename;
+                layout.content = std::move(file.content);
+
+                // Nested subdirectories such as ".git/refs/heads" need every missing parent
+                fs::path prefix;
+                for (const auto &part : layout.subdirectory)
                 {
-                    allSuccessful = false;
-                    continue;
+                    prefix /= part;
+                    if (std::find(known.begin(), known.end(), prefix) == known.end())
+                    {
+                        known.push_back(prefix);
+                        layout.newDirectories.push_back(prefix);
+                    }
                 }
-                filePath = subDir / file.filename;
+                result.push_back(std::move(layout));
             }
+            return result;
+        }();
+        return layouts;
+    }
 
-            // Create the file
-            if (!createFile(filePath, file.content))
-            {
-                allSuccessful = false;
-            }
+    std::vector<TemplateFiles::TemplateFile> getEmbeddedTemplateFiles()
+    {
+        std::vector<TemplateFiles::TemplateFile> files;
+        files.reserve(std::size(embeddedTemplates));
+        for (const auto &embedded : embeddedTemplates)
+        {
+            files.push_back({std::string(embedded.filename), std::string(embedded.content),
+                             std::string(embedded.subdirectory)});
         }
-
-        return allSuccessful;
+        return files;
     }
-    catch (const std::exception &e)
+
+    // Repository files for the embedded templates, hashed once per process
+    const std::vector<TemplateFiles::TemplateFile> &getGitSkeletonFiles()
     {
-        std::cerr << "Error creating template files: " << e.what() << std::endl;
-        return false;
+        static const std::vector<TemplateFiles::TemplateFile> skeleton = GitSkeleton::build(getEmbeddedTemplateFiles());
+        return skeleton;
     }
 }
 
-int TemplateFiles::getTemplateFileCount()
+// Get all template files with their content and location
+std::vector<TemplateFiles::TemplateFile> TemplateFiles::getAllTemplateFiles()
 {
-    return getAllTemplateFiles().size();
+    std::vector<TemplateFile> files = getEmbeddedTemplateFiles();
+    if (gitRepository)
+    {
+        const std::vector<TemplateFile> &skeleton = getGitSkeletonFiles();
+        files.insert(files.end(), skeleton.begin(), skeleton.end());
+    }
+    return files;
 }
 
-bool TemplateFiles::createFile(const fs::path &filePath, const std::string &content)
+std::vector<TemplateFiles::TemplateDigest> TemplateFiles::getTemplateDigests()
 {
-    try
+    std::vector<TemplateDigest> digests;
+    digests.reserve(std::size(embeddedTemplates));
+    for (size_t i = 0; i < std::size(embeddedTemplates); ++i)
     {
-        // Open file for writing
-        std::ofstream file(filePath, std::ios::out);
-        if (!file)
-        {
-            std::cerr << "Error: Could not create file: " << filePath << std::endl;
-            return false;
-        }
-
-        // Write content to file
-        file << content;
-        file.close();
-
-        std::cout << "Created file: " << filePath.filename().string() << std::endl;
-        return true;
+        const EmbeddedTemplate &embedded = embeddedTemplates[i];
+        std::string relativePath = embedded.subdirectory.empty()
+                                       ? std::string(embedded.filename)
+                                       : std::string(embedded.subdirectory) + "/" + std::string(embedded.filename);
+        digests.push_back({relativePath, embedded.content.size(), embeddedHashes[i]});
     }
-    catch (const std::exception &e)
+    return digests;
+}
+
+bool TemplateFiles::createTemplateFilesIn(const fs::path &targetDir)
+{
+    // Ensure the target directory exists and open it for relative writes
+    std::error_code ec;
+    bool created = false;
+    FileSystemBackend::DirectoryHandle dir = FileSystemBackend::getActive().createAndOpenDirectory(targetDir, created, ec);
+    if (ec)
     {
-        std::cerr << "Error writing file: " << e.what() << std::endl;
+        ErrorLog::record("create directory", ec, targetDir);
         return false;
     }
+    if (created && verbose)
+    {
+        std::cout << "Created directory: " << targetDir.string() << std::endl;
+    }
+
+    return createTemplateFilesIn(dir);
 }
 
-bool TemplateFiles::createDirectoryIfNeeded(const fs::path &dirPath)
+bool TemplateFiles::createTemplateFilesIn(const FileSystemBackend::DirectoryHandle &targetDir)
 {
-    try
+    // Failures are recorded in the ErrorLog rather than thrown, so a failing tree is as cheap as a working one
+    const std::vector<TemplateLayout> &layouts = getTemplateLayouts();
+    bool allSuccessful = true;
+    bool subdirectoryReady = true;
+    for (const TemplateLayout &layout : layouts)
     {
-        // Create directory if it doesn't exist
-        if (!fs::exists(dirPath))
+        // Create each template subdirectory once, before its first file
+        if (!layout.newDirectories.empty())
         {
-            if (!fs::create_directories(dirPath))
+            subdirectoryReady = true;
+            for (const auto &directory : layout.newDirectories)
             {
-                std::cerr << "Error: Could not create directory: " << dirPath << std::endl;
-                return false;
+                subdirectoryReady = subdirectoryReady && createDirectoryIfNeeded(targetDir, directory);
             }
-            std::cout << "Created directory: " << dirPath.string() << std::endl;
         }
-        return true;
+        if (!layout.subdirectory.empty() && !subdirectoryReady)
+        {
+            allSuccessful = false;
+            continue;
+        }
+
+        // Create the file
+        if (!createFile(targetDir, layout.relativePath, layout.content))
+        {
+            allSuccessful = false;
+        }
     }
-    catch (const std::exception &e)
+
+    return allSuccessful;
+}
+
+void TemplateFiles::setVerbose(bool enabled)
+{
+    verbose = enabled;
+}
+
+void TemplateFiles::setGitRepository(bool enabled)
+{
+    gitRepository = enabled;
+}
+
+bool TemplateFiles::isGitRepository()
+{
+    return gitRepository;
+}
+
+int TemplateFiles::getTemplateFileCount()
+{
+    return getAllTemplateFiles().size();
+}
+
+bool TemplateFiles::createFile(const FileSystemBackend::DirectoryHandle &dir, const fs::path &relativePath,
+                               std::string_view content)
+{
+    // Create the file and write its content through the active backend
+    std::error_code ec;
+    FileSystemBackend::getActive().writeFileAt(dir, relativePath, content, ec);
+    if (ec)
     {
-        std::cerr << "Error creating directory: " << e.what() << std::endl;
+        ErrorLog::record("write file", ec, dir.getPath(), relativePath);
         return false;
     }
+
+    if (verbose)
+    {
+        std::cout << "Created file: " << relativePath.filename().string() << std::endl;
+    }
+    return true;
+}
+
+bool TemplateFiles::createDirectoryIfNeeded(const FileSystemBackend::DirectoryHandle &dir, const fs::path &relativePath)
+{
+    // Create directory if it doesn't exist; an existing directory (possibly
+    // created by a concurrent process a moment ago) is not an error
+    std::error_code ec;
+    bool created = FileSystemBackend::getActive().createDirectoryAt(dir, relativePath, ec);
+    if (ec)
+    {
+        ErrorLog::record("create directory", ec, dir.getPath(), relativePath);
+        return false;
+    }
+    if (created && verbose)
+    {
+        std::cout << "Created directory: " << (dir.getPath() / relativePath).string() << std::endl;
+    }
+    return true;
 }
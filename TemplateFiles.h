@@ -4,6 +4,9 @@
 #include <string>
 #include <filesystem>
 #include <vector>
+#include <string_view>
+#include <cstdint>
+#include "FileSystemBackend.h"
 
 namespace fs = std::filesystem;
 
@@ -26,6 +29,45 @@ public:
         std::string subdirectory; // Subdirectory where the file should be placed (empty for root)
     };
 
+    /**
+     * @brief Structure describing the expected size and hash of a template file
+     */
+    struct TemplateDigest
+    {
+        std::string relativePath; // Path relative to a lesson directory ("/" separated)
+        std::uint64_t size;       // Content size in bytes
+        std::uint64_t hash;       // FNV-1a hash of the content
+    };
+
+    /**
+     * @brief Computes the 64-bit FNV-1a hash of some content
+     *
+     * Usable at compile time; pass the previous result as seed to hash
+     * content that arrives in chunks.
+     *
+     * @param content Bytes to hash
+     * @param seed Hash of the preceding chunks (the FNV offset basis for the first)
+     * @return std::uint64_t Hash value
+     */
+    static constexpr std::uint64_t hashContent(std::string_view content,
+                                               std::uint64_t seed = 14695981039346656037ull)
+    {
+        std::uint64_t hash = seed;
+        for (char c : content)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Gets the expected size and compile-time hash of every template file
+     *
+     * @return std::vector<TemplateDigest> One digest per template file
+     */
+    static std::vector<TemplateDigest> getTemplateDigests();
+
     /**
      * @brief Creates all template files in the specified directory
      *
@@ -34,6 +76,38 @@ public:
      */
     static bool createTemplateFilesIn(const fs::path &targetDir);
 
+    /**
+     * @brief Creates all template files in an already open directory
+     *
+     * @param targetDir Open directory where template files should be created
+     * @return bool True if all files were created successfully
+     */
+    static bool createTemplateFilesIn(const FileSystemBackend::DirectoryHandle &targetDir);
+
+    /**
+     * @brief Enables or disables per-file progress messages
+     *
+     * @param enabled True to print a line for every created file and directory
+     */
+    static void setVerbose(bool enabled);
+
+    /**
+     * @brief Makes every lesson a git repository whose initial commit holds the templates
+     *
+     * The `.git` skeleton is built once, on first use, and then written like the other
+     * template files; call this before the first directory is templated.
+     *
+     * @param enabled True to add the GitSkeleton files to the templates
+     */
+    static void setGitRepository(bool enabled);
+
+    /**
+     * @brief Checks whether lessons are made git repositories
+     *
+     * @return bool True after setGitRepository(true)
+     */
+    static bool isGitRepository();
+
     /**
      * @brief Gets the number of template files
      *
@@ -42,18 +116,19 @@ public:
     static int getTemplateFileCount();
 
     /**
-     * @brief Gets a list of all template files
+     * @brief Gets a list of all template files, including the git skeleton if enabled
      *
      * @return std::vector<TemplateFile> List of all template files
      */
     static std::vector<TemplateFile> getAllTemplateFiles();
 
 private:
-    // Helper method to create a file with the given content
-    static bool createFile(const fs::path &filePath, const std::string &content);
+    // Helper method to create a file with the given content relative to an open directory
+    static bool createFile(const FileSystemBackend::DirectoryHandle &dir, const fs::path &relativePath,
+                           std::string_view content);
 
-    // Helper method to create a directory if it doesn't exist
-    static bool createDirectoryIfNeeded(const fs::path &dirPath);
+    // Helper method to create a directory relative to an open directory if it doesn't exist
+    static bool createDirectoryIfNeeded(const FileSystemBackend::DirectoryHandle &dir, const fs::path &relativePath);
 
     // Template file contents defined in the implementation file
 };
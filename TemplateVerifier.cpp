@@ -0,0 +1,253 @@
+#include "TemplateVerifier.h"
+#include "SubdirectoryStream.h"
+#include "StemLayout.h"
+#include "StemIndex.h"
+#include "FileSystemBackend.h"
+#include "PosixFileSystemBackend.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Size of the per-thread read buffer
+    constexpr size_t READ_BUFFER_SIZE = 256 * 1024;
+
+    // Appends "label a, b, c" to a report line
+    void appendList(std::string &line, const char *label, const std::vector<std::string> &names)
+    {
+        if (names.empty())
+            return;
+        line += line.empty() ? "" : "; ";
+        line += label;
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            line += (i == 0 ? " " : ", ") + names[i];
+        }
+    }
+}
+
+TemplateVerifier::TemplateVerifier(size_t batchSize, size_t memoryLimit)
+    : batchSize(batchSize), memoryLimit(memoryLimit), digests(TemplateFiles::getTemplateDigests())
+{
+    // Derive the expected names at each level from the template paths
+    for (const auto &digest : digests)
+    {
+        size_t slash = digest.relativePath.find('/');
+        std::string first = digest.relativePath.substr(0, slash);
+        if (std::find(rootNames.begin(), rootNames.end(), first) == rootNames.end())
+        {
+            rootNames.push_back(first);
+        }
+        if (slash == std::string::npos)
+            continue;
+
+        auto it = std::find_if(subdirectoryNames.begin(), subdirectoryNames.end(), [&first](const auto &entry)
+                               { return entry.first == first; });
+        if (it == subdirectoryNames.end())
+        {
+            subdirectoryNames.push_back({first, {}});
+            it = subdirectoryNames.end() - 1;
+        }
+        it->second.push_back(digest.relativePath.substr(slash + 1));
+    }
+
+    // A lesson's repository changes as soon as it is used, so only its presence is expected
+    if (TemplateFiles::isGitRepository())
+    {
+        rootNames.push_back(".git");
+    }
+}
+
+bool TemplateVerifier::verifyStem(const fs::path &stemDir, ThreadPool &pool, Result &result)
+{
+    if (!FileSystemBackend::getActive().status(stemDir).isDirectory)
+    {
+        std::cerr << "Error: Directory does not exist: " << stemDir.string() << std::endl;
+        return false;
+    }
+
+    SubdirectoryStream stream(stemDir, batchSize, memoryLimit, true);
+    std::vector<Findings> findings;
+    std::unordered_map<std::string, std::uint8_t> states;
+    bool recordStates = StemIndex::isSupported();
+    bool success = stream.forEachBatch([&](const std::vector<fs::path> &batch)
+                               {
+        // Check the batch in parallel, then report it in order
+        findings.assign(batch.size(), Findings());
+        pool.parallelFor(batch.size(), [&](size_t i)
+                         { findings[i] = verifyDirectory(batch[i]); });
+
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            const Findings &found = findings[i];
+            result.directoriesChecked++;
+            result.missingFiles += found.missing.size();
+            result.modifiedFiles += found.modified.size();
+            result.extraFiles += found.extra.size();
+            result.leftoverFiles += found.leftover.size();
+            result.bytesRead += found.bytesRead;
+
+            std::string line = found.error;
+            appendList(line, "missing", found.missing);
+            appendList(line, "modified", found.modified);
+            appendList(line, "extra", found.extra);
+            appendList(line, "leftover", found.leftover);
+            if (line.empty())
+            {
+                result.directoriesClean++;
+            }
+            else
+            {
+                std::cout << batch[i].string() << ": " << line << std::endl;
+            }
+            if (recordStates)
+            {
+                states[StemLayout::entryName(stemDir, batch[i])] = line.empty() ? StemIndex::STATE_VERIFIED : StemIndex::STATE_DIFFERS;
+            }
+        }
+        return true; });
+
+    // Remember the outcome in the stem index for later runs
+    if (success && recordStates)
+    {
+        StemIndex(stemDir).recordStates(states);
+    }
+    return success;
+}
+
+TemplateVerifier::Findings TemplateVerifier::verifyDirectory(const fs::path &dir) const
+{
+    Findings findings;
+    for (const auto &digest : digests)
+    {
+        if (!checkFile(dir, digest, findings))
+        {
+            findings.missing.push_back(digest.relativePath);
+        }
+    }
+
+    try
+    {
+        collectExtras(dir, "", rootNames, findings);
+        for (const auto &[subdirectory, names] : subdirectoryNames)
+        {
+            if (FileSystemBackend::getActive().status(dir / subdirectory).isDirectory)
+            {
+                collectExtras(dir / subdirectory, subdirectory + "/", names, findings);
+            }
+        }
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        findings.error = std::string("unreadable (") + e.code().message() + ")";
+    }
+    return findings;
+}
+
+bool TemplateVerifier::checkFile(const fs::path &dir, const TemplateFiles::TemplateDigest &digest,
+                                 Findings &findings) const
+{
+    fs::path filePath = dir / digest.relativePath;
+    std::uint64_t hash = TemplateFiles::hashContent({});
+    thread_local std::vector<char> buffer(READ_BUFFER_SIZE);
+
+#ifdef _WIN32
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(filePath, ec);
+    if (ec)
+    {
+        return false;
+    }
+    if (size != digest.size)
+    {
+        findings.modified.push_back(digest.relativePath);
+        return true;
+    }
+
+    std::ifstream file(filePath, std::ios::binary);
+    while (file)
+    {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize count = file.gcount();
+        hash = TemplateFiles::hashContent(std::string_view(buffer.data(), static_cast<size_t>(count)), hash);
+        findings.bytesRead += static_cast<std::uint64_t>(count);
+    }
+#else
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errno == ENOENT || errno == ENOTDIR)
+        {
+            return false;
+        }
+        findings.modified.push_back(digest.relativePath + " (unreadable)");
+        return true;
+    }
+
+    // Different size means different content; skip the read
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<std::uint64_t>(st.st_size) != digest.size)
+    {
+        ::close(fd);
+        findings.modified.push_back(digest.relativePath);
+        return true;
+    }
+
+    while (true)
+    {
+        ssize_t count = ::read(fd, buffer.data(), buffer.size());
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+        hash = TemplateFiles::hashContent(std::string_view(buffer.data(), static_cast<size_t>(count)), hash);
+        findings.bytesRead += static_cast<std::uint64_t>(count);
+    }
+    ::close(fd);
+#endif
+
+    if (hash != digest.hash)
+    {
+        findings.modified.push_back(digest.relativePath);
+    }
+    return true;
+}
+
+void TemplateVerifier::collectExtras(const fs::path &dir, const std::string &prefix,
+                                     const std::vector<std::string> &expected, Findings &findings) const
+{
+    std::vector<std::string> extras;
+    std::vector<std::string> leftovers;
+    FileSystemBackend::getActive().forEachEntry(dir, [&](const FileSystemBackend::DirectoryEntry &entry)
+                                                {
+        if (std::find(expected.begin(), expected.end(), entry.name) != expected.end())
+        {
+            return;
+        }
+        if (!entry.isDirectory && PosixFileSystemBackend::isTemporaryName(entry.name))
+        {
+            leftovers.push_back(prefix + entry.name);
+        }
+        else
+        {
+            extras.push_back(prefix + entry.name + (entry.isDirectory ? "/" : ""));
+        } });
+
+    std::sort(extras.begin(), extras.end());
+    std::sort(leftovers.begin(), leftovers.end());
+    findings.extra.insert(findings.extra.end(), extras.begin(), extras.end());
+    findings.leftover.insert(findings.leftover.end(), leftovers.begin(), leftovers.end());
+}
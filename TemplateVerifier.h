@@ -0,0 +1,90 @@
+#ifndef TEMPLATE_VERIFIER_H
+#define TEMPLATE_VERIFIER_H
+
+#include "TemplateFiles.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+class ThreadPool;
+
+/**
+ * @brief Audits lesson directories against the embedded templates
+ *
+ * TemplateVerifier checks every subdirectory of a stem for missing template
+ * files, template files whose content differs from the embedded version and
+ * extra files next to them. Temporary files left behind by an interrupted
+ * template write are recognised and reported as leftovers, not as user
+ * files. A size mismatch marks a file as modified without
+ * reading it; only files of the right size are read and compared against the
+ * hash the compiler computed for the template. Subdirectories are checked in
+ * parallel, batch by batch, and only directories with findings are reported.
+ */
+class TemplateVerifier
+{
+public:
+    /**
+     * @brief Structure summarizing a verification run
+     */
+    struct Result
+    {
+        size_t directoriesChecked = 0; // Subdirectories examined
+        size_t directoriesClean = 0;   // Subdirectories matching the templates exactly
+        size_t missingFiles = 0;       // Template files not present
+        size_t modifiedFiles = 0;      // Template files with different content
+        size_t extraFiles = 0;         // Entries that are not part of the templates
+        size_t leftoverFiles = 0;      // Temporary files left by interrupted template writes
+        std::uint64_t bytesRead = 0;   // Bytes read to compare contents
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param batchSize Subdirectories checked per batch
+     * @param memoryLimit Approximate bytes of names held while sorting a stem
+     */
+    TemplateVerifier(size_t batchSize, size_t memoryLimit);
+
+    /**
+     * @brief Verifies every subdirectory of a stem and prints the findings
+     *
+     * @param stemDir Stem directory to audit
+     * @param pool Worker pool used for the checks
+     * @param result Accumulates the counts of this and earlier stems
+     * @return bool True if the stem could be read
+     */
+    bool verifyStem(const fs::path &stemDir, ThreadPool &pool, Result &result);
+
+private:
+    // Findings for one subdirectory
+    struct Findings
+    {
+        std::vector<std::string> missing;  // Missing template files
+        std::vector<std::string> modified; // Template files with different content
+        std::vector<std::string> extra;    // Entries not part of the templates
+        std::vector<std::string> leftover; // Temporary files of interrupted template writes
+        std::uint64_t bytesRead = 0;       // Bytes read for hashing
+        std::string error;                 // Set if the directory could not be read
+    };
+
+    // Checks one subdirectory against the template digests
+    Findings verifyDirectory(const fs::path &dir) const;
+
+    // Compares one file with its digest; returns false if it is missing
+    bool checkFile(const fs::path &dir, const TemplateFiles::TemplateDigest &digest, Findings &findings) const;
+
+    // Lists the names in dirPath that are not in expected, telling leftover temporary files apart
+    void collectExtras(const fs::path &dir, const std::string &prefix, const std::vector<std::string> &expected,
+                       Findings &findings) const;
+
+    size_t batchSize;                                   // Subdirectories per batch
+    size_t memoryLimit;                                 // Sort budget for stem enumeration
+    std::vector<TemplateFiles::TemplateDigest> digests; // Expected template files
+    std::vector<std::string> rootNames;                 // Names expected directly in a lesson directory
+    std::vector<std::pair<std::string, std::vector<std::string>>> subdirectoryNames; // Names expected per template subdirectory
+};
+
+#endif // TEMPLATE_VERIFIER_H
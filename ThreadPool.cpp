@@ -0,0 +1,155 @@
+#include "ThreadPool.h"
+#include "ProcessPriority.h"
+#include "Jobserver.h"
+#include <atomic>
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount, bool shareJobTokens) : pending(0), stopping(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = getDefaultThreadCount();
+    }
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, shareJobTokens && i > 0);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+        pending++;
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this]
+                 { return pending == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &body)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // One task per worker; each pulls indices from a shared counter
+    std::atomic<size_t> next{0};
+    size_t taskCount = std::min(count, workers.size());
+    for (size_t t = 0; t < taskCount; ++t)
+    {
+        submit([&next, count, &body]
+               {
+                   for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                   {
+                       body(i);
+                   } });
+    }
+    wait();
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+    return workers.size();
+}
+
+size_t ThreadPool::getDefaultThreadCount()
+{
+    size_t count = std::thread::hardware_concurrency();
+    if (count == 0)
+    {
+        count = 1;
+    }
+
+    // Workers beyond make's job limit could never get a token
+    size_t jobLimit = Jobserver::getJobLimit();
+    return jobLimit > 0 ? std::min(count, jobLimit) : count;
+}
+
+void ThreadPool::workerLoop(bool gated)
+{
+    ProcessPriority::applyWorkerNiceLevel();
+
+    bool holdingToken = false;
+    char token = 0;
+    auto tasksQueued = [this]
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !tasks.empty();
+    };
+
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this]
+                               { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+            {
+                return; // Stopping and nothing left to do
+            }
+
+            if (gated && !holdingToken && Jobserver::isActive())
+            {
+                // Wait for a job slot without holding the lock; give up if other workers drain the queue
+                lock.unlock();
+                holdingToken = Jobserver::acquire(token, tasksQueued);
+                lock.lock();
+                if (tasks.empty() || (!holdingToken && Jobserver::isActive()))
+                {
+                    if (holdingToken)
+                    {
+                        Jobserver::release(token);
+                        holdingToken = false;
+                    }
+                    continue;
+                }
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+            if (pending == 0)
+            {
+                allDone.notify_all();
+            }
+
+            // Hand the slot back to make as soon as there is nothing left to run
+            if (holdingToken && tasks.empty())
+            {
+                Jobserver::release(token);
+                holdingToken = false;
+            }
+        }
+    }
+}
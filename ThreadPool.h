@@ -0,0 +1,92 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+/**
+ * @brief Fixed-size pool of worker threads
+ *
+ * ThreadPool runs submitted tasks on a set of long-lived workers. Tasks must
+ * not throw; callers report failures through their own result objects.
+ *
+ * Inside a `make -j` build with a jobserver, the first worker runs on the
+ * process's implicit job slot and every other worker takes a job token before
+ * it starts a task, returning it once the queue is empty. The pool then never
+ * runs more tasks at once than make allows. Pools whose tasks wait on each
+ * other must not be gated this way; they reserve tokens with
+ * Jobserver::Reservation and pass shareJobTokens = false.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief Constructor starts the workers
+     *
+     * @param threadCount Number of workers (0 selects the default thread count)
+     * @param shareJobTokens True to take make jobserver tokens for all but the first worker
+     */
+    explicit ThreadPool(size_t threadCount = 0, bool shareJobTokens = true);
+
+    /**
+     * @brief Destructor waits for queued tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Queues a task for execution
+     *
+     * @param task Task to run on a worker
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until every queued task has finished
+     */
+    void wait();
+
+    /**
+     * @brief Runs body(i) for every i in [0, count) on the workers and waits
+     *
+     * Indices are handed out dynamically so uneven work balances itself.
+     *
+     * @param count Number of iterations
+     * @param body Function called once per index
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)> &body);
+
+    /**
+     * @brief Gets the number of workers
+     *
+     * @return size_t Worker count
+     */
+    size_t getThreadCount() const;
+
+    /**
+     * @brief Gets the default worker count for this machine
+     *
+     * @return size_t Hardware concurrency, capped at make's -j limit under a jobserver, at least 1
+     */
+    static size_t getDefaultThreadCount();
+
+private:
+    // Worker loop: pops and runs tasks until stopped; workers after the first take job tokens if gated
+    void workerLoop(bool gated);
+
+    std::vector<std::thread> workers;        // Worker threads
+    std::deque<std::function<void()>> tasks; // Pending tasks
+    std::mutex mutex;                        // Guards tasks, pending and stopping
+    std::condition_variable taskAvailable;   // Signalled when a task is queued
+    std::condition_variable allDone;         // Signalled when pending drops to zero
+    size_t pending;                          // Queued plus running tasks
+    bool stopping;                           // True once the destructor runs
+};
+
+#endif // THREAD_POOL_H
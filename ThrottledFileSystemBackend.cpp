@@ -0,0 +1,153 @@
+#include "ThrottledFileSystemBackend.h"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+ThrottledFileSystemBackend::ThrottledFileSystemBackend(std::unique_ptr<FileSystemBackend> inner,
+                                                       double operationsPerSecond, double bytesPerSecond)
+    : inner(std::move(inner))
+{
+    // A 100 ms burst keeps short runs honest without penalizing single large writes
+    if (operationsPerSecond > 0)
+    {
+        operations = std::make_unique<TokenBucket>(operationsPerSecond, std::max(1.0, operationsPerSecond / 10));
+    }
+    if (bytesPerSecond > 0)
+    {
+        bytes = std::make_unique<TokenBucket>(bytesPerSecond, std::max(1.0, bytesPerSecond / 10));
+    }
+}
+
+void ThrottledFileSystemBackend::throttle(size_t byteCount)
+{
+    std::chrono::microseconds waited(0);
+    if (operations)
+    {
+        waited += operations->acquire(1);
+    }
+    if (bytes && byteCount > 0)
+    {
+        waited += bytes->acquire(static_cast<double>(byteCount));
+    }
+    if (waited.count() > 0)
+    {
+        throttledMicros.fetch_add(waited.count(), std::memory_order_relaxed);
+    }
+}
+
+bool ThrottledFileSystemBackend::createDirectory(const fs::path &dirPath)
+{
+    throttle(0);
+    return inner->createDirectory(dirPath);
+}
+
+void ThrottledFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content)
+{
+    throttle(content.size());
+    inner->writeFile(filePath, content);
+}
+
+bool ThrottledFileSystemBackend::createDirectory(const fs::path &dirPath, std::error_code &ec)
+{
+    throttle(0);
+    return inner->createDirectory(dirPath, ec);
+}
+
+void ThrottledFileSystemBackend::writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec)
+{
+    throttle(content.size());
+    inner->writeFile(filePath, content, ec);
+}
+
+FileSystemBackend::DirectoryHandle ThrottledFileSystemBackend::createAndOpenDirectory(const fs::path &dirPath,
+                                                                                      bool &created)
+{
+    throttle(0);
+    return inner->createAndOpenDirectory(dirPath, created);
+}
+
+FileSystemBackend::DirectoryHandle ThrottledFileSystemBackend::createAndOpenDirectory(const fs::path &dirPath,
+                                                                                      bool &created,
+                                                                                      std::error_code &ec)
+{
+    throttle(0);
+    return inner->createAndOpenDirectory(dirPath, created, ec);
+}
+
+FileSystemBackend::DirectoryHandle ThrottledFileSystemBackend::openDirectory(const fs::path &dirPath)
+{
+    throttle(0);
+    return inner->openDirectory(dirPath);
+}
+
+bool ThrottledFileSystemBackend::createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath)
+{
+    throttle(0);
+    return inner->createDirectoryAt(parent, relativePath);
+}
+
+bool ThrottledFileSystemBackend::createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath,
+                                                   std::error_code &ec)
+{
+    throttle(0);
+    return inner->createDirectoryAt(parent, relativePath, ec);
+}
+
+void ThrottledFileSystemBackend::writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath,
+                                             std::string_view content)
+{
+    throttle(content.size());
+    inner->writeFileAt(parent, relativePath, content);
+}
+
+void ThrottledFileSystemBackend::writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath,
+                                             std::string_view content, std::error_code &ec)
+{
+    throttle(content.size());
+    inner->writeFileAt(parent, relativePath, content, ec);
+}
+
+void ThrottledFileSystemBackend::renameEntry(const fs::path &from, const fs::path &to)
+{
+    throttle(0);
+    inner->renameEntry(from, to);
+}
+
+std::vector<FileSystemBackend::DirectoryEntry> ThrottledFileSystemBackend::listDirectory(const fs::path &dirPath)
+{
+    throttle(0);
+    return inner->listDirectory(dirPath);
+}
+
+void ThrottledFileSystemBackend::forEachEntry(const fs::path &dirPath,
+                                              const std::function<void(const DirectoryEntry &)> &visitor)
+{
+    throttle(0);
+    inner->forEachEntry(dirPath, visitor);
+}
+
+FileSystemBackend::FileStatus ThrottledFileSystemBackend::status(const fs::path &path)
+{
+    throttle(0);
+    return inner->status(path);
+}
+
+bool ThrottledFileSystemBackend::isOnDisk() const
+{
+    return inner->isOnDisk();
+}
+
+std::string ThrottledFileSystemBackend::getName() const
+{
+    return inner->getName() + "+throttled";
+}
+
+std::chrono::microseconds ThrottledFileSystemBackend::getThrottledTime() const
+{
+    return std::chrono::microseconds(throttledMicros.load(std::memory_order_relaxed));
+}
+
+FileSystemBackend &ThrottledFileSystemBackend::getInner()
+{
+    return *inner;
+}
@@ -0,0 +1,74 @@
+#ifndef THROTTLED_FILE_SYSTEM_BACKEND_H
+#define THROTTLED_FILE_SYSTEM_BACKEND_H
+
+#include "FileSystemBackend.h"
+#include "TokenBucket.h"
+#include <chrono>
+#include <atomic>
+
+/**
+ * @brief Backend wrapper that limits operations and bytes per second
+ *
+ * ThrottledFileSystemBackend lets large runs share a disk with
+ * latency-sensitive services. Every operation takes a token from the
+ * operation bucket and every write additionally takes one token per byte
+ * from the byte bucket before being forwarded. Either limit may be disabled.
+ * Time spent waiting for tokens is summed across all threads.
+ */
+class ThrottledFileSystemBackend : public FileSystemBackend
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param inner Backend that performs the actual operations
+     * @param operationsPerSecond Maximum operations per second (0 for unlimited)
+     * @param bytesPerSecond Maximum bytes written per second (0 for unlimited)
+     */
+    ThrottledFileSystemBackend(std::unique_ptr<FileSystemBackend> inner, double operationsPerSecond,
+                               double bytesPerSecond);
+
+    bool createDirectory(const fs::path &dirPath) override;
+    void writeFile(const fs::path &filePath, std::string_view content) override;
+    bool createDirectory(const fs::path &dirPath, std::error_code &ec) override;
+    void writeFile(const fs::path &filePath, std::string_view content, std::error_code &ec) override;
+    DirectoryHandle createAndOpenDirectory(const fs::path &dirPath, bool &created) override;
+    DirectoryHandle createAndOpenDirectory(const fs::path &dirPath, bool &created, std::error_code &ec) override;
+    DirectoryHandle openDirectory(const fs::path &dirPath) override;
+    bool createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath) override;
+    bool createDirectoryAt(const DirectoryHandle &parent, const fs::path &relativePath, std::error_code &ec) override;
+    void writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content) override;
+    void writeFileAt(const DirectoryHandle &parent, const fs::path &relativePath, std::string_view content,
+                     std::error_code &ec) override;
+    void renameEntry(const fs::path &from, const fs::path &to) override;
+    std::vector<DirectoryEntry> listDirectory(const fs::path &dirPath) override;
+    void forEachEntry(const fs::path &dirPath, const std::function<void(const DirectoryEntry &)> &visitor) override;
+    FileStatus status(const fs::path &path) override;
+    bool isOnDisk() const override;
+    std::string getName() const override;
+
+    /**
+     * @brief Gets the total time callers spent waiting for tokens
+     *
+     * @return std::chrono::microseconds Throttled time summed over all threads
+     */
+    std::chrono::microseconds getThrottledTime() const;
+
+    /**
+     * @brief Gets the wrapped backend
+     *
+     * @return FileSystemBackend& The inner backend
+     */
+    FileSystemBackend &getInner();
+
+private:
+    // Takes one operation token and, for writes, one byte token per byte
+    void throttle(size_t bytes);
+
+    std::unique_ptr<FileSystemBackend> inner;   // Backend doing the real work
+    std::unique_ptr<TokenBucket> operations;    // Operation limit (null when unlimited)
+    std::unique_ptr<TokenBucket> bytes;         // Byte limit (null when unlimited)
+    std::atomic<long long> throttledMicros{0};  // Time spent waiting for tokens
+};
+
+#endif // THROTTLED_FILE_SYSTEM_BACKEND_H
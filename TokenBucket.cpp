@@ -0,0 +1,40 @@
+#include "TokenBucket.h"
+#include <thread>
+
+TokenBucket::TokenBucket(double ratePerSecond, double burst)
+    : ratePerSecond(ratePerSecond), burst(burst > 0 ? burst : ratePerSecond), available(this->burst),
+      refilled(std::chrono::steady_clock::now())
+{
+}
+
+std::chrono::microseconds TokenBucket::acquire(double tokens)
+{
+    std::chrono::duration<double> wait(0);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Refill for the time elapsed since the last call
+        auto now = std::chrono::steady_clock::now();
+        available += std::chrono::duration<double>(now - refilled).count() * ratePerSecond;
+        if (available > burst)
+        {
+            available = burst;
+        }
+        refilled = now;
+
+        // Reserve the tokens; a deficit is paid for by sleeping outside the lock
+        available -= tokens;
+        if (available < 0)
+        {
+            wait = std::chrono::duration<double>(-available / ratePerSecond);
+        }
+    }
+
+    if (wait.count() <= 0)
+    {
+        return std::chrono::microseconds(0);
+    }
+    auto sleep = std::chrono::duration_cast<std::chrono::microseconds>(wait);
+    std::this_thread::sleep_for(sleep);
+    return sleep;
+}
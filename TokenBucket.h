@@ -0,0 +1,42 @@
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <chrono>
+#include <mutex>
+
+/**
+ * @brief Thread-safe token bucket rate limiter
+ *
+ * TokenBucket refills at a fixed rate up to a burst capacity. acquire()
+ * reserves tokens immediately and sleeps until the bucket would have held
+ * them, so concurrent callers queue up fairly and requests larger than the
+ * burst still complete at the configured average rate.
+ */
+class TokenBucket
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param ratePerSecond Tokens added per second
+     * @param burst Maximum number of tokens the bucket holds (0 selects one second's worth)
+     */
+    explicit TokenBucket(double ratePerSecond, double burst = 0);
+
+    /**
+     * @brief Takes tokens, sleeping until they are available
+     *
+     * @param tokens Number of tokens to take
+     * @return std::chrono::microseconds Time spent sleeping
+     */
+    std::chrono::microseconds acquire(double tokens);
+
+private:
+    double ratePerSecond;                          // Refill rate
+    double burst;                                  // Capacity
+    double available;                              // Current tokens; negative when reserved ahead
+    std::chrono::steady_clock::time_point refilled; // Time of the last refill
+    std::mutex mutex;                              // Guards available and refilled
+};
+
+#endif // TOKEN_BUCKET_H
@@ -0,0 +1,390 @@
+#include "TreeCleaner.h"
+#include "DirectorySynchronizer.h"
+#include "StemLayout.h"
+#include "FileSystemBackend.h"
+#include "TemplateFiles.h"
+#include "PosixFileSystemBackend.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <mutex>
+#include <cstring>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Serializes error output from worker threads
+    std::mutex outputMutex;
+
+#ifndef _WIN32
+    // Removes a directory and its contents relative to parentFd; returns 0 or the first errno
+    int removeTreeAt(int parentFd, const char *name, size_t &removed)
+    {
+        int fd = ::openat(parentFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return errno;
+        }
+        DIR *dir = ::fdopendir(fd);
+        if (!dir)
+        {
+            int error = errno;
+            ::close(fd);
+            return error;
+        }
+
+        int firstError = 0;
+        while (struct dirent *entry = ::readdir(dir))
+        {
+            if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0)
+                continue;
+
+            // d_type tells directories apart without a stat; when it is unknown, unlink says so
+            int result = 0;
+            if (entry->d_type == DT_DIR)
+            {
+                result = removeTreeAt(fd, entry->d_name, removed);
+            }
+            else if (::unlinkat(fd, entry->d_name, 0) == 0)
+            {
+                removed++;
+            }
+            else if (entry->d_type == DT_UNKNOWN && (errno == EISDIR || errno == EPERM))
+            {
+                result = removeTreeAt(fd, entry->d_name, removed);
+            }
+            else
+            {
+                result = errno;
+            }
+
+            if (result != 0 && firstError == 0)
+            {
+                firstError = result;
+            }
+        }
+        ::closedir(dir);
+
+        if (firstError == 0)
+        {
+            if (::unlinkat(parentFd, name, AT_REMOVEDIR) == 0)
+            {
+                removed++;
+            }
+            else
+            {
+                firstError = errno;
+            }
+        }
+        return firstError;
+    }
+
+    // Removes the temporary files interrupted template writes left in a directory; returns how many
+    size_t removeTemporaryFilesAt(int parentFd, const char *relativePath)
+    {
+        int fd = ::openat(parentFd, relativePath, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return 0;
+        }
+        DIR *dir = ::fdopendir(fd);
+        if (!dir)
+        {
+            ::close(fd);
+            return 0;
+        }
+
+        std::vector<std::string> names;
+        while (struct dirent *entry = ::readdir(dir))
+        {
+            if (entry->d_type != DT_DIR && PosixFileSystemBackend::isTemporaryName(entry->d_name))
+            {
+                names.push_back(entry->d_name);
+            }
+        }
+        size_t removed = 0;
+        for (const auto &name : names)
+        {
+            if (::unlinkat(fd, name.c_str(), 0) == 0)
+                removed++;
+        }
+        ::closedir(dir);
+        return removed;
+    }
+#else
+    // Removes the temporary files interrupted template writes left in a directory; returns how many
+    size_t removeTemporaryFiles(const fs::path &dir)
+    {
+        std::error_code ec;
+        std::vector<fs::path> paths;
+        for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator(); it.increment(ec))
+        {
+            if (!it->is_directory(ec) && PosixFileSystemBackend::isTemporaryName(it->path().filename().string()))
+            {
+                paths.push_back(it->path());
+            }
+        }
+        size_t removed = 0;
+        for (const auto &path : paths)
+        {
+            if (fs::remove(path, ec))
+                removed++;
+        }
+        return removed;
+    }
+#endif
+}
+
+TreeCleaner::TreeCleaner(const fs::path &stemDir, bool keepUserFiles) : stemDir(stemDir), keepUserFiles(keepUserFiles)
+{
+    // Resolve the template layout once instead of once per directory
+    for (const auto &file : TemplateFiles::getAllTemplateFiles())
+    {
+        templatePaths.push_back(fs::path(file.subdirectory) / file.filename);
+        fs::path prefix;
+        for (const auto &part : fs::path(file.subdirectory))
+        {
+            prefix /= part;
+            if (std::find(templateDirs.begin(), templateDirs.end(), prefix) == templateDirs.end())
+            {
+                templateDirs.push_back(prefix);
+            }
+        }
+    }
+
+    // Nested template directories (such as ".git/objects/ab") are removed before their parents
+    std::stable_sort(templateDirs.begin(), templateDirs.end(), [](const fs::path &a, const fs::path &b)
+                     { return std::distance(a.begin(), a.end()) > std::distance(b.begin(), b.end()); });
+}
+
+bool TreeCleaner::scan()
+{
+    subdirectories.clear();
+    buckets.clear();
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+    bool sharded = StemLayout(stemDir).load();
+    try
+    {
+        backend.forEachEntry(stemDir, [&](const FileSystemBackend::DirectoryEntry &entry)
+                             {
+            size_t number;
+            std::string baseName;
+            if (!entry.isDirectory)
+                return;
+            if (DirectorySynchronizer::splitNumberedName(entry.name, number, baseName))
+            {
+                subdirectories.push_back(entry.name);
+            }
+            else if (sharded && StemLayout::isBucketName(entry.name))
+            {
+                // Lessons of a sharded stem are removed through their "bucket/lesson" path
+                buckets.push_back(entry.name);
+                backend.forEachEntry(stemDir / entry.name, [&](const FileSystemBackend::DirectoryEntry &lesson)
+                                     {
+                    if (lesson.isDirectory && DirectorySynchronizer::splitNumberedName(lesson.name, number, baseName))
+                    {
+                        subdirectories.push_back(entry.name + "/" + lesson.name);
+                    } });
+            } });
+    }
+    catch (const fs::filesystem_error &e)
+    {
+        std::cerr << "Error reading directory: " << e.what() << std::endl;
+        return false;
+    }
+    std::sort(subdirectories.begin(), subdirectories.end());
+    return true;
+}
+
+void TreeCleaner::select(const std::vector<std::string> &names)
+{
+    subdirectories = names;
+    buckets.clear();
+    for (const auto &name : names)
+    {
+        size_t slash = name.find('/');
+        if (slash != std::string::npos && (buckets.empty() || buckets.back() != name.substr(0, slash)))
+        {
+            buckets.push_back(name.substr(0, slash));
+        }
+    }
+    std::sort(buckets.begin(), buckets.end());
+    buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+}
+
+const std::vector<std::string> &TreeCleaner::getSubdirectories() const
+{
+    return subdirectories;
+}
+
+TreeCleaner::Result TreeCleaner::clean(ThreadPool &pool)
+{
+    Counters counters;
+    int stemFd = -1;
+
+#ifndef _WIN32
+    stemFd = ::open(stemDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (stemFd < 0)
+    {
+        reportFailure("", errno, counters);
+        Result result;
+        result.failures = counters.failures;
+        return result;
+    }
+#endif
+
+    pool.parallelFor(subdirectories.size(), [&](size_t i)
+                     {
+        if (keepUserFiles)
+        {
+            removeTemplateFiles(stemFd, subdirectories[i], counters);
+        }
+        else
+        {
+            removeSubdirectory(stemFd, subdirectories[i], counters);
+        } });
+
+    // Buckets emptied by the cleanup go as well; ones still holding user files stay
+    for (const auto &bucket : buckets)
+    {
+#ifdef _WIN32
+        std::error_code ec;
+        if (fs::is_empty(stemDir / bucket, ec) && fs::remove(stemDir / bucket, ec))
+            counters.entriesRemoved++;
+#else
+        if (::unlinkat(stemFd, bucket.c_str(), AT_REMOVEDIR) == 0)
+            counters.entriesRemoved++;
+#endif
+    }
+
+#ifndef _WIN32
+    ::close(stemFd);
+#endif
+
+    Result result;
+    result.directoriesRemoved = counters.directoriesRemoved;
+    result.directoriesKept = counters.directoriesKept;
+    result.entriesRemoved = counters.entriesRemoved;
+    result.failures = counters.failures;
+    return result;
+}
+
+void TreeCleaner::removeSubdirectory(int stemFd, const std::string &name, Counters &counters)
+{
+#ifdef _WIN32
+    (void)stemFd;
+    std::error_code ec;
+    std::uintmax_t removed = fs::remove_all(stemDir / name, ec);
+    if (ec)
+    {
+        reportFailure(name, ec.value(), counters);
+        return;
+    }
+#else
+    size_t removed = 0;
+    int error = removeTreeAt(stemFd, name.c_str(), removed);
+    if (error != 0)
+    {
+        counters.entriesRemoved += removed;
+        reportFailure(name, error, counters);
+        return;
+    }
+#endif
+    counters.entriesRemoved += static_cast<size_t>(removed);
+    counters.directoriesRemoved++;
+}
+
+void TreeCleaner::removeTemplateFiles(int stemFd, const std::string &name, Counters &counters)
+{
+    size_t removed = 0;
+
+#ifdef _WIN32
+    (void)stemFd;
+    fs::path dir = stemDir / name;
+    std::error_code ec;
+    for (const auto &relative : templatePaths)
+    {
+        if (fs::remove(dir / relative, ec))
+            removed++;
+        else if (ec)
+            reportFailure(name + "/" + relative.string(), ec.value(), counters);
+    }
+
+    // Temporary files of interrupted writes are the tool's own, so they go as well
+    removed += removeTemporaryFiles(dir);
+    for (const auto &relative : templateDirs)
+    {
+        removed += removeTemporaryFiles(dir / relative);
+    }
+    for (const auto &relative : templateDirs)
+    {
+        // Template subdirectories go only if nothing of the user's is left in them
+        if (fs::is_empty(dir / relative, ec) && fs::remove(dir / relative, ec))
+            removed++;
+    }
+    bool dirRemoved = fs::is_empty(dir, ec) && fs::remove(dir, ec);
+#else
+    int fd = ::openat(stemFd, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0)
+    {
+        reportFailure(name, errno, counters);
+        return;
+    }
+
+    for (const auto &relative : templatePaths)
+    {
+        if (::unlinkat(fd, relative.c_str(), 0) == 0)
+            removed++;
+        else if (errno != ENOENT)
+            reportFailure(name + "/" + relative.string(), errno, counters);
+    }
+
+    // Temporary files of interrupted writes are the tool's own, so they go as well
+    removed += removeTemporaryFilesAt(fd, ".");
+    for (const auto &relative : templateDirs)
+    {
+        removed += removeTemporaryFilesAt(fd, relative.c_str());
+    }
+
+    // Template subdirectories go only if nothing of the user's is left in them
+    for (const auto &relative : templateDirs)
+    {
+        if (::unlinkat(fd, relative.c_str(), AT_REMOVEDIR) == 0)
+            removed++;
+    }
+    ::close(fd);
+
+    bool dirRemoved = ::unlinkat(stemFd, name.c_str(), AT_REMOVEDIR) == 0;
+    if (!dirRemoved && errno != ENOTEMPTY && errno != EEXIST)
+    {
+        reportFailure(name, errno, counters);
+    }
+#endif
+
+    if (dirRemoved)
+    {
+        removed++;
+        counters.directoriesRemoved++;
+    }
+    else
+    {
+        counters.directoriesKept++;
+    }
+    counters.entriesRemoved += removed;
+}
+
+void TreeCleaner::reportFailure(const std::string &relativePath, int error, Counters &counters)
+{
+    counters.failures++;
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cerr << "  Error removing " << (stemDir / relativePath).string() << ": "
+              << std::generic_category().message(error) << std::endl;
+}
@@ -0,0 +1,106 @@
+#ifndef TREE_CLEANER_H
+#define TREE_CLEANER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+class ThreadPool;
+
+/**
+ * @brief Removes generated lesson directories from a stem in parallel
+ *
+ * TreeCleaner deletes only what the tool generated: the numbered "NN - Name"
+ * subdirectories of a stem, or, when user files are kept, just the template
+ * files inside them. Each subdirectory is handled by one worker, and all
+ * deletions are unlinkat calls relative to open directory descriptors, using
+ * d_type instead of extra stat calls. In a sharded stem the lessons inside
+ * the bucket directories are removed, followed by any bucket left empty.
+ * The stem itself and any other entries are left alone. Instead of scanning,
+ * select() can name the lessons to remove, as when a run is rolled back.
+ */
+class TreeCleaner
+{
+public:
+    /**
+     * @brief Structure summarizing a cleanup
+     */
+    struct Result
+    {
+        size_t directoriesRemoved = 0; // Numbered subdirectories deleted completely
+        size_t directoriesKept = 0;    // Numbered subdirectories kept because they hold user files
+        size_t entriesRemoved = 0;     // Files and directories unlinked, including nested ones
+        size_t failures = 0;           // Entries that could not be removed
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param stemDir Stem directory whose numbered subdirectories are cleaned
+     * @param keepUserFiles True to delete only template files and keep anything else
+     */
+    TreeCleaner(const fs::path &stemDir, bool keepUserFiles);
+
+    /**
+     * @brief Finds the numbered subdirectories of the stem
+     *
+     * @return bool True if the stem could be read
+     */
+    bool scan();
+
+    /**
+     * @brief Selects the subdirectories to remove instead of scanning for them
+     *
+     * Used to roll back a run: only the given lessons are removed, followed
+     * by any of their bucket directories left empty.
+     *
+     * @param names Lesson paths relative to the stem ("NN - Name" or "bucket/NN - Name")
+     */
+    void select(const std::vector<std::string> &names);
+
+    /**
+     * @brief Gets the subdirectories found by scan()
+     *
+     * @return const std::vector<std::string>& Numbered subdirectory names
+     */
+    const std::vector<std::string> &getSubdirectories() const;
+
+    /**
+     * @brief Removes the scanned subdirectories
+     *
+     * @param pool Worker pool; one subdirectory per task
+     * @return Result Summary of the cleanup
+     */
+    Result clean(ThreadPool &pool);
+
+private:
+    // Statistics updated concurrently by the workers
+    struct Counters
+    {
+        std::atomic<size_t> directoriesRemoved{0};
+        std::atomic<size_t> directoriesKept{0};
+        std::atomic<size_t> entriesRemoved{0};
+        std::atomic<size_t> failures{0};
+    };
+
+    // Deletes one numbered subdirectory and everything below it
+    void removeSubdirectory(int stemFd, const std::string &name, Counters &counters);
+
+    // Deletes only the template files of one numbered subdirectory, then the directory if empty
+    void removeTemplateFiles(int stemFd, const std::string &name, Counters &counters);
+
+    // Reports a failed deletion
+    void reportFailure(const std::string &relativePath, int error, Counters &counters);
+
+    fs::path stemDir;                        // Stem being cleaned
+    bool keepUserFiles;                      // True to leave non-template files in place
+    std::vector<std::string> subdirectories; // Numbered subdirectories found by scan()
+    std::vector<std::string> buckets;        // Bucket directories of a sharded stem
+    std::vector<fs::path> templatePaths;     // Template files relative to a lesson directory
+    std::vector<fs::path> templateDirs;      // Template subdirectories relative to a lesson directory
+};
+
+#endif // TREE_CLEANER_H
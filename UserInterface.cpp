@@ -45,6 +45,23 @@ void UserInterface::run()
         }
         break;
 
+    case 3:
+        try
+        {
+            if (!dirCopier)
+            {
+                dirCopier = std::make_unique<DirectoryCopier>();
+            }
+
+            // Replicate a starter directory into existing directories
+            dirCopier->copySourceTreeToSubdirectories();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+        break;
+
     default:
         std::cout << "Invalid choice. Exiting." << std::endl;
     }
@@ -66,7 +83,8 @@ int UserInterface::getUserChoice()
     std::cout << "\nChoose from below:" << std::endl;
     std::cout << "  1. Create folder structure" << std::endl;
     std::cout << "  2. Create template files in existing directories" << std::endl;
-    std::cout << "\nEnter your choice (1-2): ";
+    std::cout << "  3. Copy a starter directory into existing directories" << std::endl;
+    std::cout << "\nEnter your choice (1-3): ";
 
     // Get user input
     std::string input;
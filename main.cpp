@@ -8,18 +8,25 @@
  * - Create numbered directory structures
  * - Create template files (main.cpp, VS Code settings)
  * - Self-contained with embedded template files
+ * - Pluggable filesystem backends (disk, in-memory, simulated latency)
  */
 
-#include "UserInterface.h"
+#include "CommandLineInterface.h"
 #include <iostream>
+#include <string>
+#include <vector>
 
-int main()
+int main(int argc, char *argv[])
 {
     try
     {
-        // Create and run the user interface
-        UserInterface ui;
-        ui.run();
+        // Parse options, then create and run the user interface
+        CommandLineInterface cli;
+        if (!cli.parse(std::vector<std::string>(argv + 1, argv + argc)))
+        {
+            return 1;
+        }
+        return cli.run();
     }
     catch (const std::exception &e)
     {
@@ -0,0 +1,84 @@
+#include "Check.h"
+#include "MemoryFileSystemBackend.h"
+#include "PosixFileSystemBackend.h"
+#include <string>
+#include <system_error>
+
+namespace
+{
+    // Runs the error_code overload contract against one backend rooted at base
+    void checkErrorCodeContract(FileSystemBackend &backend, const fs::path &base)
+    {
+        std::error_code ec = std::make_error_code(std::errc::io_error);
+
+        // Success clears a stale error and reports whether anything was created
+        CHECK(backend.createDirectory(base / "stem" / "01-intro", ec));
+        CHECK(!ec);
+        ec = std::make_error_code(std::errc::io_error);
+        CHECK(!backend.createDirectory(base / "stem" / "01-intro", ec));
+        CHECK(!ec);
+
+        ec = std::make_error_code(std::errc::io_error);
+        backend.writeFile(base / "stem" / "01-intro" / "main.cpp", "int main() {}", ec);
+        CHECK(!ec);
+        CHECK(backend.status(base / "stem" / "01-intro" / "main.cpp").size == 13);
+
+        // A file in the way of a directory is reported, not thrown
+        CHECK(!backend.createDirectory(base / "stem" / "01-intro" / "main.cpp", ec));
+        CHECK(static_cast<bool>(ec));
+        CHECK(!backend.createDirectory(base / "stem" / "01-intro" / "main.cpp" / "nested", ec));
+        CHECK(static_cast<bool>(ec));
+
+        // Writing needs the parent directory and never replaces a directory
+        backend.writeFile(base / "stem" / "missing" / "main.cpp", "x", ec);
+        CHECK(ec == std::errc::no_such_file_or_directory);
+        CHECK(!backend.status(base / "stem" / "missing").exists);
+        backend.writeFile(base / "stem" / "01-intro", "x", ec);
+        CHECK(static_cast<bool>(ec));
+        CHECK(backend.status(base / "stem" / "01-intro").isDirectory);
+
+        // The throwing overloads report the same failures as filesystem_error
+        bool threw = false;
+        try
+        {
+            backend.writeFile(base / "stem" / "missing" / "main.cpp", "x");
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            threw = e.code() == std::errc::no_such_file_or_directory;
+        }
+        CHECK(threw);
+        threw = false;
+        try
+        {
+            backend.createDirectory(base / "stem" / "01-intro" / "main.cpp");
+        }
+        catch (const fs::filesystem_error &)
+        {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+}
+
+int main()
+{
+    fs::path scratch = Check::makeScratchDirectory("errorcode");
+    {
+        PosixFileSystemBackend posix;
+        checkErrorCodeContract(posix, scratch);
+    }
+    fs::remove_all(scratch);
+
+    MemoryFileSystemBackend memory;
+    checkErrorCodeContract(memory, "course");
+
+    // The memory backend names the exact cause
+    std::error_code ec;
+    memory.createDirectory("course/stem/01-intro/main.cpp", ec);
+    CHECK(ec == std::errc::file_exists);
+    memory.writeFile("course/stem/01-intro", "x", ec);
+    CHECK(ec == std::errc::is_a_directory);
+
+    return Check::finish("BackendErrorCodeTest");
+}
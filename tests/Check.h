@@ -0,0 +1,60 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+#include <filesystem>
+#include <string>
+#include <random>
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Minimal assertion helpers shared by the test programs
+ *
+ * Every test is a standalone program linked against the tool's sources
+ * except main.cpp. CHECK records a failure and carries on, so one run
+ * reports every broken expectation; finish() prints the verdict and
+ * returns the exit code.
+ */
+namespace Check
+{
+    inline int failures = 0;
+
+    inline void expect(bool condition, const char *expression, const char *file, int line)
+    {
+        if (!condition)
+        {
+            failures++;
+            std::cerr << file << ":" << line << ": CHECK failed: " << expression << std::endl;
+        }
+    }
+
+    /**
+     * @brief Creates an empty scratch directory below the system temp directory
+     *
+     * @param name Test name used in the directory name
+     * @return fs::path Scratch directory, removed again by the caller
+     */
+    inline fs::path makeScratchDirectory(const std::string &name)
+    {
+        fs::path dir = fs::temp_directory_path() / ("dirtemplate-" + name + "-" + std::to_string(std::random_device{}()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        return dir;
+    }
+
+    inline int finish(const char *testName)
+    {
+        if (failures == 0)
+        {
+            std::cout << testName << ": OK" << std::endl;
+            return 0;
+        }
+        std::cout << testName << ": " << failures << " failed checks" << std::endl;
+        return 1;
+    }
+}
+
+#define CHECK(condition) Check::expect((condition), #condition, __FILE__, __LINE__)
+
+#endif // CHECK_H
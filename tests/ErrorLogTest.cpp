@@ -0,0 +1,91 @@
+#include "Check.h"
+#include "ErrorLog.h"
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Runs printSummary() and returns what it wrote to std::cerr
+    std::string captureSummary(bool &printed)
+    {
+        std::ostringstream captured;
+        std::streambuf *original = std::cerr.rdbuf(captured.rdbuf());
+        printed = ErrorLog::printSummary();
+        std::cerr.rdbuf(original);
+        return captured.str();
+    }
+
+    size_t countLines(const std::string &text, const std::string &needle)
+    {
+        size_t count = 0;
+        for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1))
+        {
+            count++;
+        }
+        return count;
+    }
+}
+
+int main()
+{
+    const std::error_code denied = std::make_error_code(std::errc::permission_denied);
+    const std::error_code full = std::make_error_code(std::errc::no_space_on_device);
+    const fs::path stem = fs::path("course") / "stem";
+
+    // Failures from several threads with the same operation and errno collapse into one group
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]
+                             {
+            for (int i = 0; i < 250; ++i)
+            {
+                fs::path lesson = stem / ("bucket" + std::to_string(t)) / (std::to_string(i) + " - Lesson");
+                ErrorLog::record("write file", denied, lesson, "main.cpp");
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    ErrorLog::record("write file", full, stem / "bucket0" / "1 - Lesson", "main.cpp");
+    ErrorLog::record("create directory", denied, stem / "bucket1" / "2 - Lesson");
+    CHECK(ErrorLog::getFailureCount() == 1002);
+
+    bool printed = false;
+    std::string summary = captureSummary(printed);
+    CHECK(printed);
+    CHECK(summary.find("1002 operations failed:") != std::string::npos);
+    CHECK(countLines(summary, " x ") == 3);
+    CHECK(summary.find("1000 x write file: " + denied.message()) != std::string::npos);
+    CHECK(summary.find("1 x write file: " + full.message()) != std::string::npos);
+    CHECK(summary.find("1 x create directory: " + denied.message()) != std::string::npos);
+
+    // The most frequent group comes first and names the prefix its directories share
+    CHECK(summary.find("1000 x") < summary.find("1 x"));
+    CHECK(summary.find("under " + stem.string() + "\n") != std::string::npos);
+    CHECK(summary.find("under " + (stem / "bucket0" / "1 - Lesson").string()) != std::string::npos);
+
+    // The summary clears the log
+    CHECK(ErrorLog::getFailureCount() == 0);
+    summary = captureSummary(printed);
+    CHECK(!printed);
+    CHECK(summary.empty());
+
+    // A prefix stops at a component boundary: "lesson1" and "lesson10" share only their parent
+    ErrorLog::record("write file", denied, stem / "lesson1");
+    ErrorLog::record("write file", denied, stem / "lesson10");
+    summary = captureSummary(printed);
+    CHECK(summary.find("2 x write file") != std::string::npos);
+    CHECK(summary.find("under " + stem.string() + "\n") != std::string::npos);
+
+    // clear() discards without printing
+    ErrorLog::record("write file", full, stem);
+    ErrorLog::clear();
+    CHECK(ErrorLog::getFailureCount() == 0);
+
+    return Check::finish("ErrorLogTest");
+}
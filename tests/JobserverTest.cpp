@@ -0,0 +1,83 @@
+#include "Check.h"
+#include "Jobserver.h"
+#include <cstdlib>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifndef _WIN32
+    // Counts the tokens left in the pipe without consuming them
+    size_t countTokens(int readFd)
+    {
+        std::string drained;
+        char token;
+        int flags = ::fcntl(readFd, F_GETFL);
+        ::fcntl(readFd, F_SETFL, flags | O_NONBLOCK);
+        while (::read(readFd, &token, 1) == 1)
+        {
+            drained.push_back(token);
+        }
+        ::fcntl(readFd, F_SETFL, flags);
+        for (char byte : drained)
+        {
+            Jobserver::release(byte);
+        }
+        return drained.size();
+    }
+#endif
+}
+
+int main()
+{
+#ifndef _WIN32
+    // A make -j3 jobserver: two tokens in the pipe plus the implicit slot of this process
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    CHECK(::write(fds[1], "++", 2) == 2);
+    std::string makeFlags = "-j3 --jobserver-auth=" + std::to_string(fds[0]) + "," + std::to_string(fds[1]);
+    ::setenv("MAKEFLAGS", makeFlags.c_str(), 1);
+
+    CHECK(Jobserver::isActive());
+    CHECK(Jobserver::getJobLimit() == 3);
+
+    // A reservation takes what is free and returns it when destroyed
+    {
+        Jobserver::Reservation reservation(5, 1);
+        CHECK(reservation.size() == 2);
+        char token;
+        CHECK(!Jobserver::tryAcquire(token));
+        CHECK(!Jobserver::acquire(token, []
+                                  { return false; }));
+    }
+    CHECK(countTokens(fds[0]) == 2);
+
+    // Single tokens go back with the byte that was taken
+    char first = 0;
+    char second = 0;
+    CHECK(Jobserver::tryAcquire(first) && Jobserver::tryAcquire(second));
+    CHECK(first == '+' && second == '+');
+    Jobserver::release(first);
+    {
+        Jobserver::Reservation reservation(2, 0);
+        CHECK(reservation.size() == 1);
+    }
+    Jobserver::release(second);
+    CHECK(countTokens(fds[0]) == 2);
+#endif
+
+    // Without a jobserver every requested token is granted
+    Jobserver::disable();
+    CHECK(!Jobserver::isActive());
+    CHECK(Jobserver::getJobLimit() == 0);
+    Jobserver::Reservation unlimited(8, 8);
+    CHECK(unlimited.size() == 8);
+    char token;
+    CHECK(!Jobserver::tryAcquire(token));
+
+    return Check::finish("JobserverTest");
+}
@@ -0,0 +1,113 @@
+#include "Check.h"
+#include "MarkdownOutlineReader.h"
+#include "OutlineChunkParser.h"
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Reads the outline the way the single-threaded create path does
+    bool readSequentially(const std::string &path, std::string &stemName, std::vector<std::string> &names)
+    {
+        MarkdownOutlineReader reader;
+        if (!reader.open(path))
+            return false;
+        stemName = reader.getStemName();
+        std::string name;
+        while (reader.next(name))
+        {
+            names.push_back(name);
+        }
+        return true;
+    }
+
+    // Writes an outline above the parallel threshold with every kind of line
+    void writeOutline(const fs::path &path, size_t minimumBytes, bool finalNewline)
+    {
+        static const char *const kinds[] = {"|- ", "- ", "* ", "|-", "  - ", "\t* ", "-", "*x ", "1. ", "text "};
+        std::mt19937 random(42);
+        std::ofstream out(path, std::ios::binary);
+        out << "\n  # Course Stem  \r\n";
+
+        size_t written = 0;
+        for (size_t i = 0; written < minimumBytes; ++i)
+        {
+            std::string line;
+            switch (random() % 8)
+            {
+            case 0:
+                line = "";
+                break;
+            case 1:
+                line = "   \t ";
+                break;
+            default:
+                line = kinds[random() % 10];
+                line += "Lesson " + std::to_string(i) + std::string(random() % 200, 'x');
+                break;
+            }
+            if (random() % 5 == 0)
+            {
+                line += "\r";
+            }
+            out << line << "\n";
+            written += line.size() + 1;
+        }
+        out << "- Last lesson";
+        if (finalNewline)
+        {
+            out << "\n";
+        }
+    }
+}
+
+int main()
+{
+    fs::path scratch = Check::makeScratchDirectory("chunks");
+
+    for (bool finalNewline : {true, false})
+    {
+        fs::path outline = scratch / (finalNewline ? "outline.md" : "outline-no-newline.md");
+        writeOutline(outline, 9 * 1024 * 1024, finalNewline);
+        CHECK(fs::file_size(outline) > 8 * 1024 * 1024);
+
+        std::string expectedStem;
+        std::vector<std::string> expected;
+        CHECK(readSequentially(outline.string(), expectedStem, expected));
+        CHECK(expectedStem == "Course Stem");
+        CHECK(expected.size() > 10000);
+        CHECK(!expected.empty() && expected.back() == "Last lesson");
+
+        for (size_t threads : {1, 2, 3, 7, 16})
+        {
+            std::string stem;
+            std::vector<std::string> names;
+            CHECK(OutlineChunkParser(threads).parse(outline.string(), stem, names));
+            CHECK(stem == expectedStem);
+            CHECK(names == expected);
+        }
+    }
+
+    // Small and blank files take the sequential path with the same result
+    fs::path small = scratch / "small.md";
+    std::ofstream(small) << "Stem\n- One\n\n* Two\n";
+    std::string stem;
+    std::vector<std::string> names;
+    CHECK(OutlineChunkParser(4).parse(small.string(), stem, names));
+    CHECK(stem == "Stem");
+    CHECK((names == std::vector<std::string>{"One", "Two"}));
+
+    fs::path blank = scratch / "blank.md";
+    std::ofstream(blank) << "\n  \n";
+    names.clear();
+    CHECK(OutlineChunkParser(4).parse(blank.string(), stem, names));
+    CHECK(stem.empty());
+    CHECK(names.empty());
+
+    CHECK(!OutlineChunkParser(4).parse((scratch / "missing.md").string(), stem, names));
+
+    fs::remove_all(scratch);
+    return Check::finish("OutlineChunkParserTest");
+}
@@ -0,0 +1,88 @@
+#include "Check.h"
+#include "MemoryFileSystemBackend.h"
+#include "PosixFileSystemBackend.h"
+#include <string>
+#include <system_error>
+
+namespace
+{
+    // Checks that a path exists through the backend and has the expected kind
+    bool hasEntry(FileSystemBackend &backend, const fs::path &path, bool isDirectory)
+    {
+        FileSystemBackend::FileStatus st = backend.status(path);
+        return st.exists && st.isDirectory == isDirectory;
+    }
+
+    // Runs the renameEntry contract against one backend rooted at base
+    void checkRenameContract(FileSystemBackend &backend, const fs::path &base)
+    {
+        backend.createDirectory(base / "stem" / "01-intro");
+        backend.writeFile(base / "stem" / "01-intro" / "notes.md", "intro");
+        backend.createDirectory(base / "stem" / "02-basics");
+
+        // A free destination is renamed together with its contents
+        backend.renameEntry(base / "stem" / "01-intro", base / "stem" / "03-intro");
+        CHECK(!hasEntry(backend, base / "stem" / "01-intro", true));
+        CHECK(hasEntry(backend, base / "stem" / "03-intro", true));
+        CHECK(hasEntry(backend, base / "stem" / "03-intro" / "notes.md", false));
+
+        // An existing destination is never replaced, even an empty directory
+        bool threw = false;
+        try
+        {
+            backend.renameEntry(base / "stem" / "03-intro", base / "stem" / "02-basics");
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            threw = e.code() == std::errc::file_exists;
+        }
+        CHECK(threw);
+        CHECK(hasEntry(backend, base / "stem" / "03-intro" / "notes.md", false));
+        CHECK(hasEntry(backend, base / "stem" / "02-basics", true));
+        CHECK(backend.listDirectory(base / "stem" / "02-basics").empty());
+
+        // Files obey the same rule
+        backend.writeFile(base / "stem" / "a.txt", "a");
+        backend.writeFile(base / "stem" / "b.txt", "b");
+        threw = false;
+        try
+        {
+            backend.renameEntry(base / "stem" / "a.txt", base / "stem" / "b.txt");
+        }
+        catch (const fs::filesystem_error &e)
+        {
+            threw = e.code() == std::errc::file_exists;
+        }
+        CHECK(threw);
+        CHECK(backend.status(base / "stem" / "a.txt").size == 1);
+        CHECK(backend.status(base / "stem" / "b.txt").size == 1);
+
+        // A missing source is reported rather than silently ignored
+        threw = false;
+        try
+        {
+            backend.renameEntry(base / "stem" / "missing", base / "stem" / "04-missing");
+        }
+        catch (const fs::filesystem_error &)
+        {
+            threw = true;
+        }
+        CHECK(threw);
+        CHECK(!hasEntry(backend, base / "stem" / "04-missing", true));
+    }
+}
+
+int main()
+{
+    fs::path scratch = Check::makeScratchDirectory("rename");
+    {
+        PosixFileSystemBackend posix;
+        checkRenameContract(posix, scratch);
+    }
+    fs::remove_all(scratch);
+
+    MemoryFileSystemBackend memory;
+    checkRenameContract(memory, "course");
+
+    return Check::finish("RenameEntryTest");
+}
@@ -0,0 +1,176 @@
+#include "Check.h"
+#include "DirectoryCreator.h"
+#include "ProvisioningPipeline.h"
+#include "RunJournal.h"
+#include <fstream>
+#include <string>
+
+namespace
+{
+    void writeOutline(const fs::path &path, int lessonCount)
+    {
+        std::ofstream out(path);
+        out << "Course\n";
+        for (int i = 1; i <= lessonCount; ++i)
+        {
+            out << "- Lesson " << i << "\n";
+        }
+    }
+
+    // Journal hash of lesson number's directory in a flat stem
+    std::uint32_t lessonHash(size_t number)
+    {
+        return RunJournal::hashName(DirectoryCreator::formatSubdirectoryName(number, "Lesson " + std::to_string(number)));
+    }
+
+    // Records and reloads a journal by hand
+    void checkRecords(const fs::path &stem)
+    {
+        {
+            RunJournal journal(stem);
+            CHECK(journal.open(false));
+            journal.record(RunJournal::OP_STEM_CREATED, 0, 0);
+            journal.record(RunJournal::OP_DIRECTORY_CREATED, 1, lessonHash(1));
+            journal.record(RunJournal::OP_TEMPLATED, 1, lessonHash(1));
+            journal.record(RunJournal::OP_DIRECTORY_EXISTED, 2, lessonHash(2));
+        }
+
+        RunJournal loaded(stem);
+        CHECK(loaded.load());
+        CHECK(loaded.getRecordCount() == 4);
+        CHECK(loaded.wasStemCreated());
+        CHECK(!loaded.isComplete());
+        CHECK(loaded.wasCreated(1, lessonHash(1)));
+        CHECK(loaded.isTemplated(1, lessonHash(1)));
+        CHECK(!loaded.isTemplated(1, lessonHash(2)));
+        CHECK(!loaded.wasCreated(2, lessonHash(2)));
+        CHECK(!loaded.isTemplated(2, lessonHash(2)));
+        CHECK(!loaded.isTemplated(99, lessonHash(99)));
+
+        // Continuing a loaded journal appends after its records
+        CHECK(loaded.open(true));
+        loaded.record(RunJournal::OP_TEMPLATED, 2, lessonHash(2));
+        loaded.record(RunJournal::OP_RUN_COMPLETE, 0, 0);
+        loaded.close();
+
+        RunJournal resumed(stem);
+        CHECK(resumed.load());
+        CHECK(resumed.getRecordCount() == 6);
+        CHECK(resumed.isTemplated(1, lessonHash(1)));
+        CHECK(resumed.isTemplated(2, lessonHash(2)));
+        CHECK(resumed.isComplete());
+    }
+
+    // A record torn by a crash, or garbage after it, ends the journal
+    void checkTornRecord(const fs::path &stem)
+    {
+        {
+            RunJournal journal(stem);
+            CHECK(journal.open(false));
+            journal.record(RunJournal::OP_TEMPLATED, 1, lessonHash(1));
+            journal.record(RunJournal::OP_TEMPLATED, 2, lessonHash(2));
+            journal.record(RunJournal::OP_TEMPLATED, 3, lessonHash(3));
+        }
+
+        // Flip one byte of the second record (header and records are 16 bytes each)
+        fs::path path = stem / RunJournal::JOURNAL_FILE_NAME;
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(16 + 16 + 4);
+            file.put('\x5a');
+        }
+
+        RunJournal loaded(stem);
+        CHECK(loaded.load());
+        CHECK(loaded.getRecordCount() == 1);
+        CHECK(loaded.isTemplated(1, lessonHash(1)));
+        CHECK(!loaded.isTemplated(3, lessonHash(3)));
+
+        // A file without the journal header is ignored altogether
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a journal at all";
+        RunJournal garbage(stem);
+        CHECK(!garbage.load());
+    }
+
+    // More records than the initial mapping holds make the file grow
+    void checkGrowth(const fs::path &stem)
+    {
+        const size_t count = 70000;
+        {
+            RunJournal journal(stem);
+            CHECK(journal.open(false));
+            for (size_t i = 1; i <= count; ++i)
+            {
+                journal.record(RunJournal::OP_DIRECTORY_CREATED, i, static_cast<std::uint32_t>(i));
+            }
+            CHECK(journal.getRecordCount() == count);
+        }
+
+        RunJournal loaded(stem);
+        CHECK(loaded.load());
+        CHECK(loaded.getRecordCount() == count);
+        CHECK(loaded.wasCreated(1, 1));
+        CHECK(loaded.wasCreated(65536, 65536));
+        CHECK(loaded.wasCreated(count, static_cast<std::uint32_t>(count)));
+        CHECK(!loaded.wasCreated(count, 1));
+    }
+
+    // A run over the first lessons of an outline is resumed with the full outline
+    void checkPipelineResume(const fs::path &parent)
+    {
+        fs::path partial = parent / "partial.md";
+        fs::path full = parent / "full.md";
+        writeOutline(partial, 3);
+        writeOutline(full, 5);
+
+        ProvisioningPipeline::Result result;
+        ProvisioningPipeline first(2, 2, 16);
+        CHECK(first.run(partial.string(), parent, result));
+        CHECK(result.entries == 3);
+        CHECK(result.directoriesCreated == 3);
+
+        ProvisioningPipeline resumed(2, 2, 16);
+        resumed.setResume(true);
+        CHECK(resumed.run(full.string(), parent, result));
+        CHECK(result.entries == 5);
+        CHECK(result.directoriesSkipped == 3);
+        CHECK(result.directoriesCreated == 2);
+        CHECK(result.templatedDirectories == 2);
+
+        fs::path stem = parent / "Course";
+        for (size_t i = 1; i <= 5; ++i)
+        {
+            CHECK(fs::is_directory(stem / DirectoryCreator::formatSubdirectoryName(i, "Lesson " + std::to_string(i))));
+        }
+
+        RunJournal journal(stem);
+        CHECK(journal.load());
+        CHECK(journal.isComplete());
+        CHECK(journal.wasStemCreated());
+        for (size_t i = 1; i <= 5; ++i)
+        {
+            CHECK(journal.isTemplated(i, lessonHash(i)));
+            CHECK(journal.wasCreated(i, lessonHash(i)));
+        }
+
+        // Resuming needs a journal to continue
+        fs::remove(stem / RunJournal::JOURNAL_FILE_NAME);
+        ProvisioningPipeline noJournal(1, 1, 16);
+        noJournal.setResume(true);
+        CHECK(!noJournal.run(full.string(), parent, result));
+    }
+}
+
+int main()
+{
+    fs::path scratch = Check::makeScratchDirectory("journal");
+
+    checkRecords(scratch);
+    checkTornRecord(scratch);
+    checkGrowth(scratch);
+    fs::remove(scratch / RunJournal::JOURNAL_FILE_NAME);
+    checkPipelineResume(scratch);
+
+    fs::remove_all(scratch);
+    return Check::finish("RunJournalTest");
+}
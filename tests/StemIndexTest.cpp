@@ -0,0 +1,133 @@
+#include "Check.h"
+#include "StemIndex.h"
+#include "SubdirectoryStream.h"
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    // Enumerates the stem the way option 2 does and reports whether the index served it
+    std::vector<std::string> listStem(const fs::path &stem, bool &fromIndex)
+    {
+        std::vector<std::string> names;
+        SubdirectoryStream stream(stem, 64, 1 << 20, true);
+        CHECK(stream.forEachBatch([&](const std::vector<fs::path> &batch)
+                                  {
+            for (const auto &path : batch)
+            {
+                names.push_back(path.filename().string());
+            }
+            return true; }));
+        fromIndex = stream.wasServedFromIndex();
+        return names;
+    }
+
+    // Rescans once the clock has moved on. Kernels stamp files with a coarse clock, and an index
+    // written in the same tick as the stem's last change is not trusted until it is rewritten later.
+    void settle(const fs::path &stem)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        bool fromIndex = false;
+        listStem(stem, fromIndex);
+    }
+}
+
+int main()
+{
+    fs::path stem = Check::makeScratchDirectory("index");
+    fs::create_directory(stem / "02 - Basics");
+    fs::create_directory(stem / "01 - Intro");
+    fs::create_directory(stem / ".hidden");
+    std::ofstream(stem / "notes.txt") << "not a lesson";
+
+    // The first enumeration scans and writes the index
+    bool fromIndex = true;
+    std::vector<std::string> names = listStem(stem, fromIndex);
+    CHECK(!fromIndex);
+    CHECK((names == std::vector<std::string>{"01 - Intro", "02 - Basics"}));
+    CHECK(fs::exists(stem / StemIndex::INDEX_FILE_NAME));
+
+    // An unchanged stem is served from the index with the same result
+    settle(stem);
+    names = listStem(stem, fromIndex);
+    CHECK(fromIndex);
+    CHECK((names == std::vector<std::string>{"01 - Intro", "02 - Basics"}));
+
+    StemIndex index(stem);
+    CHECK(index.load());
+    CHECK(index.getEntries().size() == 2);
+    CHECK(index.getEntries()[0].number == 1);
+    CHECK(index.getEntries()[1].number == 2);
+
+    // Recorded states survive a reload and a later rescan
+    CHECK(index.recordStates({{"02 - Basics", StemIndex::STATE_VERIFIED}}));
+    StemIndex reloaded(stem);
+    CHECK(reloaded.load());
+    CHECK(reloaded.getEntries()[1].state == StemIndex::STATE_VERIFIED);
+
+    // Adding, renaming or removing a lesson makes the index stale
+    fs::create_directory(stem / "03 - Loops");
+    CHECK(!StemIndex(stem).load());
+    names = listStem(stem, fromIndex);
+    CHECK(!fromIndex);
+    CHECK((names == std::vector<std::string>{"01 - Intro", "02 - Basics", "03 - Loops"}));
+    settle(stem);
+    StemIndex rescanned(stem);
+    CHECK(rescanned.load());
+    CHECK(rescanned.getEntries().size() == 3 && rescanned.getEntries()[1].state == StemIndex::STATE_VERIFIED);
+
+    fs::rename(stem / "03 - Loops", stem / "03 - Arrays");
+    names = listStem(stem, fromIndex);
+    CHECK(!fromIndex);
+    CHECK(names.size() == 3 && names[2] == "03 - Arrays");
+
+    fs::remove(stem / "01 - Intro");
+    names = listStem(stem, fromIndex);
+    CHECK(!fromIndex);
+    CHECK((names == std::vector<std::string>{"02 - Basics", "03 - Arrays"}));
+
+    // A damaged index is ignored and rewritten by the next scan
+    {
+        std::fstream file(stem / StemIndex::INDEX_FILE_NAME, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('#');
+    }
+    CHECK(!StemIndex(stem).load());
+    names = listStem(stem, fromIndex);
+    CHECK(!fromIndex);
+    CHECK(names.size() == 2);
+    settle(stem);
+    listStem(stem, fromIndex);
+    CHECK(fromIndex);
+
+    // Names kept for the index share the sort budget: 100 short names cost 3200 bytes, so a
+    // 4800-byte budget sorts them in memory but has no room left to index them as well
+    fs::path budgeted = stem / "budgeted";
+    fs::create_directory(budgeted);
+    for (int i = 10; i < 110; ++i)
+    {
+        fs::create_directory(budgeted / (std::to_string(i) + " - L"));
+    }
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        SubdirectoryStream tight(budgeted, 64, 4800, true);
+        size_t count = 0;
+        CHECK(tight.forEachBatch([&](const std::vector<fs::path> &batch)
+                                 {
+            count += batch.size();
+            return true; }));
+        CHECK(count == 100);
+        CHECK(tight.getSpilledRunCount() == 0);
+        CHECK(!tight.wasServedFromIndex());
+    }
+    settle(budgeted);
+    CHECK(StemIndex(budgeted).load());
+
+    fs::remove_all(stem);
+    return Check::finish("StemIndexTest");
+}
@@ -0,0 +1,96 @@
+#include "Check.h"
+#include "ProvisioningPipeline.h"
+#include "StemLayout.h"
+#include "SubdirectoryStream.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+int main()
+{
+    // Buckets cover aligned ranges of lesson numbers and sort in order
+    CHECK(StemLayout::bucketName(1, 1000) == "000000-000999");
+    CHECK(StemLayout::bucketName(999, 1000) == "000000-000999");
+    CHECK(StemLayout::bucketName(1000, 1000) == "001000-001999");
+    CHECK(StemLayout::bucketName(7, 3) == "000006-000008");
+    CHECK(StemLayout::isBucketName("000000-000999"));
+    CHECK(StemLayout::isBucketName("1-2"));
+    CHECK(!StemLayout::isBucketName("01 - Intro"));
+    CHECK(!StemLayout::isBucketName("000000-"));
+    CHECK(!StemLayout::isBucketName("-000999"));
+
+    // Creation only shards outlines larger than the default fan-out
+    StemLayout::setDefaultFanOut(0);
+    CHECK(!StemLayout::shouldShard(1000000));
+    StemLayout::setDefaultFanOut(3);
+    CHECK(StemLayout::getDefaultFanOut() == 3);
+    CHECK(!StemLayout::shouldShard(3));
+    CHECK(StemLayout::shouldShard(4));
+
+    // The marker survives a reload; flat stems map lessons to themselves
+    fs::path scratch = Check::makeScratchDirectory("layout");
+    StemLayout flat(scratch);
+    CHECK(!flat.load());
+    CHECK(!flat.isSharded() && flat.getFanOut() == 0);
+    CHECK(flat.getRelativePath(5, "05 - Loops") == fs::path("05 - Loops"));
+    CHECK(StemLayout::entryName(scratch, scratch / "05 - Loops") == "05 - Loops");
+
+    fs::path marked = scratch / "marked";
+    fs::create_directory(marked);
+    CHECK(StemLayout(marked).enableSharding(100));
+    StemLayout reloaded(marked);
+    CHECK(reloaded.load());
+    CHECK(reloaded.isSharded() && reloaded.getFanOut() == 100);
+    CHECK(reloaded.getRelativePath(150, "150 - Arrays") == fs::path("000100-000199") / "150 - Arrays");
+    CHECK(StemLayout::entryName(marked, marked / "000100-000199" / "150 - Arrays") == "000100-000199/150 - Arrays");
+
+    // A large outline is created in buckets and enumerated as "bucket/lesson" in lesson order
+    {
+        std::ofstream outline(scratch / "outline.md");
+        outline << "# Sharded\n";
+        for (int i = 1; i <= 10; ++i)
+        {
+            outline << "- Lesson " << i << "\n";
+        }
+    }
+    ProvisioningPipeline pipeline(1, 0, 16);
+    ProvisioningPipeline::Result result;
+    CHECK(pipeline.run((scratch / "outline.md").string(), scratch, result));
+    CHECK(result.entries == 10 && result.directoriesFailed == 0);
+
+    fs::path stem = scratch / "Sharded";
+    StemLayout created(stem);
+    CHECK(created.load());
+    CHECK(created.getFanOut() == 3);
+    std::vector<std::string> buckets;
+    for (const auto &entry : fs::directory_iterator(stem))
+    {
+        if (entry.is_directory())
+        {
+            CHECK(StemLayout::isBucketName(entry.path().filename().string()));
+            buckets.push_back(entry.path().filename().string());
+        }
+    }
+    CHECK(buckets.size() == 4);
+
+    std::vector<std::string> names;
+    SubdirectoryStream stream(stem, 4, 1 << 20, true);
+    CHECK(stream.forEachBatch([&](const std::vector<fs::path> &batch)
+                              {
+        for (const auto &path : batch)
+        {
+            names.push_back(StemLayout::entryName(stem, path));
+        }
+        return true; }));
+    CHECK(names.size() == 10);
+    for (size_t number = 1; number <= names.size(); ++number)
+    {
+        CHECK(names[number - 1] == created.getRelativePath(number, fs::path(names[number - 1]).filename().string()).generic_string());
+    }
+    CHECK(names.front().find("Lesson 1") != std::string::npos);
+    CHECK(names.back().find("Lesson 10") != std::string::npos);
+
+    StemLayout::setDefaultFanOut(0);
+    fs::remove_all(scratch);
+    return Check::finish("StemLayoutTest");
+}
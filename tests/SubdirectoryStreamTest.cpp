@@ -0,0 +1,95 @@
+#include "Check.h"
+#include "MemoryFileSystemBackend.h"
+#include "SubdirectoryStream.h"
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Collects every batch, recording the largest batch size seen
+    std::vector<std::string> collect(SubdirectoryStream &stream, const fs::path &stem, size_t &largestBatch, bool &ok)
+    {
+        std::vector<std::string> names;
+        largestBatch = 0;
+        ok = stream.forEachBatch([&](const std::vector<fs::path> &batch)
+                                 {
+            largestBatch = std::max(largestBatch, batch.size());
+            for (const auto &path : batch)
+            {
+                names.push_back(path.lexically_relative(stem).generic_string());
+            }
+            return true; });
+        return names;
+    }
+}
+
+int main()
+{
+    FileSystemBackend::setActive(std::make_unique<MemoryFileSystemBackend>());
+    FileSystemBackend &backend = FileSystemBackend::getActive();
+
+    // Created in reverse so neither the creation nor the storage order is sorted
+    const fs::path stem = "course";
+    std::vector<std::string> expected;
+    for (int i = 500; i >= 1; --i)
+    {
+        std::string name = std::to_string(i * 7919 % 1000) + " - Lesson " + std::to_string(i);
+        backend.createDirectory(stem / name);
+        expected.push_back(name);
+    }
+    backend.createDirectory(stem / ".hidden");
+    backend.writeFile(stem / "notes.txt", "not a lesson");
+    std::sort(expected.begin(), expected.end());
+
+    // A 256-byte budget forces a spilled run every few names
+    SubdirectoryStream spilling(stem, 7, 256, true);
+    size_t largestBatch = 0;
+    bool ok = false;
+    std::vector<std::string> merged = collect(spilling, stem, largestBatch, ok);
+    CHECK(ok);
+    CHECK(spilling.getSpilledRunCount() > 1);
+    CHECK(merged == expected);
+    CHECK(largestBatch == 7);
+
+    // A generous budget sorts in memory and yields the same order
+    SubdirectoryStream inMemory(stem, 7, 1 << 20, true);
+    std::vector<std::string> sorted = collect(inMemory, stem, largestBatch, ok);
+    CHECK(ok);
+    CHECK(inMemory.getSpilledRunCount() == 0);
+    CHECK(sorted == expected);
+
+    // Unordered enumeration delivers the same set of names
+    SubdirectoryStream unordered(stem, 7, 256, false);
+    std::vector<std::string> streamed = collect(unordered, stem, largestBatch, ok);
+    CHECK(ok);
+    CHECK(largestBatch <= 7);
+    CHECK(std::set<std::string>(streamed.begin(), streamed.end()) ==
+          std::set<std::string>(expected.begin(), expected.end()));
+    CHECK(streamed.size() == expected.size());
+
+    // Returning false from the body stops the merge after that batch
+    size_t delivered = 0;
+    ok = spilling.forEachBatch([&](const std::vector<fs::path> &batch)
+                               {
+        delivered += batch.size();
+        return delivered < 21; });
+    CHECK(ok);
+    CHECK(delivered == 21);
+
+    // The sample is the smallest names in order, even when runs spill
+    size_t count = 0;
+    std::vector<std::string> sample;
+    CHECK(spilling.countAndSample(5, count, sample));
+    CHECK(count == expected.size());
+    CHECK(sample == std::vector<std::string>(expected.begin(), expected.begin() + 5));
+
+    // A missing stem is reported as a failure
+    SubdirectoryStream missing("no-such-stem", 7, 256, true);
+    CHECK(!missing.forEachBatch([](const std::vector<fs::path> &)
+                                { return true; }));
+
+    return Check::finish("SubdirectoryStreamTest");
+}
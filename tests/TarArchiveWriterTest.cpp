@@ -0,0 +1,186 @@
+#include "Check.h"
+#include "TarArchiveWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr size_t BLOCK_SIZE = 512;
+
+    // One entry as read back from the archive
+    struct Entry
+    {
+        std::string name;    // Full path from prefix and name, or from a pax record
+        char typeFlag = 0;   // ustar type flag
+        unsigned mode = 0;   // Permission bits
+        unsigned uid = 0;    // User ID
+        unsigned gid = 0;    // Group ID
+        std::string content; // Payload
+        bool checksumOk = false;
+    };
+
+    unsigned parseOctal(const char *field, size_t width)
+    {
+        unsigned value = 0;
+        for (size_t i = 0; i < width && field[i] >= '0' && field[i] <= '7'; ++i)
+        {
+            value = value * 8 + static_cast<unsigned>(field[i] - '0');
+        }
+        return value;
+    }
+
+    std::string readField(const char *field, size_t width)
+    {
+        return std::string(field, strnlen(field, width));
+    }
+
+    // Parses the archive the way a strict ustar reader would
+    std::vector<Entry> parseArchive(const std::string &archive, bool &endMarkerFound)
+    {
+        std::vector<Entry> entries;
+        std::string paxPath;
+        endMarkerFound = false;
+        size_t offset = 0;
+        while (offset + BLOCK_SIZE <= archive.size())
+        {
+            const char *block = archive.data() + offset;
+            if (std::all_of(block, block + BLOCK_SIZE, [](char c)
+                            { return c == 0; }))
+            {
+                endMarkerFound = offset + 2 * BLOCK_SIZE == archive.size();
+                break;
+            }
+
+            Entry entry;
+            unsigned sum = 0;
+            for (size_t i = 0; i < BLOCK_SIZE; ++i)
+            {
+                sum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(block[i]);
+            }
+            entry.checksumOk = sum == parseOctal(block + 148, 8);
+            entry.typeFlag = block[156];
+            entry.mode = parseOctal(block + 100, 8);
+            entry.uid = parseOctal(block + 108, 8);
+            entry.gid = parseOctal(block + 116, 8);
+            size_t size = parseOctal(block + 124, 12);
+            std::string prefix = readField(block + 345, 155);
+            std::string name = readField(block, 100);
+            entry.name = prefix.empty() ? name : prefix + "/" + name;
+            entry.content = archive.substr(offset + BLOCK_SIZE, size);
+            offset += BLOCK_SIZE + (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+            if (std::memcmp(block + 257, "ustar", 6) != 0)
+            {
+                entry.checksumOk = false;
+            }
+            if (entry.typeFlag == 'x')
+            {
+                // "<length> path=<value>\n"; the length counts the whole record
+                size_t space = entry.content.find(' ');
+                size_t length = std::stoul(entry.content.substr(0, space));
+                CHECK(length == entry.content.size());
+                CHECK(entry.content.compare(space + 1, 5, "path=") == 0);
+                paxPath = entry.content.substr(space + 6, length - space - 7);
+                continue;
+            }
+            if (!paxPath.empty())
+            {
+                entry.name = paxPath;
+                paxPath.clear();
+            }
+            entries.push_back(entry);
+        }
+        return entries;
+    }
+
+    std::string readAll(std::FILE *file)
+    {
+        std::string contents;
+        std::rewind(file);
+        char buffer[65536];
+        size_t count;
+        while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            contents.append(buffer, count);
+        }
+        return contents;
+    }
+}
+
+int main()
+{
+    std::FILE *file = std::tmpfile();
+    CHECK(file != nullptr);
+    if (file == nullptr)
+    {
+        return Check::finish("TarArchiveWriterTest");
+    }
+
+    const std::string splitPath = "stem/" + std::string(110, 'p') + "/file.txt";     // Needs the prefix field
+    const std::string paxPath = "stem/" + std::string(120, 'a') + "/" + std::string(120, 'b'); // Fits no split
+    const std::string large(1536 * 1024 + 7, 'L');                                           // Bypasses the buffer
+
+    TarArchiveWriter writer(file, 1704067200);
+    writer.addDirectory("stem");
+    writer.addFile("stem/hello.txt", "hello");
+    writer.addFile("stem/empty.txt", "");
+    writer.addFile(splitPath, "split");
+    writer.addFile(paxPath, "pax");
+    writer.addFile("stem/large.bin", large);
+    writer.setOwnership(1000, 100, 02770, 0640);
+    writer.addDirectory("stem/owned");
+    writer.addFile("stem/owned/file", "x");
+    CHECK(writer.finish());
+
+    std::string archive = readAll(file);
+    std::fclose(file);
+    CHECK(archive.size() % BLOCK_SIZE == 0);
+    CHECK(archive.size() == writer.getBytesWritten());
+
+    bool endMarkerFound = false;
+    std::vector<Entry> entries = parseArchive(archive, endMarkerFound);
+    CHECK(endMarkerFound);
+    CHECK(entries.size() == 8);
+    if (entries.size() != 8)
+    {
+        return Check::finish("TarArchiveWriterTest");
+    }
+
+    for (const auto &entry : entries)
+    {
+        CHECK(entry.checksumOk);
+    }
+
+    CHECK(entries[0].name == "stem/");
+    CHECK(entries[0].typeFlag == '5');
+    CHECK(entries[0].mode == 0755);
+    CHECK(entries[0].uid == 0);
+
+    CHECK(entries[1].name == "stem/hello.txt");
+    CHECK(entries[1].typeFlag == '0');
+    CHECK(entries[1].mode == 0644);
+    CHECK(entries[1].content == "hello");
+
+    CHECK(entries[2].name == "stem/empty.txt");
+    CHECK(entries[2].content.empty());
+
+    CHECK(entries[3].name == splitPath);
+    CHECK(entries[3].content == "split");
+
+    CHECK(entries[4].name == paxPath);
+    CHECK(entries[4].content == "pax");
+
+    CHECK(entries[5].name == "stem/large.bin");
+    CHECK(entries[5].content == large);
+
+    CHECK(entries[6].name == "stem/owned/");
+    CHECK(entries[6].mode == 02770);
+    CHECK(entries[6].uid == 1000);
+    CHECK(entries[6].gid == 100);
+    CHECK(entries[7].mode == 0640);
+
+    return Check::finish("TarArchiveWriterTest");
+}
@@ -0,0 +1,67 @@
+#include "Check.h"
+#include "StemIndex.h"
+#include "TemplateFiles.h"
+#include "TemplateVerifier.h"
+#include "ThreadPool.h"
+#include <fstream>
+
+int main()
+{
+    fs::path stem = Check::makeScratchDirectory("verify");
+    for (const char *name : {"01 - Clean", "02 - Missing", "03 - Modified", "04 - Extra", "05 - Leftover"})
+    {
+        fs::create_directory(stem / name);
+        CHECK(TemplateFiles::createTemplateFilesIn(stem / name));
+    }
+    fs::remove(stem / "02 - Missing" / "main.cpp");
+    std::ofstream(stem / "03 - Modified" / "main.cpp", std::ios::app) << "// edited\n";
+    std::ofstream(stem / "04 - Extra" / "notes.txt") << "student work";
+    fs::create_directory(stem / "04 - Extra" / ".vscode" / "extra");
+    std::ofstream(stem / "05 - Leftover" / ".main.cpp.tmp.4242.7") << "torn write";
+    fs::create_directory(stem / ".hidden");
+
+    ThreadPool pool(4);
+    TemplateVerifier verifier(2, 1 << 20);
+    TemplateVerifier::Result result;
+    CHECK(verifier.verifyStem(stem, pool, result));
+    CHECK(result.directoriesChecked == 5);
+    CHECK(result.directoriesClean == 1);
+    CHECK(result.missingFiles == 1);
+    CHECK(result.modifiedFiles == 1);
+    CHECK(result.extraFiles == 2);
+    CHECK(result.leftoverFiles == 1);
+    CHECK(result.bytesRead > 0);
+
+    // The outcome is recorded per lesson in the stem index, whenever the index is fresh enough to load
+    if (StemIndex::isSupported())
+    {
+        StemIndex index(stem);
+        CHECK(index.load() || index.getEntries().empty());
+        for (const auto &entry : index.getEntries())
+        {
+            bool clean = entry.name == "01 - Clean";
+            CHECK(entry.state == (clean ? StemIndex::STATE_VERIFIED : StemIndex::STATE_DIFFERS));
+        }
+    }
+
+    // A same-size edit is caught by the content hash
+    fs::path clean = stem / "01 - Clean" / "main.cpp";
+    std::string content;
+    {
+        std::ifstream file(clean, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), {});
+    }
+    content[0] = content[0] == '#' ? '/' : '#';
+    std::ofstream(clean, std::ios::binary | std::ios::trunc) << content;
+    TemplateVerifier::Result again;
+    CHECK(verifier.verifyStem(stem, pool, again));
+    CHECK(again.directoriesClean == 0);
+    CHECK(again.modifiedFiles == 2);
+
+    // A missing stem is an error
+    TemplateVerifier::Result missing;
+    CHECK(!verifier.verifyStem(stem / "missing", pool, missing));
+
+    fs::remove_all(stem);
+    return Check::finish("TemplateVerifierTest");
+}
@@ -0,0 +1,108 @@
+#include "Check.h"
+#include "StemLayout.h"
+#include "TemplateFiles.h"
+#include "ThreadPool.h"
+#include "TreeCleaner.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Creates a lesson directory with the full template set
+    void makeLesson(const fs::path &dir)
+    {
+        fs::create_directories(dir);
+        CHECK(TemplateFiles::createTemplateFilesIn(dir));
+    }
+
+    // Lessons, user files and entries clean must never touch
+    fs::path makeStem(const fs::path &scratch, const std::string &name)
+    {
+        fs::path stem = scratch / name;
+        makeLesson(stem / "01 - Intro");
+        makeLesson(stem / "02 - Basics");
+        makeLesson(stem / "03 - Loops");
+        std::ofstream(stem / "02 - Basics" / "mine.txt") << "student work";
+        fs::create_directories(stem / "02 - Basics" / "data" / "nested");
+        std::ofstream(stem / "03 - Loops" / ".main.cpp.tmp.4242.7") << "torn write";
+        fs::create_directory(stem / "notes");
+        std::ofstream(stem / "README") << "not a lesson";
+        return stem;
+    }
+}
+
+int main()
+{
+    fs::path scratch = Check::makeScratchDirectory("clean");
+    ThreadPool pool(4);
+
+    // Template-only cleanup keeps every lesson that holds user files, and removes leftovers
+    fs::path stem = makeStem(scratch, "keep");
+    TreeCleaner keeping(stem, true);
+    CHECK(keeping.scan());
+    CHECK((keeping.getSubdirectories() == std::vector<std::string>{"01 - Intro", "02 - Basics", "03 - Loops"}));
+    TreeCleaner::Result result = keeping.clean(pool);
+    CHECK(result.failures == 0);
+    CHECK(result.directoriesRemoved == 2);
+    CHECK(result.directoriesKept == 1);
+    CHECK(!fs::exists(stem / "01 - Intro"));
+    CHECK(!fs::exists(stem / "03 - Loops"));
+    CHECK(fs::exists(stem / "02 - Basics" / "mine.txt"));
+    CHECK(fs::exists(stem / "02 - Basics" / "data" / "nested"));
+    for (const auto &file : TemplateFiles::getAllTemplateFiles())
+    {
+        CHECK(!fs::exists(stem / "02 - Basics" / file.subdirectory / file.filename));
+    }
+    CHECK(fs::exists(stem / "notes"));
+    CHECK(fs::exists(stem / "README"));
+
+    // Full cleanup removes the rest, user files included, but nothing outside the lessons
+    TreeCleaner removing(stem, false);
+    CHECK(removing.scan());
+    result = removing.clean(pool);
+    CHECK(result.failures == 0);
+    CHECK(result.directoriesRemoved == 1);
+    CHECK(!fs::exists(stem / "02 - Basics"));
+    CHECK(fs::exists(stem / "notes"));
+    CHECK(fs::exists(stem / "README"));
+
+    // select() limits the cleanup to the named lessons
+    stem = makeStem(scratch, "select");
+    TreeCleaner selective(stem, false);
+    selective.select({"03 - Loops"});
+    result = selective.clean(pool);
+    CHECK(result.directoriesRemoved == 1);
+    CHECK(!fs::exists(stem / "03 - Loops"));
+    CHECK(fs::exists(stem / "01 - Intro"));
+    CHECK(fs::exists(stem / "02 - Basics" / "mine.txt"));
+
+    // In a sharded stem, lessons inside the buckets go, and so do the buckets they emptied
+    fs::path sharded = scratch / "sharded";
+    fs::create_directory(sharded);
+    StemLayout layout(sharded);
+    CHECK(layout.enableSharding(2));
+    for (size_t number = 1; number <= 5; ++number)
+    {
+        makeLesson(sharded / layout.getRelativePath(number, "0" + std::to_string(number) + " - Lesson"));
+    }
+    fs::path keptLesson = sharded / layout.getRelativePath(5, "05 - Lesson");
+    std::ofstream(keptLesson / "mine.txt") << "student work";
+
+    TreeCleaner buckets(sharded, true);
+    CHECK(buckets.scan());
+    CHECK(buckets.getSubdirectories().size() == 5);
+    result = buckets.clean(pool);
+    CHECK(result.failures == 0);
+    CHECK(result.directoriesRemoved == 4);
+    CHECK(result.directoriesKept == 1);
+    CHECK(fs::exists(keptLesson / "mine.txt"));
+    CHECK(!fs::exists(sharded / layout.getRelativePath(1, "01 - Lesson").parent_path()));
+    CHECK(fs::exists(keptLesson.parent_path()));
+
+    // A missing stem is reported
+    CHECK(!TreeCleaner(scratch / "missing", false).scan());
+
+    fs::remove_all(scratch);
+    return Check::finish("TreeCleanerTest");
+}